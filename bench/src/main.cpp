@@ -0,0 +1,1334 @@
+/**
+ * \file  main.cpp
+ * \brief rohdeschwarz end-to-end benchmarks
+ *
+ * Measures latency and throughput of the `rohdeschwarz` instrument I/O path
+ * against `rohdeschwarz::bench::StandInServer`, a loopback stand-in for a VNA.
+ * Results are written as JSON so that they can be compared between releases.
+ *
+ * Usage:
+ *
+ * `rohdeschwarz_bench [--scale <factor>] [--output <file.json>]`
+ */
+
+
+// rohdeschwarz
+#include "stand_in_server.hpp"
+#include "rohdeschwarz/instruments/vna/job_scheduler.hpp"
+#include "rohdeschwarz/instruments/vna/shared_sweep_ring.hpp"
+#include "rohdeschwarz/instruments/vna/vna.hpp"
+#include "rohdeschwarz/instruments/fleet.hpp"
+#include "rohdeschwarz/instruments/profiler.hpp"
+#include "rohdeschwarz/instruments/shared_instrument.hpp"
+#include "rohdeschwarz/instruments/transfer_governor.hpp"
+#include "rohdeschwarz/metrics/bus_trace.hpp"
+#include "rohdeschwarz/metrics/metrics.hpp"
+using namespace rohdeschwarz::bench;
+using namespace rohdeschwarz::instruments;
+using namespace rohdeschwarz::instruments::vna;
+
+
+// posix
+#ifdef __unix__
+#include "rohdeschwarz/proxy/proxy_server.hpp"
+#include <unistd.h>
+using namespace rohdeschwarz::proxy;
+#endif
+
+
+// std lib
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+// types
+using clock_type = std::chrono::steady_clock;
+using metrics    = std::vector<std::pair<std::string, double>>;
+
+
+// constants
+const std::size_t _1_KB_               = 1024;
+const std::size_t _64_MB_              = 64 * 1024 * 1024;
+const std::size_t LATENCY_ITERATIONS   = 10000;
+const std::size_t TRACE_ITERATIONS     = 2000;
+const std::size_t WRITE_ITERATIONS     = 20000;
+const std::size_t THROUGHPUT_BYTES     = 256 * 1024 * 1024;
+const std::size_t THROUGHPUT_MIN_ITERS = 3;
+const std::size_t SWEEP_ITERATIONS     = 50;
+const std::size_t ALL_TRACES           = 16;
+const std::size_t HISTORY_SWEEPS       = 50;
+const std::size_t PING_PONG_SWEEPS     = 20;
+const unsigned    PING_PONG_POINTS     = 20001;
+const std::size_t ENGINE_SWEEPS        = 20;
+const std::size_t SHM_SWEEPS           = 1000;
+const auto        SHM_INTERVAL         = std::chrono::microseconds(200);
+const std::size_t SHARED_THREADS       = 4;
+const std::size_t SHARED_ITERATIONS    = 2000;
+const std::size_t LANE_ITERATIONS      = 5;
+const std::size_t LANE_BULK_QUERIES    = 4;
+const std::size_t LANE_BULK_SIZE_B     = 16 * 1024 * 1024;
+const std::size_t JOB_INSTRUMENTS      = 4;
+const std::size_t JOB_COUNT            = 400;
+const std::size_t JOB_SETUPS           = 3;
+const auto        JOB_CONFIGURE_TIME   = std::chrono::milliseconds(5);
+const std::size_t GOVERNOR_BULK        = 8;
+const std::size_t GOVERNOR_TRANSFERS   = 10;
+const std::size_t GOVERNOR_SIZE_B      = 4 * 1024 * 1024;
+const std::size_t GOVERNOR_BUDGET_B    = 8 * 1024 * 1024;
+const std::size_t FLEET_DEVICES        = 64;
+const std::size_t FLEET_ROUNDS         = 200;
+const std::size_t METRICS_HEADERS      = 50;
+const std::size_t TCP_INFO_SIZE_B      = 16 * 1024 * 1024;
+const std::size_t TCP_INFO_TRANSFERS   = 20;
+const std::size_t PROXY_CLIENTS        = 8;
+const std::size_t PROXY_QUERIES        = 2000;
+const std::size_t PROXY_TRACE_DATA     = 50;
+const unsigned    PROXY_POINTS         = 1001;
+const double      SWEEP_TIME_s         = 0.02;
+const double      ENGINE_CONSUMER_s    = 2 * SWEEP_TIME_s;
+
+
+/**
+ * \brief Benchmark result
+ */
+struct Result
+{
+  std::string name;
+  std::size_t iterations;
+  metrics     values;
+};
+
+
+// helpers
+
+
+/**
+ * \brief Returns nanoseconds elapsed since `start`
+ */
+double elapsed_ns(clock_type::time_point start)
+{
+  const auto elapsed = clock_type::now() - start;
+  return double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+
+/**
+ * \brief Returns percentile `p` (0 to 1) of sorted `samples`
+ */
+double percentile(const std::vector<double>& samples, double p)
+{
+  if (samples.empty())
+  {
+    return 0;
+  }
+  std::size_t index = std::size_t(p * samples.size());
+  return samples[std::min(index, samples.size() - 1)];
+}
+
+
+/**
+ * \brief Times `iterations` calls of `function`
+ *
+ * \returns latency statistics, in microseconds
+ */
+metrics time_latency(std::size_t iterations, const std::function<void()>& function)
+{
+  // warm up
+  function();
+
+  // measure
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  for (std::size_t i = 0; i < iterations; i++)
+  {
+    const auto start = clock_type::now();
+    function();
+    samples.push_back(elapsed_ns(start) / 1000.0);
+  }
+
+  // statistics
+  double sum = 0;
+  for (const double sample : samples)
+  {
+    sum += sample;
+  }
+  std::sort(samples.begin(), samples.end());
+  return {
+    {"mean_us", sum / samples.size()},
+    {"min_us",  samples.front()},
+    {"p50_us",  percentile(samples, 0.50)},
+    {"p99_us",  percentile(samples, 0.99)},
+    {"p999_us", percentile(samples, 0.999)},
+    {"max_us",  samples.back()}
+  };
+}
+
+
+/**
+ * \brief Returns the value of `name` in `values`
+ */
+double value_of(const metrics& values, const std::string& name)
+{
+  for (const auto& value : values)
+  {
+    if (value.first == name)
+    {
+      return value.second;
+    }
+  }
+  return 0;
+}
+
+
+/**
+ * \brief Writes `results` to `stream` as JSON
+ */
+void write_json(std::ostream& stream, const std::vector<Result>& results)
+{
+  stream << "{\n  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); i++)
+  {
+    const Result& result = results[i];
+    stream << (i? ",\n" : "\n");
+    stream << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations;
+    for (const auto& value : result.values)
+    {
+      stream << ", \"" << value.first << "\": " << value.second;
+    }
+    stream << "}";
+  }
+  stream << "\n  ]\n}\n";
+}
+
+
+// benchmarks
+
+
+std::vector<Result> query_latency(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = LATENCY_ITERATIONS * scale;
+  std::vector<Result> results;
+
+  // *IDN?
+  results.push_back({"query_latency/id", iterations, time_latency(iterations, [&]()
+  {
+    vna.id();
+  })});
+
+  // queryValue<double>
+  results.push_back({"query_latency/queryValue<double>", iterations, time_latency(iterations, [&]()
+  {
+    vna.queryValue<double>(":SENS1:FREQ:STAR?");
+  })});
+  return results;
+}
+
+
+std::vector<Result> read_64_bit_vector(Vna& vna, std::size_t scale)
+{
+  std::vector<Result> results;
+  for (std::size_t size = _1_KB_; size <= _64_MB_; size *= 4)
+  {
+    const std::size_t iterations = std::max(THROUGHPUT_MIN_ITERS, scale * THROUGHPUT_BYTES / size / 16);
+    metrics values = time_latency(iterations, [&]()
+    {
+      vna.write("BENC:DATA? %1%", size);
+      vna.read64BitVector();
+    });
+
+    // throughput
+    const double mean_s = value_of(values, "mean_us") / 1e6;
+    values.push_back({"bytes",         double(size)});
+    values.push_back({"throughput_MBps", size / mean_s / 1e6});
+    results.push_back({"read64BitVector/" + std::to_string(size), iterations, values});
+  }
+  return results;
+}
+
+
+Result trace_y(Vna& vna, StandInServer& server, std::size_t scale)
+{
+  const std::size_t iterations = TRACE_ITERATIONS * scale;
+  Trace trace = vna.trace("Trc1");
+
+  // round trips per call
+  // note: trailing writes are counted by synchronizing with *IDN?
+  const std::size_t round_trips = server.roundTrips();
+  const std::size_t queries     = server.queries();
+  const std::size_t commands    = server.commands();
+  trace.y();
+  vna.id();
+  const double round_trips_per_y = double(server.roundTrips() - round_trips - 1);
+  const double queries_per_y     = double(server.queries()    - queries     - 1);
+  const double commands_per_y    = double(server.commands()   - commands);
+
+  // wall time
+  metrics values = time_latency(iterations, [&]()
+  {
+    trace.y();
+  });
+  values.push_back({"round_trips", round_trips_per_y});
+  values.push_back({"queries",     queries_per_y});
+  values.push_back({"writes",      commands_per_y});
+  return {"Trace::y", iterations, values};
+}
+
+
+Result write_rate(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = WRITE_ITERATIONS * scale;
+
+  // write; synchronize with query
+  const auto start = clock_type::now();
+  for (std::size_t i = 0; i < iterations; i++)
+  {
+    vna.write(":SENS1:SWE:POIN %1%", 201);
+  }
+  vna.id();
+  const double elapsed_s = elapsed_ns(start) / 1e9;
+
+  // rate
+  metrics values = {
+    {"elapsed_s",        elapsed_s},
+    {"writes_per_second", iterations / elapsed_s}
+  };
+  return {"write_rate", iterations, values};
+}
+
+
+std::vector<Result> operation_complete(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = SWEEP_ITERATIONS * scale;
+  const double sweep_time_us   = SWEEP_TIME_s * 1e6;
+  vna.write(":SENS1:SWE:TIME %1%", SWEEP_TIME_s);
+  std::vector<Result> results;
+
+  // *OPC? blocking
+  metrics blocking = time_latency(iterations, [&]()
+  {
+    vna.write(":INIT1:IMM");
+    vna.blockUntilOperationComplete(1000);
+  });
+
+  // status byte
+  metrics event = time_latency(iterations, [&]()
+  {
+    vna.write(":INIT1:IMM");
+    vna.armOperationComplete();
+    vna.waitForOperationComplete(1000);
+  });
+
+  // sweep-time aware
+  Channel channel = vna.channel(1);
+  metrics predicted = time_latency(iterations, [&]()
+  {
+    channel.sweep();
+  });
+
+  // overshoot past end of sweep
+  for (metrics* values : {&blocking, &event, &predicted})
+  {
+    values->push_back({"overshoot_p50_us", value_of(*values, "p50_us") - sweep_time_us});
+    values->push_back({"overshoot_p99_us", value_of(*values, "p99_us") - sweep_time_us});
+  }
+  results.push_back({"operation_complete/blockUntilOperationComplete", iterations, blocking});
+  results.push_back({"operation_complete/waitForOperationComplete",    iterations, event});
+  results.push_back({"operation_complete/Channel::sweep",              iterations, predicted});
+  return results;
+}
+
+
+std::vector<Result> sweep_and_fetch(Vna& vna, StandInServer& server, std::size_t scale)
+{
+  const std::size_t iterations = SWEEP_ITERATIONS * scale;
+  Channel channel = vna.channel(1);
+  channel.setSweepTime(SWEEP_TIME_s);
+  Trace trace = vna.trace("Trc1");
+  trace.channel();
+
+  // trigger, *OPC?, fetch
+  auto separate = [&]()
+  {
+    vna.write(":INIT1:IMM");
+    vna.blockUntilOperationComplete(1000);
+    trace.y_complex();
+  };
+
+  // single program message
+  auto acquire = [&]()
+  {
+    trace.acquire();
+  };
+
+  std::vector<Result> results;
+  const std::vector<std::pair<std::string, std::function<void()>>> methods
+  {
+    {"sweep_and_fetch/separate",       separate},
+    {"sweep_and_fetch/Trace::acquire", acquire}
+  };
+  for (const auto& [name, method] : methods)
+  {
+    // round trips per call
+    // note: warm up caches first
+    method();
+    const std::size_t round_trips = server.roundTrips();
+    method();
+    vna.id();
+    const double round_trips_per_call = double(server.roundTrips() - round_trips - 1);
+
+    // wall time
+    metrics values = time_latency(iterations, method);
+    values.push_back({"round_trips", round_trips_per_call});
+    results.push_back({name, iterations, values});
+  }
+  return results;
+}
+
+
+std::vector<Result> all_trace_data(Vna& vna, StandInServer& server, std::size_t scale)
+{
+  const std::size_t iterations = TRACE_ITERATIONS * scale / 10;
+
+  // traces
+  vna.write(":CALC:PAR:DEL:ALL");
+  std::vector<Trace> traces;
+  for (std::size_t i = 1; i <= ALL_TRACES; i++)
+  {
+    traces.push_back(vna.createTrace("Trc" + std::to_string(i), 1));
+  }
+  Channel channel = vna.channel(1);
+
+  // per trace
+  auto per_trace = [&]()
+  {
+    for (Trace& trace : traces)
+    {
+      trace.y_complex();
+    }
+  };
+
+  // bulk
+  auto bulk = [&]()
+  {
+    channel.allTraceData();
+  };
+
+  // 4-port S-parameter group
+  auto matrix = [&]()
+  {
+    channel.sParameterMatrix({1, 2, 3, 4});
+  };
+
+  std::vector<Result> results;
+  const std::vector<std::pair<std::string, std::function<void()>>> methods
+  {
+    {"all_trace_data/Trace::y_complex",      per_trace},
+    {"all_trace_data/Channel::allTraceData", bulk},
+    {"all_trace_data/Channel::sParameterMatrix", matrix}
+  };
+  for (const auto& [name, method] : methods)
+  {
+    // round trips per call
+    method();
+    const std::size_t round_trips = server.roundTrips();
+    method();
+    vna.id();
+    const double round_trips_per_call = double(server.roundTrips() - round_trips - 1);
+
+    // wall time
+    metrics values = time_latency(iterations, method);
+    values.push_back({"traces",      double(ALL_TRACES)});
+    values.push_back({"round_trips", round_trips_per_call});
+    results.push_back({name, iterations, values});
+  }
+  return results;
+}
+
+
+std::vector<Result> sweep_history(Vna& vna, StandInServer& server, std::size_t scale)
+{
+  const std::size_t iterations = TRACE_ITERATIONS * scale / 10;
+  Trace trace = vna.trace("Trc1");
+  trace.channel();
+
+  // one query per sweep
+  auto per_sweep = [&]()
+  {
+    for (std::size_t sweep = 1; sweep <= HISTORY_SWEEPS; sweep++)
+    {
+      vna.write(":CALC1:DATA:NSW:FIRS? SDAT,%1%", sweep);
+      vna.read64BitComplexVector();
+    }
+  };
+
+  // pipelined
+  auto pipelined = [&]()
+  {
+    trace.sweepHistory(HISTORY_SWEEPS);
+  };
+
+  std::vector<Result> results;
+  const std::vector<std::pair<std::string, std::function<void()>>> methods
+  {
+    {"sweep_history/per_sweep",           per_sweep},
+    {"sweep_history/Trace::sweepHistory", pipelined}
+  };
+  for (const auto& [name, method] : methods)
+  {
+    // round trips per call
+    method();
+    const std::size_t round_trips = server.roundTrips();
+    method();
+    vna.id();
+    const double round_trips_per_call = double(server.roundTrips() - round_trips - 1);
+
+    // wall time
+    metrics values = time_latency(iterations, method);
+    values.push_back({"sweeps",      double(HISTORY_SWEEPS)});
+    values.push_back({"round_trips", round_trips_per_call});
+    results.push_back({name, iterations, values});
+  }
+  return results;
+}
+
+
+std::vector<Result> ping_pong(Vna& vna, std::size_t scale)
+{
+  const std::size_t sweeps = PING_PONG_SWEEPS * scale;
+
+  // both channels: same points, same sweep time
+  // note: the stand-in server shares configuration between channels
+  Channel channel1 = vna.channel(1);
+  Channel channel2 = vna.channel(2);
+  channel1.setPoints(PING_PONG_POINTS);
+  channel1.setSweepTime(SWEEP_TIME_s);
+  channel2.setSweepTime(SWEEP_TIME_s);
+
+  // sweep, then read
+  auto start = clock_type::now();
+  for (std::size_t i = 0; i < sweeps; i++)
+  {
+    channel1.sweep();
+    channel1.allTraceData();
+  }
+  const double sequential_s = elapsed_ns(start) / 1e9;
+
+  // read one channel while the other sweeps
+  PingPongAcquisition acquisition(&vna, 1, 2);
+  TraceData data;
+  start = clock_type::now();
+  acquisition.start();
+  for (std::size_t i = 0; i < sweeps; i++)
+  {
+    acquisition.next(&data);
+  }
+  acquisition.stop();
+  const double ping_pong_s = elapsed_ns(start) / 1e9;
+
+  // restore
+  channel1.setPoints(201);
+
+  const double bytes = double(data.size_B());
+  return {
+    {"ping_pong/sequential",          sweeps, {{"sweeps_per_second", sweeps / sequential_s}, {"bytes_per_sweep", bytes}}},
+    {"ping_pong/PingPongAcquisition", sweeps, {{"sweeps_per_second", sweeps / ping_pong_s},  {"bytes_per_sweep", bytes}}}
+  };
+}
+
+
+std::vector<Result> acquisition_engine(Vna& vna, std::size_t scale)
+{
+  const std::size_t sweeps = ENGINE_SWEEPS * scale;
+  vna.channel(1).setSweepTime(SWEEP_TIME_s);
+  std::vector<Result> results;
+
+  // block: every sweep is handed over; measure hand-over latency
+  {
+    AcquisitionEngine engine(&vna, 1, {"Trc1", "Trc2"}, 4, OverflowPolicy::Block);
+    std::vector<double> samples;
+    engine.start();
+    const auto start = clock_type::now();
+    while (samples.size() < sweeps)
+    {
+      const Sweep* sweep = engine.read(1000);
+      if (sweep == nullptr)
+      {
+        break;
+      }
+      samples.push_back(elapsed_ns(sweep->time) / 1e3);
+      engine.release();
+    }
+    const double elapsed_s = elapsed_ns(start) / 1e9;
+    engine.stop();
+    std::sort(samples.begin(), samples.end());
+    results.push_back({"acquisition_engine/Block", samples.size(), {
+      {"sweeps_per_second", samples.size() / elapsed_s},
+      {"handover_p50_us",   percentile(samples, 0.50)},
+      {"handover_p99_us",   percentile(samples, 0.99)}
+    }});
+  }
+
+  // drop newest: slow consumer
+  {
+    AcquisitionEngine engine(&vna, 1, {"Trc1", "Trc2"}, 4, OverflowPolicy::DropNewest);
+    std::size_t consumed = 0;
+    engine.start();
+    while (consumed < sweeps)
+    {
+      if (engine.read(1000) == nullptr)
+      {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::duration<double>(ENGINE_CONSUMER_s));
+      engine.release();
+      consumed++;
+    }
+    engine.stop();
+    results.push_back({"acquisition_engine/DropNewest", consumed, {
+      {"sweeps",  double(engine.sweeps())},
+      {"dropped", double(engine.dropped())}
+    }});
+  }
+  return results;
+}
+
+
+std::vector<Result> shared_instrument(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = SHARED_ITERATIONS * scale;
+
+  // threads: 3 writes and a query per iteration
+  auto run_threads = [&](const std::function<void()>& iteration)
+  {
+    const auto start = clock_type::now();
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < SHARED_THREADS; i++)
+    {
+      threads.emplace_back([&]()
+      {
+        for (std::size_t j = 0; j < iterations; j++)
+        {
+          iteration();
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    return elapsed_ns(start) / 1e9;
+  };
+  const double commands = double(4 * SHARED_THREADS * iterations);
+
+  // global mutex
+  std::mutex mutex;
+  const double mutex_s = run_threads([&]()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    vna.write(":SENS1:SWE:POIN %1%", 201);
+    vna.write(":SENS1:FREQ:STAR %1%", 1e9);
+    vna.write(":SENS1:FREQ:STOP %1%", 8e9);
+    vna.query("*IDN?");
+  });
+
+  // command queue
+  SharedInstrument shared(&vna);
+  const double shared_s = run_threads([&]()
+  {
+    shared.write(":SENS1:SWE:POIN %1%", 201);
+    shared.write(":SENS1:FREQ:STAR %1%", 1e9);
+    shared.write(":SENS1:FREQ:STOP %1%", 8e9);
+    shared.query("*IDN?").get();
+  });
+  const double bus_writes = double(shared.busWrites());
+  shared.stop();
+
+  return {
+    {"shared_instrument/std::mutex", iterations, {
+      {"threads",                double(SHARED_THREADS)},
+      {"commands_per_s",         commands / mutex_s},
+      {"bus_writes_per_command", 1.0}
+    }},
+    {"shared_instrument/SharedInstrument", iterations, {
+      {"threads",                double(SHARED_THREADS)},
+      {"commands_per_s",         commands / shared_s},
+      {"bus_writes_per_command", bus_writes / commands}
+    }}
+  };
+}
+
+
+std::vector<Result> shared_instrument_lanes(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = LANE_ITERATIONS * scale;
+  SharedInstrument shared(&vna);
+
+  // latency of *IDN? queued behind bulk transfers
+  auto time_urgent = [&](Lane lane, bool is_aborted)
+  {
+    std::vector<double> latencies_us;
+    for (std::size_t i = 0; i < iterations; i++)
+    {
+      std::vector<std::future<rohdeschwarz::scpi::BlockData>> bulk;
+      for (std::size_t j = 0; j < LANE_BULK_QUERIES; j++)
+      {
+        bulk.push_back(shared.queryBlockData(Lane::Bulk, "BENC:DATA? %1%", LANE_BULK_SIZE_B));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+      const auto start = clock_type::now();
+      if (is_aborted)
+      {
+        shared.abort();
+      }
+      shared.query(lane, "*IDN?").get();
+      latencies_us.push_back(elapsed_ns(start) / 1e3);
+      for (auto& data : bulk)
+      {
+        data.get();
+      }
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    return latencies_us[latencies_us.size() / 2];
+  };
+  const double fifo_us   = time_urgent(Lane::Bulk,   false);
+  const double urgent_us = time_urgent(Lane::Urgent, false);
+  const double abort_us  = time_urgent(Lane::Urgent, true);
+  const double aborts    = double(shared.aborts());
+  shared.stop();
+
+  return {
+    {"shared_instrument_lanes/fifo",   iterations, {{"latency_p50_us", fifo_us}}},
+    {"shared_instrument_lanes/Urgent", iterations, {{"latency_p50_us", urgent_us}}},
+    {"shared_instrument_lanes/abort",  iterations, {{"latency_p50_us", abort_us}, {"aborts", aborts}}}
+  };
+}
+
+
+std::vector<Result> job_scheduler(StandInServer& server, std::size_t scale)
+{
+  const std::size_t jobs = JOB_COUNT * scale;
+  std::vector<std::unique_ptr<Vna>> vnas;
+  std::vector<Vna*> pointers;
+  for (std::size_t i = 0; i < JOB_INSTRUMENTS; i++)
+  {
+    vnas.push_back(std::make_unique<Vna>());
+    vnas.back()->openTcp("127.0.0.1", 2000, server.port());
+    pointers.push_back(vnas.back().get());
+  }
+
+  // jobs: mixed setups and durations;
+  // configuration is slow
+  auto setup_of = [](std::size_t job)
+  {
+    return "setup" + std::to_string((job / 5) % JOB_SETUPS);
+  };
+  auto configure = [](Vna& vna)
+  {
+    std::this_thread::sleep_for(JOB_CONFIGURE_TIME);
+    return vna.write(":SENS1:SWE:POIN %1%", 201);
+  };
+  auto measure = [](std::size_t job)
+  {
+    return [job](Vna& vna)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(200 + 300 * ((job * 7) % 10)));
+      return !vna.id().empty();
+    };
+  };
+
+  // round robin
+  std::atomic<std::size_t> round_robin_reconfigurations(0);
+  auto start = clock_type::now();
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < JOB_INSTRUMENTS; i++)
+  {
+    threads.emplace_back([&, i]()
+    {
+      std::string setup;
+      for (std::size_t job = i; job < jobs; job += JOB_INSTRUMENTS)
+      {
+        if (setup != setup_of(job))
+        {
+          round_robin_reconfigurations++;
+          setup = setup_of(job);
+          configure(*pointers[i]);
+        }
+        measure(job)(*pointers[i]);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  const double round_robin_s = elapsed_ns(start) / 1e9;
+
+  // work stealing, setup affinity
+  start = clock_type::now();
+  JobScheduler scheduler(pointers);
+  for (std::size_t job = 0; job < jobs; job++)
+  {
+    scheduler.submit(setup_of(job), configure, measure(job));
+  }
+  scheduler.wait();
+  const double scheduler_s = elapsed_ns(start) / 1e9;
+  double reconfigurations = 0;
+  double steals           = 0;
+  double utilization      = 0;
+  for (std::size_t i = 0; i < scheduler.size(); i++)
+  {
+    const InstrumentUtilization instrument = scheduler.utilization(i);
+    reconfigurations += instrument.reconfigurations;
+    steals           += instrument.steals;
+    utilization      += instrument.utilization / scheduler.size();
+  }
+  scheduler.stop();
+
+  return {
+    {"job_scheduler/round_robin", jobs, {
+      {"jobs_per_s",       jobs / round_robin_s},
+      {"reconfigurations", double(round_robin_reconfigurations)}
+    }},
+    {"job_scheduler/JobScheduler", jobs, {
+      {"jobs_per_s",       jobs / scheduler_s},
+      {"reconfigurations", reconfigurations},
+      {"steals",           steals},
+      {"utilization",      utilization}
+    }}
+  };
+}
+
+
+std::vector<Result> transfer_governor(StandInServer& server, std::size_t scale)
+{
+  const std::size_t transfers = GOVERNOR_TRANSFERS * scale;
+
+  // bulk reads on 8 instruments;
+  // *IDN? latency on another
+  auto run = [&](TransferGovernor* governor)
+  {
+    std::vector<std::unique_ptr<Vna>> vnas;
+    for (std::size_t i = 0; i <= GOVERNOR_BULK; i++)
+    {
+      vnas.push_back(std::make_unique<Vna>());
+      vnas.back()->openTcp("127.0.0.1", 2000, server.port());
+      vnas.back()->setTransferGovernor(governor);
+    }
+
+    std::atomic<std::size_t> running(GOVERNOR_BULK);
+    const auto start = clock_type::now();
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < GOVERNOR_BULK; i++)
+    {
+      threads.emplace_back([&, i]()
+      {
+        for (std::size_t j = 0; j < transfers; j++)
+        {
+          vnas[i]->write("BENC:DATA? %1%", GOVERNOR_SIZE_B);
+          vnas[i]->read64BitVector();
+        }
+        running--;
+      });
+    }
+    std::vector<double> samples;
+    while (running > 0)
+    {
+      const auto query_start = clock_type::now();
+      vnas.back()->id();
+      samples.push_back(elapsed_ns(query_start) / 1000.0);
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    const double elapsed_s = elapsed_ns(start) / 1e9;
+
+    std::sort(samples.begin(), samples.end());
+    return metrics{
+      {"bulk_MBps",      double(GOVERNOR_BULK * transfers * GOVERNOR_SIZE_B) / elapsed_s / 1e6},
+      {"query_p50_us",   percentile(samples, 0.50)},
+      {"query_p99_us",   percentile(samples, 0.99)},
+      {"query_p999_us",  percentile(samples, 0.999)}
+    };
+  };
+
+  const metrics ungoverned = run(nullptr);
+  TransferGovernor governor(GOVERNOR_BUDGET_B);
+  metrics governed = run(&governor);
+  governed.push_back({"peak_in_flight_B", double(governor.peakInFlight_B())});
+  governed.push_back({"waited",           double(governor.waited())});
+  return {
+    {"transfer_governor/none",             transfers, ungoverned},
+    {"transfer_governor/TransferGovernor", transfers, governed}
+  };
+}
+
+
+std::vector<Result> fleet(StandInServer& server, std::size_t scale)
+{
+  const std::size_t rounds = FLEET_ROUNDS * scale;
+
+  // thread per instrument
+  std::vector<std::unique_ptr<Vna>> vnas;
+  for (std::size_t i = 0; i < FLEET_DEVICES; i++)
+  {
+    vnas.push_back(std::make_unique<Vna>());
+    vnas.back()->openTcp("127.0.0.1", 2000, server.port());
+  }
+  auto start = clock_type::now();
+  std::vector<std::thread> threads;
+  for (auto& vna : vnas)
+  {
+    threads.emplace_back([&]()
+    {
+      for (std::size_t i = 0; i < rounds; i++)
+      {
+        vna->id();
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  const double threads_s = elapsed_ns(start) / 1e9;
+  vnas.clear();
+
+  // event loop
+  Fleet fleet;
+  for (std::size_t i = 0; i < FLEET_DEVICES; i++)
+  {
+    fleet.add("127.0.0.1", server.port());
+  }
+  fleet.openAll();
+  start = clock_type::now();
+  for (std::size_t i = 0; i < rounds; i++)
+  {
+    fleet.query("*IDN?");
+  }
+  const double fleet_s = elapsed_ns(start) / 1e9;
+  const double healthy = double(fleet.healthy());
+  fleet.closeAll();
+
+  return {
+    {"fleet/thread_per_instrument", rounds, {
+      {"devices",         double(FLEET_DEVICES)},
+      {"threads",         double(FLEET_DEVICES)},
+      {"rounds_per_s",    rounds / threads_s}
+    }},
+    {"fleet/Fleet", rounds, {
+      {"devices",         double(FLEET_DEVICES)},
+      {"threads",         1.0},
+      {"rounds_per_s",    rounds / fleet_s},
+      {"healthy",         healthy}
+    }}
+  };
+}
+
+
+std::vector<Result> traffic_metrics(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = LATENCY_ITERATIONS * scale;
+  std::vector<Result> results;
+
+  // without metrics
+  results.push_back({"metrics/off", iterations, time_latency(iterations, [&]()
+  {
+    vna.id();
+  })});
+
+  // with metrics
+  rohdeschwarz::metrics::Metrics traffic;
+  vna.setMetrics(&traffic);
+  results.push_back({"metrics/on", iterations, time_latency(iterations, [&]()
+  {
+    vna.id();
+  })});
+
+  // snapshot, with more headers;
+  // note: numeric suffixes are stripped
+  for (std::size_t i = 0; i < METRICS_HEADERS; i++)
+  {
+    vna.write("BENC:H%1%X", i);
+  }
+  metrics snapshot = time_latency(100, [&]()
+  {
+    traffic.snapshot().prometheus();
+  });
+  vna.setMetrics(nullptr);
+  snapshot.push_back({"headers", double(traffic.snapshot().headers.size())});
+  results.push_back({"metrics/snapshot", 100, snapshot});
+  return results;
+}
+
+Result profiler(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = TRACE_ITERATIONS * scale;
+  Trace trace = vna.trace("Trc1");
+
+  // Trace::y, profiled
+  Profiler profiler;
+  vna.setProfiler(&profiler);
+  metrics values = time_latency(iterations, [&]()
+  {
+    trace.y();
+  });
+  vna.setProfiler(nullptr);
+
+  // per call
+  for (const ProfileEntry& entry : profiler.entries())
+  {
+    if (entry.name == "Trace::y")
+    {
+      values.push_back({"round_trips",  double(entry.roundTrips)  / double(entry.calls)});
+      values.push_back({"tiny_queries", double(entry.tinyQueries) / double(entry.calls)});
+      values.push_back({"bus_share",    double(entry.busTime_ns)  / double(entry.time_ns)});
+    }
+  }
+  return {"profiler/Trace::y", iterations, values};
+}
+
+std::vector<Result> bus_trace(Vna& vna, std::size_t scale)
+{
+  const std::size_t iterations = LATENCY_ITERATIONS * scale;
+  std::vector<Result> results;
+
+  // *IDN?, traced
+  rohdeschwarz::metrics::BusTrace trace;
+  vna.setBusTrace(&trace);
+  metrics traced = time_latency(iterations, [&]()
+  {
+    vna.id();
+  });
+  vna.setBusTrace(nullptr);
+  traced.push_back({"events", double(trace.events().size())});
+  results.push_back({"bus_trace/id", iterations, traced});
+
+  // dump
+  const auto start = clock_type::now();
+  const std::size_t size_B = trace.chromeTrace().size();
+  results.push_back({"bus_trace/chromeTrace", 1, {
+    {"events",  double(trace.events().size())},
+    {"bytes",   double(size_B)},
+    {"time_ms", elapsed_ns(start) / 1e6}
+  }});
+  return results;
+}
+
+Result tcp_info(Vna& vna, std::size_t scale)
+{
+  const std::size_t transfers = TCP_INFO_TRANSFERS * scale;
+
+  // block transfers, sampled
+  vna.setTcpInfoSampling(true);
+  double throughput_Bps = 0;
+  double rtt_us         = 0;
+  double delivery_Bps   = 0;
+  double retransmits    = 0;
+  double is_tcp_info    = 1;
+  for (std::size_t i = 0; i < transfers; i++)
+  {
+    vna.write("BENC:DATA? %1%", TCP_INFO_SIZE_B);
+    vna.read64BitVector();
+    const BlockTransfer& transfer = vna.lastBlockTransfer();
+    throughput_Bps += transfer.throughput_Bps() / transfers;
+    rtt_us         += double(transfer.after.rtt_us)           / transfers;
+    delivery_Bps   += double(transfer.after.deliveryRate_Bps) / transfers;
+    retransmits    += double(transfer.after.totalRetransmits - transfer.before.totalRetransmits);
+    is_tcp_info     = std::min(is_tcp_info, transfer.isTcpInfo? 1.0 : 0.0);
+  }
+  vna.setTcpInfoSampling(false);
+
+  return {"tcp_info", transfers, {
+    {"bytes",                double(TCP_INFO_SIZE_B)},
+    {"throughput_MBps",      throughput_Bps / 1e6},
+    {"delivery_rate_MBps",   delivery_Bps   / 1e6},
+    {"rtt_us",               rtt_us},
+    {"retransmits",          retransmits},
+    {"tcp_info",             is_tcp_info}
+  }};
+}
+
+#ifdef __unix__
+Result shared_sweep_ring(std::size_t scale)
+{
+  const std::size_t sweeps = SHM_SWEEPS * scale;
+  const std::string name   = "/rohdeschwarz-bench-" + std::to_string(::getpid());
+  const std::vector<std::string> traces = {"Trc1", "Trc2"};
+  TraceData data(traces, {201, 201});
+
+  SharedSweepRingWriter writer;
+  SharedSweepRingReader reader;
+  if (!writer.create(name, 8, traces, 201) || !reader.open(name))
+  {
+    return {"shared_sweep_ring", 0, {}};
+  }
+
+  // reader: wake-up latency after publish
+  std::vector<double> samples;
+  std::size_t invalid = 0;
+  std::thread reader_thread([&]()
+  {
+    SharedSweepView view;
+    for (std::size_t sweep = 0; sweep < sweeps; sweep++)
+    {
+      if (!reader.wait(sweep, 1000) || !reader.view(sweep, &view))
+      {
+        invalid++;
+        continue;
+      }
+      const auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+      samples.push_back((now_ns - view.time_ns) / 1e3);
+      if (!reader.isValid(view))
+      {
+        invalid++;
+      }
+    }
+  });
+
+  // writer
+  for (std::size_t sweep = 0; sweep < sweeps; sweep++)
+  {
+    writer.publish(data, 1);
+    std::this_thread::sleep_for(SHM_INTERVAL);
+  }
+  reader_thread.join();
+
+  std::sort(samples.begin(), samples.end());
+  return {"shared_sweep_ring", sweeps, {
+    {"wakeup_p50_us", percentile(samples, 0.50)},
+    {"wakeup_p99_us", percentile(samples, 0.99)},
+    {"invalid",       double(invalid)}
+  }};
+}
+
+
+std::vector<Result> proxy(Vna& vna, std::size_t scale)
+{
+  const std::string path = "/tmp/rohdeschwarz-bench-" + std::to_string(::getpid()) + ".sock";
+
+  // traces
+  vna.write(":CALC:PAR:DEL:ALL");
+  for (std::size_t i = 1; i <= ALL_TRACES; i++)
+  {
+    vna.createTrace("Trc" + std::to_string(i), 1);
+  }
+  vna.channel(1).setPoints(PROXY_POINTS);
+
+  // proxy
+  ProxyServer proxy_server(&vna, path);
+  if (!proxy_server.start())
+  {
+    return {};
+  }
+
+  // clients: query latency; fraction forwarded to instrument
+  auto run_clients = [&](std::size_t iterations, const std::function<void(Vna&)>& function)
+  {
+    std::vector<std::vector<double>> samples(PROXY_CLIENTS);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < PROXY_CLIENTS; i++)
+    {
+      threads.emplace_back([&, i]()
+      {
+        Vna client;
+        if (!client.openLocal(path))
+        {
+          return;
+        }
+        for (std::size_t j = 0; j < iterations; j++)
+        {
+          const auto start = clock_type::now();
+          function(client);
+          samples[i].push_back(elapsed_ns(start) / 1e3);
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    std::vector<double> all;
+    for (auto& client_samples : samples)
+    {
+      all.insert(all.end(), client_samples.begin(), client_samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    return all;
+  };
+
+  std::vector<Result> results;
+
+  // *IDN? (cached) and an identical channel query (coalesced)
+  std::size_t forwarded = proxy_server.forwarded();
+  std::size_t requests  = proxy_server.requests();
+  auto start   = clock_type::now();
+  auto samples = run_clients(PROXY_QUERIES * scale, [](Vna& client)
+  {
+    client.id();
+    client.query(":SENS1:FREQ:STAR?");
+  });
+  double seconds = elapsed_ns(start) / 1e9;
+  requests  = proxy_server.requests()  - requests;
+  forwarded = proxy_server.forwarded() - forwarded;
+  results.push_back({"proxy/queries", samples.size(), {
+    {"clients",               double(PROXY_CLIENTS)},
+    {"queries_per_s",         requests / seconds},
+    {"forwarded_per_query",   double(forwarded) / double(requests)},
+    {"latency_p50_us",        percentile(samples, 0.50) / 2},
+    {"latency_p99_us",        percentile(samples, 0.99) / 2}
+  }});
+
+  // trace data, handed over in shared memory
+  forwarded = proxy_server.forwarded();
+  requests  = proxy_server.requests();
+  start     = clock_type::now();
+  samples   = run_clients(PROXY_TRACE_DATA * scale, [](Vna& client)
+  {
+    static thread_local SharedSweepRingReader reader;
+    static thread_local TraceData data;
+    const std::string response = client.query(":PROX:TRAC:DATA? 1");
+    const std::size_t comma = response.rfind(',');
+    const std::string name  = response.substr(1, response.rfind('\'', comma) - 1);
+    if (!reader.isOpen())
+    {
+      reader.open(name);
+      data = TraceData(reader.names(), std::vector<std::size_t>(reader.names().size(), reader.points()));
+    }
+    reader.copy(std::stoul(response.substr(comma + 1)), &data);
+  });
+  seconds   = elapsed_ns(start) / 1e9;
+  requests  = proxy_server.requests()  - requests;
+  forwarded = proxy_server.forwarded() - forwarded;
+  results.push_back({"proxy/trace_data", samples.size(), {
+    {"clients",               double(PROXY_CLIENTS)},
+    {"readouts_per_s",        requests / seconds},
+    {"forwarded_per_readout", double(forwarded) / double(requests)},
+    {"latency_p50_us",        percentile(samples, 0.50)},
+    {"latency_p99_us",        percentile(samples, 0.99)}
+  }});
+
+  proxy_server.stop();
+  return results;
+}
+#endif
+
+
+int main(int argc, char* argv[])
+{
+  // arguments
+  std::size_t scale = 1;
+  std::string output;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    const std::string flag = argv[i];
+    if (flag == "--scale")
+    {
+      scale = std::max(1, std::atoi(argv[i + 1]));
+    }
+    else if (flag == "--output")
+    {
+      output = argv[i + 1];
+    }
+  }
+
+  // connect to stand-in server
+  StandInServer server;
+  Vna vna;
+  if (!vna.openTcp("127.0.0.1", 2000, server.port()))
+  {
+    std::cerr << "error: could not connect to stand-in server" << std::endl;
+    return 1;
+  }
+
+  // run
+  std::vector<Result> results = query_latency(vna, scale);
+  for (Result& result : read_64_bit_vector(vna, scale))
+  {
+    results.push_back(result);
+  }
+  results.push_back(trace_y(vna, server, scale));
+  results.push_back(write_rate(vna, scale));
+  for (Result& result : operation_complete(vna, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : sweep_and_fetch(vna, server, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : sweep_history(vna, server, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : all_trace_data(vna, server, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : ping_pong(vna, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : acquisition_engine(vna, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : shared_instrument(vna, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : shared_instrument_lanes(vna, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : job_scheduler(server, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : transfer_governor(server, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : fleet(server, scale))
+  {
+    results.push_back(result);
+  }
+  for (Result& result : traffic_metrics(vna, scale))
+  {
+    results.push_back(result);
+  }
+  results.push_back(profiler(vna, scale));
+  for (Result& result : bus_trace(vna, scale))
+  {
+    results.push_back(result);
+  }
+  results.push_back(tcp_info(vna, scale));
+#ifdef __unix__
+  results.push_back(shared_sweep_ring(scale));
+  for (Result& result : proxy(vna, scale))
+  {
+    results.push_back(result);
+  }
+#endif
+
+  // report
+  if (output.empty())
+  {
+    write_json(std::cout, results);
+    return 0;
+  }
+  std::ofstream file(output);
+  write_json(file, results);
+  return file.good()? 0 : 1;
+}
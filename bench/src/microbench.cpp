@@ -0,0 +1,371 @@
+/**
+ * \file  microbench.cpp
+ * \brief rohdeschwarz parsing and conversion microbenchmarks
+ *
+ * Google Benchmark microbenchmarks for the kernels that run on every
+ * instrument call: block data parsing, vector conversion, string helpers
+ * and SCPI value parsing.
+ *
+ * Inputs are realistic corpora: a 10k-entry trace catalog, as returned by
+ * `CONF:TRAC:CAT?`, and 1M-point trace payloads.
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/mnemonics.hpp"
+#include "rohdeschwarz/instruments/vna/sweep_buffer.hpp"
+#include "rohdeschwarz/instruments/vna/sweep_publisher.hpp"
+#include "rohdeschwarz/scpi/block_data.hpp"
+#include "rohdeschwarz/scpi/bool.hpp"
+#include "rohdeschwarz/scpi/index_name.hpp"
+#include "rohdeschwarz/scpi/schema.hpp"
+#include "rohdeschwarz/scpi/tokenizer.hpp"
+#include "rohdeschwarz/helpers.hpp"
+#include "rohdeschwarz/to_value.hpp"
+#include "rohdeschwarz/to_vector.hpp"
+using namespace rohdeschwarz::instruments::vna;
+using namespace rohdeschwarz::scpi;
+using namespace rohdeschwarz;
+
+
+// google benchmark
+#include <benchmark/benchmark.h>
+
+
+// std lib
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// constants
+const std::size_t CATALOG_ENTRIES = 10000;
+const std::size_t POINTS          = 1000000;
+const std::size_t CHUNK_SIZE_B    = 50 * 1024;
+const std::size_t SUBSCRIBERS     = 3;
+
+
+// corpora
+
+
+/**
+ * \brief Returns a `CONF:TRAC:CAT?` response with `entries` traces
+ *
+ * For example: `'1,Trc1,2,Trc2'\n`
+ */
+std::string trace_catalog(std::size_t entries)
+{
+  std::string catalog = "'";
+  for (std::size_t i = 1; i <= entries; i++)
+  {
+    if (i > 1)
+    {
+      catalog += ",";
+    }
+    catalog += std::to_string(i) + ",Trc" + std::to_string(i);
+  }
+  catalog += "'\n";
+  return catalog;
+}
+
+
+/**
+ * \brief Returns `count` 64-bit values as raw bytes
+ */
+std::vector<unsigned char> payload(std::size_t count)
+{
+  std::vector<double> values(count);
+  for (std::size_t i = 0; i < count; i++)
+  {
+    values[i] = double(i);
+  }
+  auto begin = reinterpret_cast<const unsigned char*>(values.data());
+  return std::vector<unsigned char>(begin, begin + count * sizeof(double));
+}
+
+
+/**
+ * \brief Returns `payload` with an IEEE 488.2 block data header
+ */
+std::vector<unsigned char> block(const std::vector<unsigned char>& payload)
+{
+  const std::string size   = std::to_string(payload.size());
+  const std::string header = "#" + std::to_string(size.size()) + size;
+  std::vector<unsigned char> data(header.begin(), header.end());
+  data.insert(data.end(), payload.begin(), payload.end());
+  return data;
+}
+
+
+// block data
+
+
+void BM_BlockData_header(benchmark::State& state)
+{
+  // header with first chunk of payload
+  const std::vector<unsigned char> data = block(payload(POINTS));
+  const std::vector<unsigned char> first_chunk(data.begin(), data.begin() + 64);
+  for (auto _ : state)
+  {
+    BlockData block_data(first_chunk);
+    benchmark::DoNotOptimize(block_data.isHeader());
+  }
+}
+BENCHMARK(BM_BlockData_header);
+
+
+void BM_BlockData_push_back(benchmark::State& state)
+{
+  // 1M complex points, read in bus-sized chunks
+  const std::vector<unsigned char> data = block(payload(2 * state.range(0)));
+  for (auto _ : state)
+  {
+    const std::size_t first_size = std::min(CHUNK_SIZE_B, data.size());
+    BlockData block_data(std::vector<unsigned char>(data.begin(), data.begin() + first_size));
+    for (std::size_t offset = first_size; offset < data.size(); offset += CHUNK_SIZE_B)
+    {
+      const std::size_t size = std::min(CHUNK_SIZE_B, data.size() - offset);
+      block_data.push_back(data.begin() + offset, size);
+    }
+    benchmark::DoNotOptimize(block_data.isComplete());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+BENCHMARK(BM_BlockData_push_back)->Arg(1000)->Arg(POINTS)->Unit(benchmark::kMicrosecond);
+
+
+// to vector
+
+
+void BM_to_vector_double(benchmark::State& state)
+{
+  std::vector<unsigned char> data = payload(state.range(0));
+  for (auto _ : state)
+  {
+    auto values = to_vector<double>(data.data(), data.size());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+BENCHMARK(BM_to_vector_double)->Arg(1000)->Arg(POINTS)->Unit(benchmark::kMicrosecond);
+
+
+void BM_to_vector_complex_double(benchmark::State& state)
+{
+  std::vector<unsigned char> data = payload(2 * state.range(0));
+  for (auto _ : state)
+  {
+    auto values = to_vector_complex_double(data.data(), data.size());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+BENCHMARK(BM_to_vector_complex_double)->Arg(1000)->Arg(POINTS)->Unit(benchmark::kMicrosecond);
+
+
+// helpers
+
+
+void BM_split(benchmark::State& state)
+{
+  const std::string catalog = unquote(rightTrim(trace_catalog(state.range(0))));
+  for (auto _ : state)
+  {
+    auto parts = split(catalog);
+    benchmark::DoNotOptimize(parts.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(catalog.size()));
+}
+BENCHMARK(BM_split)->Arg(10)->Arg(CATALOG_ENTRIES)->Unit(benchmark::kMicrosecond);
+
+
+void BM_trim(benchmark::State& state)
+{
+  const std::string response = "  " + trace_catalog(state.range(0));
+  for (auto _ : state)
+  {
+    auto trimmed = trim(response);
+    benchmark::DoNotOptimize(trimmed.data());
+  }
+}
+BENCHMARK(BM_trim)->Arg(1)->Arg(CATALOG_ENTRIES);
+
+
+void BM_unquote_rightTrim(benchmark::State& state)
+{
+  const std::string response = trace_catalog(state.range(0));
+  for (auto _ : state)
+  {
+    auto list = unquote(rightTrim(response));
+    benchmark::DoNotOptimize(list.data());
+  }
+}
+BENCHMARK(BM_unquote_rightTrim)->Arg(1)->Arg(CATALOG_ENTRIES);
+
+
+void BM_unquoteView_trimView(benchmark::State& state)
+{
+  const std::string response = trace_catalog(state.range(0));
+  for (auto _ : state)
+  {
+    auto list = unquoteView(trimView(response));
+    benchmark::DoNotOptimize(list.data());
+  }
+}
+BENCHMARK(BM_unquoteView_trimView)->Arg(1)->Arg(CATALOG_ENTRIES);
+
+
+// scpi
+
+
+void BM_IndexName_parse(benchmark::State& state)
+{
+  const std::string catalog = unquote(rightTrim(trace_catalog(state.range(0))));
+  for (auto _ : state)
+  {
+    auto index_names = IndexName::parse(catalog);
+    benchmark::DoNotOptimize(index_names.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_IndexName_parse)->Arg(10)->Arg(CATALOG_ENTRIES)->Unit(benchmark::kMicrosecond);
+
+
+void BM_Tokenizer(benchmark::State& state)
+{
+  const std::string catalog = unquote(rightTrim(trace_catalog(state.range(0))));
+  for (auto _ : state)
+  {
+    Tokenizer tokenizer(catalog);
+    std::string_view token;
+    while (tokenizer.next(&token))
+    {
+      benchmark::DoNotOptimize(token.data());
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(catalog.size()));
+}
+BENCHMARK(BM_Tokenizer)->Arg(10)->Arg(CATALOG_ENTRIES)->Unit(benchmark::kMicrosecond);
+
+
+void BM_trace_catalog_names(benchmark::State& state)
+{
+  // Vna::traces() response parsing
+  const std::string response = trace_catalog(state.range(0));
+  for (auto _ : state)
+  {
+    auto names = IndexName::parseNames(unquoteView(trimView(response)));
+    benchmark::DoNotOptimize(names.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_trace_catalog_names)->Arg(10)->Arg(CATALOG_ENTRIES)->Unit(benchmark::kMicrosecond);
+
+
+void BM_toBool(benchmark::State& state)
+{
+  const std::string response = "1\n";
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(toBool(response));
+  }
+}
+BENCHMARK(BM_toBool);
+
+
+void BM_to_value_double(benchmark::State& state)
+{
+  const std::string response = "1.23456789012E+009\n";
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(to_value<double>(response));
+  }
+}
+BENCHMARK(BM_to_value_double);
+
+
+void BM_Schema_parse(benchmark::State& state)
+{
+  // compound query response
+  using ResponseSchema = Schema<Mnemonic<TransferFormats>, Mnemonic<ByteOrders>, unsigned int, double, double>;
+  const std::string response = "REAL,64;SWAP;201;1000000000;8000000000\n";
+  for (auto _ : state)
+  {
+    auto values = ResponseSchema::parse(response);
+    benchmark::DoNotOptimize(values);
+  }
+}
+BENCHMARK(BM_Schema_parse);
+
+
+void BM_Schema_parse_list(benchmark::State& state)
+{
+  // ascii trace data
+  using ResponseSchema = Schema<List<double>>;
+  std::string response;
+  for (int64_t i = 0; i < state.range(0); i++)
+  {
+    response += (i? "," : "") + std::to_string(0.001 * i);
+  }
+  for (auto _ : state)
+  {
+    auto values = ResponseSchema::parse(response);
+    benchmark::DoNotOptimize(values);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Schema_parse_list)->Arg(201)->Arg(10001)->Unit(benchmark::kMicrosecond);
+
+
+// sweep fan-out
+
+
+void BM_fan_out_copy(benchmark::State& state)
+{
+  // one vector copy per consumer
+  const std::vector<std::complex<double>> sweep(state.range(0));
+  std::vector<std::vector<std::complex<double>>> consumers(SUBSCRIBERS);
+  for (auto _ : state)
+  {
+    for (auto& consumer : consumers)
+    {
+      consumer = std::vector<std::complex<double>>(sweep);
+      benchmark::DoNotOptimize(consumer.data());
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_fan_out_copy)->Arg(201)->Arg(100001)->Unit(benchmark::kMicrosecond);
+
+
+void BM_fan_out_SweepPublisher(benchmark::State& state)
+{
+  // one reference per subscriber
+  using namespace rohdeschwarz::instruments::vna;
+  SweepBufferPool pool(8, TraceData({"Trc1"}, {std::size_t(state.range(0))}));
+  SweepPublisher publisher;
+  std::vector<std::shared_ptr<SweepSubscription>> subscriptions;
+  for (std::size_t i = 0; i < SUBSCRIBERS; i++)
+  {
+    subscriptions.push_back(publisher.subscribe(4));
+  }
+  SweepRef sweep;
+  for (auto _ : state)
+  {
+    publisher.publish(pool.publish(pool.acquire()));
+    for (auto& subscription : subscriptions)
+    {
+      subscription->tryTake(&sweep);
+      benchmark::DoNotOptimize(sweep->data.data());
+    }
+    sweep.reset();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_fan_out_SweepPublisher)->Arg(201)->Arg(100001)->Unit(benchmark::kMicrosecond);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,563 @@
+/**
+ * \file  stand_in_server.cpp
+ * \brief rohdeschwarz::bench::StandInServer implementation
+ */
+
+
+// rohdeschwarz
+#include "stand_in_server.hpp"
+#include "rohdeschwarz/helpers.hpp"
+using namespace rohdeschwarz::bench;
+using namespace rohdeschwarz;
+
+
+// std lib
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+
+// types
+using tcp = boost::asio::ip::tcp;
+
+
+// constants
+const char* ID_STRING      = "Rohde-Schwarz,ZNB8-4Port,1311601044100104,3.45.30";
+const char* OPTIONS_STRING = "ZNB8-B24,ZNB-K2,ZNB-K4";
+
+
+// helpers
+
+/**
+ * \brief Splits a program message into units on `;`, respecting quotes
+ */
+std::vector<std::string> split_units(const std::string& message)
+{
+  std::vector<std::string> units;
+  std::string unit;
+  char quote = 0;
+  for (const char character : message)
+  {
+    if (quote)
+    {
+      // inside quotes
+      if (character == quote)
+      {
+        quote = 0;
+      }
+      unit.push_back(character);
+      continue;
+    }
+
+    if (character == '\'' || character == '\"')
+    {
+      quote = character;
+      unit.push_back(character);
+      continue;
+    }
+
+    if (character == ';')
+    {
+      units.push_back(trim(unit));
+      unit.clear();
+      continue;
+    }
+
+    unit.push_back(character);
+  }
+  units.push_back(trim(unit));
+  return units;
+}
+
+
+/**
+ * \brief Normalizes a SCPI header for lookup
+ *
+ * Removes the leading colon and numeric suffixes, and converts
+ * to upper case. For example, `:calc1:data:trac?` becomes `CALC:DATA:TRAC?`.
+ */
+std::string normalize_header(const std::string& header)
+{
+  std::string normalized;
+  normalized.reserve(header.size());
+  for (const char character : header)
+  {
+    if (std::isdigit(static_cast<unsigned char>(character)))
+    {
+      continue;
+    }
+    normalized.push_back(char(std::toupper(static_cast<unsigned char>(character))));
+  }
+  if (!normalized.empty() && normalized.front() == ':')
+  {
+    normalized.erase(normalized.begin());
+  }
+  return normalized;
+}
+
+
+/**
+ * \brief Wraps `payload` in an IEEE 488.2 definite-length block header
+ */
+std::string to_block(const std::string& payload)
+{
+  const std::string size = std::to_string(payload.size());
+  std::string block;
+  block.reserve(2 + size.size() + payload.size());
+  block.push_back('#');
+  block.append(std::to_string(size.size()));
+  block.append(size);
+  block.append(payload);
+  return block;
+}
+
+
+// implementation
+
+
+StandInServer::StandInServer(unsigned int points) :
+  _acceptor(_io_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)),
+  _queries(0),
+  _roundTrips(0),
+  _commands(0),
+  _bytesSent(0),
+  _points(points),
+  _traces{"Trc1"},
+  _group(),
+  _format("ASC"),
+  _byteOrder("SWAP"),
+  _sweepTime_s(0.01),
+  _isContinuous(true),
+  _triggerScope("ALL"),
+  _operationEnd(std::chrono::steady_clock::now()),
+  _isOperationCompleteArmed(false),
+  _isWaitRequested(false),
+  _eventStatus(0)
+{
+  accept();
+  _thread = std::thread([this]()
+  {
+    _io_context.run();
+  });
+}
+
+
+StandInServer::~StandInServer()
+{
+  _io_context.stop();
+  if (_thread.joinable())
+  {
+    _thread.join();
+  }
+}
+
+
+int StandInServer::port() const
+{
+  return _acceptor.local_endpoint().port();
+}
+
+
+std::size_t StandInServer::queries() const
+{
+  return _queries.load();
+}
+
+
+std::size_t StandInServer::roundTrips() const
+{
+  return _roundTrips.load();
+}
+
+
+std::size_t StandInServer::commands() const
+{
+  return _commands.load();
+}
+
+
+std::size_t StandInServer::bytesSent() const
+{
+  return _bytesSent.load();
+}
+
+
+void StandInServer::accept()
+{
+  auto socket = std::make_shared<tcp::socket>(_io_context);
+  _acceptor.async_accept(*socket, [this, socket](const boost::system::error_code& error)
+  {
+    if (error)
+    {
+      // acceptor closed
+      return;
+    }
+
+    // serve client; accept next
+    socket->set_option(tcp::no_delay(true));
+    serve(socket, std::make_shared<boost::asio::streambuf>());
+    accept();
+  });
+}
+
+
+void StandInServer::serve(std::shared_ptr<tcp::socket> socket, std::shared_ptr<boost::asio::streambuf> buffer)
+{
+  boost::asio::async_read_until(*socket, *buffer, '\n',
+    [this, socket, buffer](const boost::system::error_code& error, std::size_t size)
+  {
+    if (error)
+    {
+      // client disconnected
+      return;
+    }
+
+    // take program message from buffer
+    std::string message(size, '\0');
+    buffer->sgetn(&message[0], std::streamsize(size));
+
+    // process
+    _isWaitRequested = false;
+    auto response = process(message);
+    if (response->empty())
+    {
+      // no queries; read next message
+      serve(socket, buffer);
+      return;
+    }
+
+    // respond, then read next message
+    auto respond = [this, socket, buffer, response]()
+    {
+      boost::asio::async_write(*socket, boost::asio::buffer(*response),
+        [this, socket, buffer, response](const boost::system::error_code& error, std::size_t size)
+      {
+        if (error)
+        {
+          return;
+        }
+        _bytesSent += size;
+        serve(socket, buffer);
+      });
+    };
+
+    // *OPC?, *WAI: respond when operation is complete
+    if (_isWaitRequested && std::chrono::steady_clock::now() < _operationEnd)
+    {
+      auto timer = std::make_shared<boost::asio::steady_timer>(_io_context, _operationEnd);
+      timer->async_wait([timer, respond](const boost::system::error_code&)
+      {
+        respond();
+      });
+      return;
+    }
+    respond();
+  });
+}
+
+
+std::shared_ptr<const std::string> StandInServer::process(const std::string& message)
+{
+  const std::vector<std::string> units = split_units(message);
+
+  // benchmark payload?
+  if (units.size() == 1 && normalize_header(units[0].substr(0, units[0].find(' '))) == "BENC:DATA?")
+  {
+    _queries++;
+    _roundTrips++;
+    return payloadResponse(std::stoul(units[0].substr(units[0].find(' ') + 1)));
+  }
+
+  std::string response;
+  bool is_response = false;
+  for (const std::string& unit : units)
+  {
+    if (unit.empty())
+    {
+      continue;
+    }
+
+    const bool is_query = unit.find('?') != std::string::npos;
+    if (!is_query)
+    {
+      _commands++;
+      processUnit(unit);
+      continue;
+    }
+
+    // query
+    // note: a response unit can be empty
+    _queries++;
+    if (is_response)
+    {
+      response.push_back(';');
+    }
+    response.append(processUnit(unit));
+    is_response = true;
+  }
+
+  // terminate response message
+  if (is_response)
+  {
+    _roundTrips++;
+    response.push_back('\n');
+  }
+  return std::make_shared<const std::string>(std::move(response));
+}
+
+
+std::string StandInServer::processUnit(const std::string& unit)
+{
+  // header, arguments
+  const std::size_t space = unit.find(' ');
+  const std::string header    = normalize_header(unit.substr(0, space));
+  const std::string arguments = space == std::string::npos? std::string() : trim(unit.substr(space + 1));
+
+  // common
+  if (header == "*IDN?")
+  {
+    return ID_STRING;
+  }
+  if (header == "*OPT?")
+  {
+    return OPTIONS_STRING;
+  }
+  if (header == "*OPC?")
+  {
+    _isWaitRequested = true;
+    return "1";
+  }
+  if (header == "*WAI")
+  {
+    _isWaitRequested = true;
+    return std::string();
+  }
+  if (header == "*OPC")
+  {
+    _isOperationCompleteArmed = true;
+    return std::string();
+  }
+  if (header == "*STB?")
+  {
+    updateEventStatus();
+    return _eventStatus? "32" : "0";
+  }
+  if (header == "*ESR?")
+  {
+    updateEventStatus();
+    const unsigned int event_status = _eventStatus;
+    _eventStatus = 0;
+    return std::to_string(event_status);
+  }
+
+  // sweep
+  if (header == "INIT" || header == "INIT:IMM")
+  {
+    const auto sweep_time = std::chrono::duration<double>(_sweepTime_s);
+    _operationEnd = std::chrono::steady_clock::now()
+      + std::chrono::duration_cast<std::chrono::steady_clock::duration>(sweep_time);
+    return std::string();
+  }
+  if (header == "INIT:CONT:ALL?")
+  {
+    return _isContinuous? "1" : "0";
+  }
+  if (header == "INIT:CONT:ALL")
+  {
+    _isContinuous = arguments == "1" || arguments == "ON";
+    return std::string();
+  }
+  if (header == "INIT:SCOP?")
+  {
+    return _triggerScope;
+  }
+  if (header == "INIT:SCOP")
+  {
+    _triggerScope = arguments;
+    return std::string();
+  }
+  if (header == "SENS:SWE:TIME?")
+  {
+    return std::to_string(_sweepTime_s);
+  }
+  if (header == "SENS:SWE:COUN?")
+  {
+    return "1";
+  }
+  if (header == "SENS:AVER?")
+  {
+    return "0";
+  }
+  if (header == "SENS:AVER:COUN?")
+  {
+    return "10";
+  }
+  if (header == "SENS:SWE:TIME")
+  {
+    _sweepTime_s = std::stod(arguments);
+    return std::string();
+  }
+
+  // data format
+  if (header == "FORM?")
+  {
+    return _format;
+  }
+  if (header == "FORM")
+  {
+    _format = arguments;
+    return std::string();
+  }
+  if (header == "FORM:BORD?")
+  {
+    return _byteOrder;
+  }
+  if (header == "FORM:BORD")
+  {
+    _byteOrder = arguments;
+    return std::string();
+  }
+
+  // channel
+  if (header == "SENS:SWE:POIN?")
+  {
+    return std::to_string(_points);
+  }
+  if (header == "SENS:SWE:POIN")
+  {
+    _points = unsigned(std::stoul(arguments));
+    return std::string();
+  }
+  if (header == "SENS:FREQ:STAR?")
+  {
+    return "1000000000";
+  }
+  if (header == "SENS:FREQ:STOP?")
+  {
+    return "8000000000";
+  }
+  if (header == "CONF:CHAN:CAT?")
+  {
+    return "'1,Ch1'";
+  }
+
+  // trace
+  if (header == "CONF:TRAC:CAT?")
+  {
+    std::string catalog;
+    for (std::size_t i = 0; i < _traces.size(); i++)
+    {
+      catalog += (i? "," : "") + std::to_string(i + 1) + "," + _traces[i];
+    }
+    return "'" + catalog + "'";
+  }
+  if (header == "CALC:PAR:CAT?")
+  {
+    std::string catalog;
+    for (std::size_t i = 0; i < _traces.size(); i++)
+    {
+      catalog += (i? "," : "") + _traces[i] + ",S21";
+    }
+    return "'" + catalog + "'";
+  }
+  if (header == "CALC:PAR:SDEF")
+  {
+    // '<name>','<parameter>'
+    const std::size_t end = arguments.find('\'', 1);
+    _traces.push_back(arguments.substr(1, end - 1));
+    return std::string();
+  }
+  if (header == "CALC:PAR:DEL:ALL")
+  {
+    _traces.clear();
+    return std::string();
+  }
+  if (header == "CONF:TRAC:CHAN:NAME:ID?")
+  {
+    return "1";
+  }
+  if (header == "CALC:DATA:TRAC?")
+  {
+    const bool is_complex = arguments.find("SDAT") != std::string::npos;
+    return doubleBlock(is_complex? 2 * _points : _points);
+  }
+  if (header == "CALC:DATA:NSW:FIRS?")
+  {
+    return doubleBlock(2 * _points);
+  }
+  if (header == "CALC:PAR:DEF:SGR")
+  {
+    _group = arguments;
+    return std::string();
+  }
+  if (header == "CALC:PAR:DEF:SGR?")
+  {
+    return _group;
+  }
+  if (header == "CALC:PAR:DEL:SGR")
+  {
+    _group.clear();
+    return std::string();
+  }
+  if (header == "CALC:DATA:SGR?")
+  {
+    const std::size_t ports = _group.empty()? 0 : std::count(_group.begin(), _group.end(), ',') + 1;
+    return doubleBlock(2 * _points * ports * ports);
+  }
+  if (header == "CALC:DATA:CHAN:ALL?")
+  {
+    const bool is_complex = arguments.find("SDAT") != std::string::npos;
+    return doubleBlock((is_complex? 2 * _points : _points) * _traces.size());
+  }
+  if (header == "CALC:DATA:STIM?")
+  {
+    return doubleBlock(_points);
+  }
+
+  // benchmark payload, within a compound message
+  if (header == "BENC:DATA?")
+  {
+    return to_block(std::string(std::stoul(arguments), '\0'));
+  }
+
+  // unknown
+  return unit.find('?') != std::string::npos? "0" : std::string();
+}
+
+
+void StandInServer::updateEventStatus()
+{
+  if (_isOperationCompleteArmed && std::chrono::steady_clock::now() >= _operationEnd)
+  {
+    _isOperationCompleteArmed = false;
+    _eventStatus |= 1;
+  }
+}
+
+
+std::string StandInServer::doubleBlock(std::size_t count) const
+{
+  std::vector<double> values(count);
+  for (std::size_t i = 0; i < count; i++)
+  {
+    values[i] = double(i);
+  }
+  std::string payload(count * sizeof(double), '\0');
+  std::memcpy(&payload[0], values.data(), payload.size());
+  return to_block(payload);
+}
+
+
+std::shared_ptr<const std::string> StandInServer::payloadResponse(std::size_t bytes)
+{
+  auto i = _blocks.find(bytes);
+  if (i == _blocks.end())
+  {
+    auto response = std::make_shared<std::string>(to_block(std::string(bytes, '\0')));
+    response->push_back('\n');
+    i = _blocks.emplace(bytes, response).first;
+  }
+  return i->second;
+}
@@ -0,0 +1,198 @@
+/**
+ * \file  stand_in_server.hpp
+ * \brief rohdeschwarz::bench::StandInServer definition
+ */
+#ifndef ROHDESCHWARZ_BENCH_STAND_IN_SERVER_HPP
+#define ROHDESCHWARZ_BENCH_STAND_IN_SERVER_HPP
+
+
+// boost
+#include <boost/asio.hpp>
+
+
+// std lib
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace rohdeschwarz::bench
+{
+
+
+/**
+ * \brief Loopback SCPI server that stands in for an R&S VNA
+ *
+ * `StandInServer` listens on `127.0.0.1` on an ephemeral port and answers
+ * the subset of SCPI used by `rohdeschwarz::instruments::vna::Vna`. It runs
+ * on its own thread, so that benchmarks measure the real socket path of
+ * the library without requiring an instrument.
+ *
+ * In addition to VNA commands, the server answers the benchmark-only query
+ * `BENC:DATA? <bytes>` with a block of `<bytes>` payload bytes.
+ *
+ * Sweeps are simulated: `INIT` starts an operation that takes the sweep time
+ * (`SENS:SWE:TIME`) to complete. `*OPC?` and `*WAI` delay the response until
+ * the operation is complete, and `*OPC` sets the event status register,
+ * as reported by `*STB?` and `*ESR?`.
+ *
+ * The server counts the program message units it receives, so that
+ * benchmarks can report round trips per high-level call.
+ */
+class StandInServer
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor
+   *
+   * Starts listening immediately.
+   *
+   * \param[in] points initial number of sweep points
+   */
+  StandInServer(unsigned int points = 201);
+
+
+  /**
+   * \brief Destructor
+   *
+   * Stops the server thread and closes all connections
+   */
+  ~StandInServer();
+
+
+  /**
+   * \brief Listening TCP port
+   */
+  int port() const;
+
+
+  // statistics
+
+  /**
+   * \brief Number of queries (message units ending in `?`) received
+   */
+  std::size_t queries() const;
+
+
+  /**
+   * \brief Number of round trips (program messages containing queries) received
+   */
+  std::size_t roundTrips() const;
+
+
+  /**
+   * \brief Number of commands (message units without `?`) received
+   */
+  std::size_t commands() const;
+
+
+  /**
+   * \brief Number of bytes sent to clients
+   */
+  std::size_t bytesSent() const;
+
+
+private:
+
+  // asio
+  boost::asio::io_context        _io_context;
+  boost::asio::ip::tcp::acceptor _acceptor;
+  std::thread                    _thread;
+
+
+  // statistics
+  std::atomic<std::size_t> _queries;
+  std::atomic<std::size_t> _roundTrips;
+  std::atomic<std::size_t> _commands;
+  std::atomic<std::size_t> _bytesSent;
+
+
+  // instrument state
+  unsigned int _points;
+  std::vector<std::string> _traces;
+  std::string              _group;
+  std::string  _format;
+  std::string  _byteOrder;
+  double       _sweepTime_s;
+  bool         _isContinuous;
+  std::string  _triggerScope;
+
+
+  // operation state
+  std::chrono::steady_clock::time_point _operationEnd;
+  bool          _isOperationCompleteArmed;
+  bool          _isWaitRequested;
+  unsigned char _eventStatus;
+
+
+  // cache of BENC:DATA? responses, by payload size
+  std::map<std::size_t, std::shared_ptr<const std::string>> _blocks;
+
+
+  // helpers
+
+  /**
+   * \brief Accepts the next client connection
+   */
+  void accept();
+
+
+  /**
+   * \brief Reads, processes and answers program messages from `socket`
+   */
+  void serve(std::shared_ptr<boost::asio::ip::tcp::socket> socket, std::shared_ptr<boost::asio::streambuf> buffer);
+
+
+  /**
+   * \brief Processes one program message
+   *
+   * \returns the response message, or an empty string if the
+   *   program message contains no queries
+   */
+  std::shared_ptr<const std::string> process(const std::string& message);
+
+
+  /**
+   * \brief Processes one program message unit
+   *
+   * \returns the response message unit for queries; an empty string otherwise
+   */
+  std::string processUnit(const std::string& unit);
+
+
+  /**
+   * \brief Sets the operation complete bit of the event status register,
+   * if armed and the pending operation is complete
+   */
+  void updateEventStatus();
+
+
+  /**
+   * \brief Creates a block of `count` 64-bit little-endian ramp values
+   */
+  std::string doubleBlock(std::size_t count) const;
+
+
+  /**
+   * \brief Returns a cached, terminated response message with a block
+   * payload of `bytes` bytes
+   *
+   * Large payloads are served without copying them per request.
+   */
+  std::shared_ptr<const std::string> payloadResponse(std::size_t bytes);
+
+
+};  // class StandInServer
+
+
+}       // namespace rohdeschwarz::bench
+#endif  // ROHDESCHWARZ_BENCH_STAND_IN_SERVER_HPP
@@ -36,6 +36,12 @@ class RohdeSchwarzConan(ConanFile):
     tool_requires = 'cmake/[>=3.27 <4.0]'
 
 
+    # benchmark libraries
+    def build_requirements(self):
+        if self.options.benchmarks:
+            self.test_requires('benchmark/[>=1.8 <2]')
+
+
     # build configuration
     package_type  = 'library'
     settings      = "os", "compiler", "build_type", "arch"
@@ -43,14 +49,16 @@ class RohdeSchwarzConan(ConanFile):
 
     # options
     options = {
-        "shared": [True, False],
-        "fPIC":   [True, False]
+        "shared":     [True, False],
+        "fPIC":       [True, False],
+        "benchmarks": [True, False]
     }
 
     # default options
     default_options = {
-        "shared": False,
-        "fPIC":   True,
+        "shared":     False,
+        "fPIC":       True,
+        "benchmarks": False,
     }
 
 
@@ -60,6 +68,7 @@ class RohdeSchwarzConan(ConanFile):
         'conanfile.py',
         'LICENSE.txt',
         'README.md',
+        'bench/*',
         'examples/*',
         'include/*',
         'src/*'
@@ -93,7 +102,9 @@ class RohdeSchwarzConan(ConanFile):
 
     def build(self):
         cmake = CMake(self)
-        cmake.configure()
+        cmake.configure(variables={
+            "ROHDESCHWARZ_BUILD_BENCHMARKS": bool(self.options.benchmarks)
+        })
         cmake.build()
 
 
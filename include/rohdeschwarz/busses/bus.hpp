@@ -71,6 +71,54 @@ public:
   virtual std::string statusMessage() const = 0;
 
 
+  // status byte, service request
+  // optional; the default implementations are not supported and return false
+
+
+  /**
+   * \brief Reads the status byte with a bus-level serial poll
+   *
+   * \param[out] statusByte status byte
+   * \returns `true` on success; `false` on error or if not supported
+   */
+  virtual bool readStatusByte(unsigned char* statusByte);
+
+
+  /**
+   * \brief Enables queueing of service request events
+   *
+   * Previously queued service request events are discarded.
+   *
+   * \returns `true` on success; `false` on error or if not supported
+   */
+  virtual bool enableServiceRequest();
+
+
+  /**
+   * \brief Waits for a queued service request event
+   *
+   * \param[in] timeout_ms time to wait, in milliseconds
+   * \returns `true` if a service request occurred; `false` on timeout,
+   *   error, or if not supported
+   */
+  virtual bool waitForServiceRequest(unsigned int timeout_ms);
+
+
+  // device clear
+  // optional; the default implementation is not supported and returns false
+
+
+  /**
+   * \brief Aborts pending responses and resynchronizes the connection
+   *
+   * Used to recover after an interrupted transfer: data of unread or
+   * partially read responses is discarded.
+   *
+   * \returns `true` on success; `false` on error or if not supported
+   */
+  virtual bool clear();
+
+
 private:
 
   std::vector<unsigned char> _buffer;
@@ -0,0 +1,134 @@
+/**
+ * \file  local_socket.hpp
+ * \brief rohdeschwarz::busses::socket::LocalSocket class definition
+ *
+ * Available on POSIX systems only.
+ */
+#ifndef ROHDESCHWARZ_BUSSES_SOCKET_LOCAL_SOCKET_HPP
+#define ROHDESCHWARZ_BUSSES_SOCKET_LOCAL_SOCKET_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/busses/socket/socket.hpp"
+
+
+// boost
+#include <boost/asio.hpp>
+
+
+// std lib
+#include <cstddef>
+#include <string>
+
+
+namespace rohdeschwarz::busses::socket
+{
+
+
+/**
+ * \brief A class for managing synchronous Unix-domain stream sockets
+ *
+ * Used to connect to a local `rohdeschwarz::proxy::ProxyServer`, which
+ * speaks the same SCPI protocol as the instrument raw socket port.
+ */
+class LocalSocket : public rohdeschwarz::busses::Bus
+{
+
+public:
+
+
+  /**
+   * \brief Constructor
+   *
+   * Constructs a socket object that is connected to the local socket `path`
+   *
+   * \param[in] path socket path, e.g. `/tmp/znb.sock`
+   * \exception `boost::system::system_error` if connection fails
+   */
+  LocalSocket(const std::string& path);
+
+
+  /**
+   * \brief Destructor
+   *
+   * The destructor closes the socket if it is currently open
+   */
+  virtual ~LocalSocket();
+
+
+  /**
+   * \brief Returns the socket path
+   */
+  std::string path() const;
+
+
+  /**
+   * \brief Returns string 'local:{path}'
+   */
+  virtual std::string endpoint() const;
+
+
+  /**
+   * \brief Get timeout, in ms
+   */
+  virtual int timeout_ms() const;
+
+
+  /**
+   * \brief Set timeout, in ms
+   *
+   * Applies to reads; `0` waits indefinitely.
+   */
+  virtual bool setTimeout(int timeout_ms);
+
+
+  /**
+   * \brief read data into buffer
+   *
+   * \param[in]  buffer     Buffer for read
+   * \param[in]  bufferSize Size of buffer
+   * \param[out] readSize   Returns bytes read
+   * \returns    true if read succeeded; false on error or timeout
+   */
+  virtual bool readData(unsigned char* buffer, std::size_t bufferSize, std::size_t* readSize = nullptr);
+
+
+  /**
+   * \brief write data
+   *
+   * \param[in]  data      Data to be written
+   * \param[in]  dataSize  Size of data to be written
+   * \param[out] writeSize Returns bytes written
+   * \returns    true if write succeeded; false otherwise
+   */
+  virtual bool writeData(const unsigned char* data, std::size_t dataSize, std::size_t* writeSize = nullptr);
+
+
+  /**
+   * \brief Checks socket state for error
+   */
+  virtual bool isError() const;
+
+
+  /**
+   * \brief human-readable bus status message
+   */
+  virtual std::string statusMessage() const;
+
+
+private:
+
+  std::string _path;
+  int         _timeout_ms;
+
+
+  // socket
+  boost::asio::io_context                       _io_context;
+  boost::asio::local::stream_protocol::socket   _socket;
+
+
+};  // class LocalSocket
+
+
+}       // namespace rohdeschwarz::busses::socket
+#endif  // ROHDESCHWARZ_BUSSES_SOCKET_LOCAL_SOCKET_HPP
@@ -7,6 +7,7 @@
 
 
 // rohdeschwarz
+#include "rohdeschwarz/busses/socket/tcp_info.hpp"
 #include "rohdeschwarz/busses/bus.hpp"
 
 
@@ -101,6 +102,8 @@ public:
 
    /**
     * \brief Set timeout, in ms
+    *
+    * Applies to each read and write; `0` waits indefinitely.
     */
    virtual bool setTimeout(int timeout_ms);
 
@@ -127,6 +130,18 @@ public:
    virtual bool writeData(const unsigned char* data, std::size_t dataSize, std::size_t* writeSize = nullptr);
 
 
+   /**
+    * \brief Discards pending responses
+    *
+    * A raw socket has no out-of-band device clear. Instead, received data
+    * is drained until the connection is quiet, then `*STB?` is sent as a
+    * marker and responses are discarded through the marker's response.
+    * Best effort: a response that is still being generated when the marker
+    * is answered may arrive later.
+    */
+   virtual bool clear();
+
+
    /**
     * \brief Checks socket state for error
     * \returns true if the connection is open; otherwise false
@@ -144,17 +159,29 @@ public:
    virtual std::string statusMessage() const;
 
 
+   /**
+    * \brief Kernel TCP statistics of the connection
+    *
+    * Round trip time, retransmissions, congestion window, delivery rate
+    * and bytes received, from `TCP_INFO` of the native socket.
+    *
+    * \param[out] info statistics
+    * \returns    true on success; false on error or if not supported (Linux only)
+    */
+   bool tcpInfo(TcpInfo* info);
+
+
 private:
 
   // for endpoint
   std::string _host;
   int         _port;
+  int         _timeout_ms;
 
 
   // socket
   boost::asio::io_context      _io_context;
   boost::asio::ip::tcp::socket _socket;
-  boost::asio::ip::tcp::socket::native_handle_type _native_handle;
 
 
   // helpers
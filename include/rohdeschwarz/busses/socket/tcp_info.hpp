@@ -0,0 +1,48 @@
+/**
+ * \file  tcp_info.hpp
+ * \brief rohdeschwarz::busses::socket::TcpInfo definition
+ */
+#ifndef ROHDESCHWARZ_BUSSES_SOCKET_TCP_INFO_HPP
+#define ROHDESCHWARZ_BUSSES_SOCKET_TCP_INFO_HPP
+
+
+// std lib
+#include <cstdint>
+
+
+namespace rohdeschwarz::busses::socket
+{
+
+
+/**
+ * \brief Kernel statistics of a TCP connection (`TCP_INFO`)
+ *
+ * Fields not reported by the running kernel are `0`. Round trip times
+ * and delivery rate are measured on data sent by this side; for
+ * responses, compare `bytesReceived` over time instead.
+ */
+struct TcpInfo
+{
+  std::uint32_t rtt_us           = 0;  ///< smoothed round trip time
+  std::uint32_t rttVariance_us   = 0;
+  std::uint32_t retransmits      = 0;  ///< unrecovered retransmissions of the current segment
+  std::uint32_t totalRetransmits = 0;  ///< since the connection was opened
+  std::uint32_t congestionWindow = 0;  ///< send congestion window, in segments
+  std::uint32_t mss_B            = 0;  ///< send maximum segment size
+  std::uint64_t deliveryRate_Bps = 0;  ///< most recent delivery rate of sent data; Linux 4.9+
+  std::uint64_t bytesReceived    = 0;  ///< since the connection was opened; Linux 4.1+
+};
+
+
+/**
+ * \brief Reads `TCP_INFO` of `socket`
+ *
+ * \param[in]  socket native socket handle
+ * \param[out] info   statistics
+ * \returns    `true` on success; `false` on error or if not supported (Linux only)
+ */
+bool read_tcp_info(int socket, TcpInfo* info);
+
+
+}       // namespace rohdeschwarz::busses::socket
+#endif  // ROHDESCHWARZ_BUSSES_SOCKET_TCP_INFO_HPP
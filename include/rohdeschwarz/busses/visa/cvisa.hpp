@@ -144,6 +144,12 @@ public:
   VI_READ_STB_PTR viReadSTB;
 
 
+  /**
+   * \brief Function pointer to VISA function `viClear`
+   */
+  VI_CLEAR_PTR viClear;
+
+
   /**
    * \brief Function pointer to VISA function `viGpibSendIFC`
    */
@@ -96,6 +96,12 @@ typedef ViStatus(_VI_FUNC * VI_DISCARD_EVENTS_PTR)(ViSession vi, ViEventType eve
 typedef ViStatus(_VI_FUNC * VI_READ_STB_PTR)(ViSession vi, ViPUInt16 status);
 
 
+/**
+ * \brief Function pointer type for `viClear`
+ */
+typedef ViStatus(_VI_FUNC * VI_CLEAR_PTR)(ViSession vi);
+
+
 /**
  * \brief Function pointer type for `viGpibSendIFC`
  */
@@ -61,6 +61,39 @@ public:
   virtual bool writeData(const unsigned char* data, std::size_t dataSize, std::size_t* writeSize = nullptr);
 
 
+  // status byte, service request
+
+  /**
+   * \brief Reads the status byte with `viReadSTB`
+   */
+  virtual bool readStatusByte(unsigned char* statusByte);
+
+
+  /**
+   * \brief Enables the service request event queue with `viEnableEvent`
+   *
+   * Queued events are discarded with `viDiscardEvents`.
+   */
+  virtual bool enableServiceRequest();
+
+
+  /**
+   * \brief Waits for a service request event with `viWaitOnEvent`
+   */
+  virtual bool waitForServiceRequest(unsigned int timeout_ms);
+
+
+  // device clear
+
+  /**
+   * \brief Sends a device clear with `viClear`
+   *
+   * The instrument aborts pending responses and clears its
+   * input and output buffers.
+   */
+  virtual bool clear();
+
+
   // attributes
 
   /**
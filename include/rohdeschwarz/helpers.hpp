@@ -10,6 +10,7 @@
 
 // std lib
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -133,6 +134,24 @@ std::string unquote(const char* text);
 std::string unquote(const std::string& text);
 
 
+// string views
+
+/**
+ * \brief Trims whitespace from beginning and end of string view
+ *
+ * Does not allocate; the result views into `text`.
+ */
+std::string_view trimView(std::string_view text);
+
+
+/**
+ * \brief Removes quotes from beginning and end of string view
+ *
+ * Does not allocate; the result views into `text`.
+ */
+std::string_view unquoteView(std::string_view text);
+
+
 // split
 
 /**
@@ -0,0 +1,287 @@
+/**
+ * \file fleet.hpp
+ * \brief rohdeschwarz::instruments::Fleet definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_FLEET_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_FLEET_HPP
+
+
+// boost
+#include <boost/asio.hpp>
+#include "boost/format.hpp"
+
+
+// std lib
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments
+{
+
+
+/**
+ * \brief Connection state of a `Fleet` device
+ */
+enum class DeviceState
+{
+  Closed,   ///< not connected
+  Ok,       ///< connected; last operation succeeded
+  Timeout,  ///< last operation timed out; connection closed
+  Error     ///< last operation failed; connection closed
+};
+
+
+/**
+ * \brief Health of a `Fleet` device
+ */
+struct DeviceHealth
+{
+  DeviceState state = DeviceState::Closed;
+  std::size_t failures   = 0;  ///< consecutive failed operations
+  std::size_t timeouts   = 0;  ///< total timeouts
+  std::size_t errors     = 0;  ///< total errors, other than timeouts
+  double      latency_ms = 0;  ///< duration of the last successful operation
+  std::string message;         ///< last error message
+};
+
+
+/**
+ * \brief Drives many instruments from a few threads
+ *
+ * `Fleet` connects to instruments over TCP (raw SCPI socket, port 5025) and
+ * performs all I/O asynchronously on a single `boost::asio::io_context`,
+ * run by a small pool of threads. Each device costs a socket, a 4 KB
+ * read chunk and its pending response; there is no thread per device.
+ *
+ * ```c++
+ * Fleet fleet;
+ * for (const std::string& host : hosts)
+ * {
+ *   fleet.add(host);
+ * }
+ * fleet.openAll(2000);
+ *
+ * fleet.write(":SENS1:SWE:POIN %1%", 201);
+ * std::vector<std::string> ids = fleet.query("*IDN?");
+ * ```
+ *
+ * Operations run in parallel on all devices and return when every device
+ * has completed or timed out. Results are per device, in the order the
+ * devices were added. A device that times out or fails is disconnected,
+ * which discards partial responses; `openAll` reconnects it.
+ *
+ * `Fleet` methods are not thread-safe; call them from one thread at a time.
+ */
+class Fleet
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor; starts the I/O threads
+   *
+   * \param[in] threads number of I/O threads
+   */
+  Fleet(std::size_t threads = 1);
+
+
+  /**
+   * \brief Destructor; disconnects all devices
+   */
+  ~Fleet();
+
+
+  Fleet(const Fleet&)            = delete;
+  Fleet& operator=(const Fleet&) = delete;
+
+
+  // devices
+
+  /**
+   * \brief Adds a device; does not connect
+   *
+   * \returns index of the device
+   */
+  std::size_t add(std::string host, int port = 5025);
+
+
+  std::size_t size() const;
+
+
+  /**
+   * \brief Returns string '{host}:{port}' of device `index`
+   */
+  std::string endpoint(std::size_t index) const;
+
+
+  DeviceHealth health(std::size_t index) const;
+
+
+  /**
+   * \brief Number of devices in state `DeviceState::Ok`
+   */
+  std::size_t healthy() const;
+
+
+  // timeout
+
+  /**
+   * \brief Get timeout of `write` and `query`, in ms
+   */
+  int timeout_ms() const;
+
+
+  /**
+   * \brief Set timeout of `write` and `query`, in ms
+   *
+   * Applies to the complete operation of each device; `0` waits
+   * indefinitely.
+   */
+  void setTimeout(int timeout_ms);
+
+
+  // connection
+
+  /**
+   * \brief Connects all devices that are not connected, in parallel
+   *
+   * \param[in] timeout_ms connect timeout, including name resolution
+   * \returns number of connected devices
+   */
+  std::size_t openAll(int timeout_ms = 2000);
+
+
+  /**
+   * \brief Disconnects all devices
+   */
+  void closeAll();
+
+
+  // io
+
+  /**
+   * \brief Writes a command to all connected devices; see `Instrument::write`
+   *
+   * \returns number of devices written
+   */
+  template<class... Args>
+  std::size_t write(std::string scpi_command, Args&&... args)
+  {
+    return writeAll(format(scpi_command, std::forward<Args>(args)...));
+  }
+
+
+  /**
+   * \brief Queries all connected devices; see `Instrument::query`
+   *
+   * \returns response of each device; empty on error or if not connected
+   */
+  template<class... Args>
+  std::vector<std::string> query(std::string scpi_command, Args&&... args)
+  {
+    return queryAll(format(scpi_command, std::forward<Args>(args)...));
+  }
+
+
+private:
+
+  struct Device;
+
+
+  /**
+   * \brief Completion of a parallel operation
+   */
+  class Batch;
+
+
+  // io
+  boost::asio::io_context                                                  _io_context;
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type> _work;
+  std::vector<std::thread>                                                 _threads;
+
+
+  // devices
+  std::vector<std::unique_ptr<Device>> _devices;
+  int                                  _timeout_ms;
+
+
+  // helpers
+
+  /**
+   * \brief Formats a program message
+   */
+  template<class... Args>
+  static std::string format(const std::string& scpi_command, Args&&... args)
+  {
+    auto format = boost::format(scpi_command);
+    ([&]
+    {
+      format % args;
+    } (), ...);
+
+    return format.str();
+  }
+
+
+  /**
+   * \brief Writes `message` to all connected devices; appends the
+   * program message terminator (`\n`), as `Instrument::write` does
+   */
+  std::size_t writeAll(const std::string& message);
+
+
+  /**
+   * \brief Writes `message`, terminated as in `writeAll`, and reads a
+   * response from each connected device
+   */
+  std::vector<std::string> queryAll(const std::string& message);
+
+
+  /**
+   * \brief Starts `operation` on each device that is connected, or not
+   * connected, and waits for all
+   *
+   * `operation` is called on the device strand and must call `done`
+   * exactly once, with the result of the device.
+   *
+   * \returns number of devices that succeeded
+   */
+  std::size_t run(bool isConnected,
+                  const std::function<void(Device&, std::function<void(bool)> done)>& operation);
+
+
+  /**
+   * \brief Device strand: starts the operation timer
+   *
+   * On expiry, the device is disconnected; pending operations complete
+   * with `operation_aborted`.
+   */
+  void startTimer(Device& device, int timeout_ms);
+
+
+  /**
+   * \brief Device strand: records the result of an operation
+   */
+  void finish(Device& device, const boost::system::error_code& error);
+
+
+  /**
+   * \brief Device strand: reads a complete response message
+   */
+  void readResponse(Device& device, std::function<void(const boost::system::error_code&)> done);
+
+
+};  // Fleet
+
+
+}       // rohdeschwarz::instruments
+#endif  // ROHDESCHWARZ_INSTRUMENTS_FLEET_HPP
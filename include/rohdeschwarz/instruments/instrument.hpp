@@ -9,10 +9,13 @@
 
 
 // rohdeschwarz
+#include "rohdeschwarz/busses/socket/tcp_info.hpp"
 #include "rohdeschwarz/busses/bus.hpp"
 #include "rohdeschwarz/scpi/block_data.hpp"
 #include "rohdeschwarz/scpi/bool.hpp"
+#include "rohdeschwarz/scpi/schema.hpp"
 #include "rohdeschwarz/helpers.hpp"
+#include "rohdeschwarz/probes.hpp"
 #include "rohdeschwarz/to_value.hpp"
 
 
@@ -25,17 +28,57 @@
 
 
 // std lib
+#include <atomic>
+#include <chrono>
 #include <complex>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 
+namespace rohdeschwarz::metrics
+{
+
+
+// forward declarations
+class BusTrace;
+class Metrics;
+class Recorder;
+
+
+}  // rohdeschwarz::metrics
+
+
 namespace rohdeschwarz::instruments
 {
 
 
+// forward declarations
+class Profiler;
+class TransferGovernor;
+
+
+/**
+ * \brief Statistics of the last block data transfer
+ *
+ * See `Instrument::setTcpInfoSampling`.
+ */
+struct BlockTransfer
+{
+  std::size_t size_B    = 0;
+  double      time_s    = 0;      ///< from the first read to the complete payload
+  bool        isTcpInfo = false;  ///< `before` and `after` are valid; TCP sockets on Linux only
+
+  rohdeschwarz::busses::socket::TcpInfo before;  ///< before the first read
+  rohdeschwarz::busses::socket::TcpInfo after;   ///< at the complete payload
+
+  double throughput_Bps() const;
+};
+
+
 /**
  * \brief Object-oriented R&S Instrument control
  *
@@ -76,13 +119,28 @@ public:
   /**
    * \brief Open tcp socket connection to an instrument
    *
-   * Attempts to connect to the instrument at `host` with a TCP socket on port `5025`.
+   * Attempts to connect to the instrument at `host` with a TCP socket on `port`.
    *
    * \param[in] host             host name or ip address
    * \param[in] timeout_ms open  timeout time, in milliseconds
+   * \param[in] port             TCP port; defaults to the SCPI raw socket port `5025`
+   * \returns `true` on success; `false` otherwise
+   */
+  bool openTcp(std::string host, unsigned int timeout_ms = 2000, int port = 5025);
+
+
+#if defined(__unix__) || defined(__APPLE__)
+  /**
+   * \brief Open Unix-domain socket connection, e.g. to a local instrument proxy
+   *
+   * See `rohdeschwarz::proxy::ProxyServer`. POSIX only.
+   *
+   * \param[in] path       socket path
+   * \param[in] timeout_ms read timeout time, in milliseconds
    * \returns `true` on success; `false` otherwise
    */
-  bool openTcp(std::string host, unsigned int timeout_ms = 2000);
+  bool openLocal(std::string path, unsigned int timeout_ms = 2000);
+#endif
 
 
   /**
@@ -91,6 +149,122 @@ public:
   void close();
 
 
+  // abort, device clear
+
+  /**
+   * \brief Sets a flag that aborts reads in progress
+   *
+   * While `*flag` is `true`, reads fail at the next chunk boundary: block
+   * data and other multi-chunk transfers, and status byte polling in
+   * `waitForOperationComplete`, return within one chunk or poll interval. Set by another thread; see
+   * `SharedInstrument::abort`. Follow an aborted read with `clear`.
+   *
+   * \param[in] flag abort flag; `nullptr` to disable
+   */
+  void setAbortFlag(const std::atomic<bool>* flag);
+
+
+  /**
+   * \brief Checks the abort flag
+   */
+  bool isAborted() const;
+
+
+  /**
+   * \brief Discards pending responses and resynchronizes the connection
+   *
+   * Device clear on VISA (`viClear`); drain-and-resync on sockets.
+   * See `rohdeschwarz::busses::Bus::clear`.
+   *
+   * \returns `true` on success; `false` otherwise
+   */
+  bool clear();
+
+
+  // transfer governor
+
+  /**
+   * \brief Shares a bulk transfer budget with other instruments
+   *
+   * Block data payloads larger than the bypass size of `governor` are read
+   * only when granted; see `TransferGovernor`.
+   *
+   * \param[in] governor governor; `nullptr` to disable
+   */
+  void setTransferGovernor(TransferGovernor* governor);
+
+
+  TransferGovernor* transferGovernor() const;
+
+
+  // profiler
+
+  /**
+   * \brief Attributes traffic to high-level calls
+   *
+   * Writes, round trips and block reads are counted in the open
+   * `ProfileScope`s of the calling thread; see `Profiler`.
+   *
+   * \param[in] profiler profiler; `nullptr` to disable
+   */
+  void setProfiler(Profiler* profiler);
+
+
+  Profiler* profiler() const;
+
+
+  // bus trace
+
+  /**
+   * \brief Records bus operations into `trace`
+   *
+   * See `rohdeschwarz::metrics::BusTrace`.
+   *
+   * \param[in] trace trace; `nullptr` to disable
+   */
+  void setBusTrace(rohdeschwarz::metrics::BusTrace* trace);
+
+
+  // tcp info
+
+  /**
+   * \brief Samples `TCP_INFO` before and after each block transfer
+   *
+   * Compares round trip time, retransmissions, congestion window and
+   * delivery rate with the throughput of the last block transfer, to tell
+   * a slow network from a slow instrument:
+   *
+   * ```c++
+   * vna.setTcpInfoSampling(true);
+   * trace.y();
+   * const BlockTransfer& transfer = vna.lastBlockTransfer();
+   * transfer.after.totalRetransmits - transfer.before.totalRetransmits;
+   * ```
+   *
+   * Costs two `getsockopt` calls per block; TCP sockets on Linux only.
+   */
+  void setTcpInfoSampling(bool isSampling);
+
+
+  bool isTcpInfoSampling() const;
+
+
+  const BlockTransfer& lastBlockTransfer() const;
+
+
+  // metrics
+
+  /**
+   * \brief Records traffic into `metrics`
+   *
+   * Counts commands, queries, bytes and timeouts and measures latencies
+   * per SCPI header; see `rohdeschwarz::metrics::Metrics`.
+   *
+   * \param[in] metrics metrics; `nullptr` to disable
+   */
+  void setMetrics(rohdeschwarz::metrics::Metrics* metrics);
+
+
   // io buffer
 
   std::size_t bufferSize_B() const;
@@ -135,6 +309,15 @@ public:
 
   // string io
 
+  /**
+   * \brief Reads a complete response message
+   *
+   * Reads until the message terminator (`\n`), outside of quoted
+   * strings and block data; data read beyond it is kept for the
+   * next read.
+   *
+   * \returns response, including the terminator; empty on error
+   */
   std::string read();
 
 
@@ -148,8 +331,13 @@ public:
       format % args;
     } (), ...);
 
-    // get complete command string
+    // get complete command string,
+    // with program message terminator
     auto command = format.str();
+    if (command.empty() || command.back() != '\n')
+    {
+      command.push_back('\n');
+    }
 
     // get data pointer, size
     using uchar_p = unsigned char*;
@@ -172,15 +360,20 @@ public:
   template<class... Args>
   std::string query(std::string scpi_command, Args&&... args)
   {
+    ROHDESCHWARZ_PROBE2(instrument__query__start, this, scpi_command.c_str());
+
     // write
-    if (!write(scpi_command, &args...))
+    if (!write(scpi_command, std::forward<Args>(args)...))
     {
       // error
+      ROHDESCHWARZ_PROBE2(instrument__query__done, this, 0);
       return std::string();
     }
 
     // read
-    return read();
+    std::string response = read();
+    ROHDESCHWARZ_PROBE2(instrument__query__done, this, response.size());
+    return response;
   }
 
 
@@ -196,9 +389,52 @@ public:
   template<class OutputType, class... Args>
   OutputType queryValue(std::string scpi_command, Args&&... args)
   {
-    return to_value<OutputType>(query(scpi_command, &args...));
+    return to_value<OutputType>(query(scpi_command, std::forward<Args>(args)...));
+  }
+
+  // schema io
+
+  /**
+   * \brief Reads a response and parses it with `Schema`
+   *
+   * `Schema` is a `rohdeschwarz::scpi::Schema`. For example:
+   *
+   * ```c++
+   * using namespace rohdeschwarz::scpi;
+   * auto [points, start_Hz] = instrument.readValues<Schema<unsigned int, double>>();
+   * ```
+   *
+   * \exception `std::invalid_argument` if the response does not match `Schema`
+   */
+  template<class Schema>
+  typename Schema::value_type readValues()
+  {
+    return Schema::parse(read());
   }
 
+
+  /**
+   * \brief Queries and parses the response with `Schema`
+   *
+   * Combined with compound queries (`;`), several values can be queried in
+   * a single round trip. For example:
+   *
+   * ```c++
+   * using namespace rohdeschwarz::scpi;
+   * using Sweep = Schema<unsigned int, double, double>;
+   * auto [points, start_Hz, stop_Hz]
+   *   = instrument.queryValues<Sweep>(":SENS1:SWE:POIN?;:SENS1:FREQ:STAR?;:SENS1:FREQ:STOP?");
+   * ```
+   *
+   * \exception `std::invalid_argument` if the response does not match `Schema`
+   */
+  template<class Schema, class... Args>
+  typename Schema::value_type queryValues(std::string scpi_command, Args&&... args)
+  {
+    return Schema::parse(query(scpi_command, std::forward<Args>(args)...));
+  }
+
+
   // scpi bool io
 
   bool readScpiBool();
@@ -207,7 +443,7 @@ public:
   bool queryScpiBool(std::string scpi_command, Args&&... args)
   {
     // write
-    if (!write(scpi_command, &args...))
+    if (!write(scpi_command, std::forward<Args>(args)...))
     {
       // error
       return false;
@@ -238,10 +474,50 @@ public:
    * \brief Read Block Data
    *
    * `readBlockData` reads data in IEEE 488.2 Block Data format.
+   *
+   * Data received past the end of the block (e.g. further responses
+   * of a compound query) is kept and consumed by the next read,
+   * so that consecutive blocks can be read from a single response.
    */
   scpi::BlockData readBlockData();
 
 
+  /**
+   * \brief Reads the next response of a compound response
+   *
+   * Reads up to the next response separator (`;`) or the response
+   * message terminator, outside of quoted strings. Data past the
+   * separator is kept for the next read.
+   *
+   * \returns response without separator; empty on error
+   */
+  std::string readNextResponse();
+
+
+  /**
+   * \brief Reads a Block Data header
+   *
+   * Use with `readBlockDataPayload` to read block data directly into
+   * caller-allocated memory once the payload size is known.
+   *
+   * \param[out] payloadSize_B payload size, in bytes
+   * \returns `true` on success; `false` otherwise
+   */
+  bool readBlockDataHeader(std::size_t* payloadSize_B);
+
+
+  /**
+   * \brief Reads Block Data payload directly into `destination`
+   *
+   * Requires a preceding `readBlockDataHeader`.
+   *
+   * \param[out] destination memory for at least `size_B` bytes
+   * \param[in]  size_B      payload size, in bytes
+   * \returns `true` on success; `false` otherwise
+   */
+  bool readBlockDataPayload(unsigned char* destination, std::size_t size_B);
+
+
   // block data vector io
 
   /**
@@ -318,9 +594,129 @@ public:
   bool blockUntilOperationComplete(unsigned int timeout_ms = 2000);
 
 
+  // status byte, operation complete events
+
+  /**
+   * \brief Reads the status byte
+   *
+   * Uses a bus-level serial poll (e.g. VISA `viReadSTB`) if supported;
+   * SCPI query `*STB?` otherwise.
+   *
+   * \param[out] statusByte status byte
+   * \returns `true` on success; `false` otherwise
+   */
+  bool readStatusByte(unsigned char* statusByte);
+
+
+  /**
+   * \brief Requests an operation complete event
+   *
+   * Sends `*ESR?;*ESE 1;*SRE 32;*OPC`: `*ESR?` clears events left over from
+   * a previous operation; when all pending operations are complete, the
+   * instrument sets the Event Status Bit (ESB) of the status byte and, on
+   * busses that support it, requests service (SRQ).
+   *
+   * Unlike `blockUntilOperationComplete`, the bus remains usable while the
+   * operation is pending. Send `armOperationComplete` after an overlapped
+   * command (e.g. `INIT`), then use `isOperationComplete` or
+   * `waitForOperationComplete`.
+   *
+   * \returns `true` on success; `false` otherwise
+   */
+  bool armOperationComplete();
+
+
+  /**
+   * \brief Checks for an operation complete event without blocking
+   *
+   * Requires `armOperationComplete`. If the operation is complete, the event
+   * status register is cleared with `*ESR?`, ready for the next operation.
+   *
+   * \returns `true` if the operation is complete; `false` otherwise
+   */
+  bool isOperationComplete();
+
+
+  /**
+   * \brief Waits for an operation complete event
+   *
+   * Requires `armOperationComplete`. Waits on service request events if the
+   * bus supports them (VISA); otherwise polls the status byte with an
+   * adaptive interval of 1 ms, growing to 8 ms. A service request for
+   * another reason falls back to polling until `timeout_ms`.
+   *
+   * \param[in] timeout_ms time to wait, in milliseconds
+   * \returns `true` if the operation completed; `false` on timeout or error
+   */
+  bool waitForOperationComplete(unsigned int timeout_ms = 2000);
+
+
 private:
 
-  std::shared_ptr<rohdeschwarz::busses::Bus> _bus;
+  std::shared_ptr<rohdeschwarz::busses::Bus>       _bus;
+  std::vector<unsigned char>                       _readAhead;
+  const std::atomic<bool>*                         _abortFlag         = nullptr;
+  TransferGovernor*                                _governor          = nullptr;
+  Profiler*                                        _profiler          = nullptr;
+  rohdeschwarz::metrics::BusTrace*                 _busTrace          = nullptr;
+  std::uint32_t                                    _busTraceSource    = 0;
+  bool                                             _isTcpInfoSampling = false;
+  BlockTransfer                                    _blockTransfer;
+  std::chrono::steady_clock::time_point            _blockStart;
+  std::shared_ptr<rohdeschwarz::metrics::Recorder> _recorder;
+
+
+  // helpers
+
+  /**
+   * \brief Reads data from the bus and appends it to the read-ahead buffer
+   */
+  bool readAhead();
+
+
+  /**
+   * \brief Consumes a response separator (`;`) or terminator (`\n`)
+   * following a block
+   */
+  bool consumeResponseSeparator();
+
+
+  /**
+   * \brief Metrics recorder, with the connection of the bus
+   */
+  rohdeschwarz::metrics::Recorder* recorder();
+
+
+  /**
+   * \brief Records a read that started at `start`
+   * with metrics, profiler and bus trace
+   */
+  void recordRead(std::chrono::steady_clock::time_point start, std::size_t size, bool isOk);
+
+
+  /**
+   * \brief Records the start of a block transfer,
+   * before its first read
+   */
+  void beginBlock();
+
+
+  /**
+   * \brief Records a complete block header
+   */
+  void startBlock(std::size_t size_B);
+
+
+  /**
+   * \brief Records a complete block payload
+   */
+  void completeBlock(std::size_t size_B);
+
+
+  /**
+   * \brief Bus trace source of the bus endpoint
+   */
+  std::uint32_t busTraceSource();
 
 
 };  // Instrument
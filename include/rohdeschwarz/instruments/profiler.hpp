@@ -0,0 +1,193 @@
+/**
+ * \file profiler.hpp
+ * \brief rohdeschwarz::instruments::Profiler definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_PROFILER_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_PROFILER_HPP
+
+
+// std lib
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments
+{
+
+
+// forward declarations
+class Instrument;
+
+
+/**
+ * \brief Traffic of one high-level call, e.g. `Trace::y`
+ */
+struct ProfileEntry
+{
+  std::string   name;
+  std::size_t   calls         = 0;
+  std::size_t   writes        = 0;  ///< program messages without queries
+  std::size_t   roundTrips    = 0;  ///< program messages with queries
+  std::size_t   tinyQueries   = 0;  ///< round trips with a small reply, not block data
+  std::size_t   blockReads    = 0;
+  std::uint64_t blockBytes    = 0;
+  std::uint64_t bytesOut      = 0;
+  std::uint64_t bytesIn       = 0;
+  std::uint64_t time_ns       = 0;  ///< wall time
+  std::uint64_t busTime_ns    = 0;  ///< time in bus writes and reads
+
+  /**
+   * \brief One line per call, e.g.
+   * `Trace::y: 9 round trips, 7 tiny queries, 1 block read 1.6 MB, 38 ms`
+   *
+   * Counts and times are means per call.
+   */
+  std::string toString() const;
+};
+
+
+/**
+ * \brief Attributes instrument traffic to high-level calls
+ *
+ * Methods such as `Trace::y`, `Channel::frequencies_Hz` and `Vna::isTrace`
+ * open a `ProfileScope`. While a profiler is set, every write, round trip
+ * and block read of the instrument is counted in all open scopes of the
+ * calling thread, so that nested calls, e.g. the queries of
+ * `PreserveDataFormat` within `Trace::y`, show up both on their own and
+ * in the call that caused them:
+ *
+ * ```c++
+ * Profiler profiler;
+ * vna.setProfiler(&profiler);
+ * trace.y();
+ * profiler.print(std::cout);
+ * ```
+ *
+ * ```
+ * Trace::y: 4 round trips, 2 tiny queries, 1 block read 1.6 MB, 38 ms
+ * ```
+ *
+ * Applications add scopes of their own with `ProfileScope`. Traffic
+ * outside of any scope is not recorded.
+ *
+ * `Profiler` may be shared by instruments and threads. It must outlive
+ * the instruments that use it.
+ */
+class Profiler
+{
+
+public:
+
+  /**
+   * \brief Replies up to this size, that are not block data,
+   * are tiny queries
+   */
+  static constexpr std::size_t TINY_REPLY_SIZE_B = 1024;
+
+
+  // record; see Instrument
+
+  void recordWrite(const unsigned char* data, std::size_t size, std::chrono::nanoseconds elapsed);
+
+
+  void recordRead(std::size_t size, std::chrono::nanoseconds elapsed);
+
+
+  void recordBlock(std::size_t size_B);
+
+
+  // report
+
+  /**
+   * \brief Entries, sorted by total time, longest first
+   */
+  std::vector<ProfileEntry> entries() const;
+
+
+  /**
+   * \brief Prints `entries`, one line per call
+   */
+  void print(std::ostream& stream) const;
+
+
+  void clear();
+
+
+private:
+
+  friend class ProfileScope;
+
+
+  mutable std::mutex                  _mutex;
+  std::map<std::string, ProfileEntry> _entries;
+
+
+  void add(const ProfileEntry& entry);
+
+
+};  // Profiler
+
+
+/**
+ * \brief Profiles a high-level call until destroyed
+ *
+ * Does nothing if `instrument` has no profiler.
+ *
+ * ```c++
+ * std::vector<double> Trace::y()
+ * {
+ *   ProfileScope profile(_vna, "Trace::y");
+ *   ...
+ * }
+ * ```
+ */
+class ProfileScope
+{
+
+public:
+
+  ProfileScope(Instrument* instrument, const char* name);
+
+
+  ProfileScope(Profiler* profiler, const char* name);
+
+
+  ~ProfileScope();
+
+
+  ProfileScope(const ProfileScope&)            = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+
+private:
+
+  friend class Profiler;
+
+
+  Profiler*                             _profiler;
+  ProfileScope*                         _parent;
+  std::chrono::steady_clock::time_point _start;
+  ProfileEntry                          _entry;
+
+  // reply of the last round trip
+  bool        _isReplyPending;
+  bool        _isBlock;
+  std::size_t _replySize_B;
+
+
+  void finishReply();
+
+
+};  // ProfileScope
+
+
+}       // rohdeschwarz::instruments
+#endif  // ROHDESCHWARZ_INSTRUMENTS_PROFILER_HPP
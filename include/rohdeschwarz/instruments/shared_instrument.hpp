@@ -0,0 +1,418 @@
+/**
+ * \file shared_instrument.hpp
+ * \brief rohdeschwarz::instruments::SharedInstrument definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_SHARED_INSTRUMENT_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_SHARED_INSTRUMENT_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/instrument.hpp"
+#include "rohdeschwarz/mpsc_queue.hpp"
+#include "rohdeschwarz/scpi/block_data.hpp"
+
+
+// boost
+#include "boost/format.hpp"
+
+
+// std lib
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+
+namespace rohdeschwarz::instruments
+{
+
+
+/**
+ * \brief Command priority of `SharedInstrument`
+ */
+enum class Lane
+{
+  Urgent,       ///< e.g. abort, RF off; always first
+  Interactive,  ///< default
+  Bulk          ///< e.g. trace data; only when the other lanes are empty
+};
+
+
+/**
+ * \brief Thread-safe access to an `Instrument`
+ *
+ * `SharedInstrument` accepts commands from any number of threads through a
+ * lock-free multi-producer queue and executes them in order on a dedicated
+ * I/O thread, which owns the `Instrument`. Queries return a `std::future`:
+ *
+ * ```c++
+ * SharedInstrument shared(&vna);
+ *
+ * // any thread
+ * shared.write(":SENS1:SWE:POIN %1%", 201);
+ * std::future<std::string> id = shared.query("*IDN?");
+ * id.get();
+ *
+ * // anything else, with exclusive access to the instrument
+ * std::future<TraceData> data = shared.submit([](Instrument& instrument)
+ * {
+ *   return static_cast<Vna&>(instrument).allTraceData();
+ * });
+ * ```
+ *
+ * Adjacent writes, and the query that follows them, are batched into a
+ * single bus write of several program messages, up to 64 KB.
+ *
+ * Each command is queued in a `Lane`. Between commands, the I/O thread
+ * takes the next command from the highest-priority lane that is not
+ * empty. A command in progress is not interrupted, unless aborted:
+ *
+ * ```c++
+ * // safety: stop a multi-MB transfer in the bulk lane
+ * shared.abort();
+ * shared.write(Lane::Urgent, ":OUTP OFF");
+ * ```
+ *
+ * `abort` fails the command in progress at its next chunk boundary. The
+ * pending response is then discarded with `Instrument::clear` (device clear
+ * on VISA, drain-and-resync on sockets), and urgent writes are sent right
+ * after it, so that the clear cannot discard them.
+ *
+ * Commands from one thread in one lane execute in the order they were
+ * queued. While running, do not use the `Instrument` from other threads.
+ *
+ * Commands queued after `stop` are not executed; their futures throw
+ * `std::future_error` (`broken_promise`).
+ */
+class SharedInstrument
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor; starts the I/O thread
+   *
+   * \param[in] instrument pointer to an open `Instrument`
+   */
+  SharedInstrument(Instrument* instrument);
+
+
+  /**
+   * \brief Destructor; executes queued commands, then stops
+   */
+  ~SharedInstrument();
+
+
+  SharedInstrument(const SharedInstrument&)            = delete;
+  SharedInstrument& operator=(const SharedInstrument&) = delete;
+
+
+  /**
+   * \brief Executes queued commands, then stops the I/O thread
+   */
+  void stop();
+
+
+  bool isRunning() const;
+
+
+  // commands
+
+  /**
+   * \brief Queues a command; see `Instrument::write`
+   *
+   * Write errors are counted by `errors`.
+   *
+   * \returns `true` if queued; `false` if stopped
+   */
+  template<class... Args>
+  bool write(std::string scpi_command, Args&&... args)
+  {
+    return write(Lane::Interactive, scpi_command, std::forward<Args>(args)...);
+  }
+
+
+  /**
+   * \brief Queues a command in `lane`
+   */
+  template<class... Args>
+  bool write(Lane lane, std::string scpi_command, Args&&... args)
+  {
+    Command command;
+    command.type    = Type::Write;
+    command.message = format(scpi_command, std::forward<Args>(args)...);
+    return push(lane, std::move(command));
+  }
+
+
+  /**
+   * \brief Queues a query; see `Instrument::query`
+   *
+   * \returns future response; empty on error
+   */
+  template<class... Args>
+  std::future<std::string> query(std::string scpi_command, Args&&... args)
+  {
+    return query(Lane::Interactive, scpi_command, std::forward<Args>(args)...);
+  }
+
+
+  /**
+   * \brief Queues a query in `lane`
+   */
+  template<class... Args>
+  std::future<std::string> query(Lane lane, std::string scpi_command, Args&&... args)
+  {
+    Command command;
+    command.type     = Type::Query;
+    command.message  = format(scpi_command, std::forward<Args>(args)...);
+    command.response = std::make_shared<std::promise<std::string>>();
+    auto response = command.response->get_future();
+    push(lane, std::move(command));
+    return response;
+  }
+
+
+  /**
+   * \brief Queues a block data query; see `Instrument::readBlockData`
+   *
+   * \returns future block data; incomplete on error or abort
+   */
+  template<class... Args>
+  std::future<scpi::BlockData> queryBlockData(std::string scpi_command, Args&&... args)
+  {
+    return queryBlockData(Lane::Interactive, scpi_command, std::forward<Args>(args)...);
+  }
+
+
+  /**
+   * \brief Queues a block data query in `lane`
+   */
+  template<class... Args>
+  std::future<scpi::BlockData> queryBlockData(Lane lane, std::string scpi_command, Args&&... args)
+  {
+    const std::string message = format(scpi_command, std::forward<Args>(args)...);
+    return submit(lane, [message](Instrument& instrument)
+    {
+      if (!instrument.write("%1%", message))
+      {
+        // error
+        return scpi::BlockData();
+      }
+      return instrument.readBlockData();
+    });
+  }
+
+
+  /**
+   * \brief Queues `function` for execution on the I/O thread
+   *
+   * `function` is called with exclusive access to the instrument, e.g. for
+   * calls that take several round trips. `function` must be copyable.
+   * If `function` throws, the exception is rethrown by `std::future::get`.
+   *
+   * \returns future result of `function`
+   */
+  template<class Function>
+  auto submit(Function function) -> std::future<decltype(function(std::declval<Instrument&>()))>
+  {
+    return submit(Lane::Interactive, std::move(function));
+  }
+
+
+  /**
+   * \brief Queues `function` in `lane`
+   */
+  template<class Function>
+  auto submit(Lane lane, Function function) -> std::future<decltype(function(std::declval<Instrument&>()))>
+  {
+    using result_type = decltype(function(std::declval<Instrument&>()));
+    auto promise = std::make_shared<std::promise<result_type>>();
+    auto result  = promise->get_future();
+
+    Command command;
+    command.type = Type::Task;
+    command.task = [promise, function](Instrument& instrument) mutable
+    {
+      // note: exceptions (e.g. parsing an empty
+      // response) are forwarded to the future
+      try
+      {
+        if constexpr (std::is_void_v<result_type>)
+        {
+          function(instrument);
+          promise->set_value();
+        }
+        else
+        {
+          promise->set_value(function(instrument));
+        }
+      }
+      catch (...)
+      {
+        promise->set_exception(std::current_exception());
+      }
+    };
+    push(lane, std::move(command));
+    return result;
+  }
+
+
+  // abort
+
+  /**
+   * \brief Aborts the command in progress
+   *
+   * The command in progress fails at its next chunk boundary: queries
+   * return empty, block data incomplete. Pending responses are discarded
+   * with `Instrument::clear`, then queued urgent writes are sent.
+   * Queued commands are not affected.
+   */
+  void abort();
+
+
+  // statistics
+
+  /**
+   * \brief Number of commands executed
+   */
+  std::size_t commands() const;
+
+
+  /**
+   * \brief Number of bus writes of batched commands
+   */
+  std::size_t busWrites() const;
+
+
+  /**
+   * \brief Number of failed writes and queries
+   */
+  std::size_t errors() const;
+
+
+  /**
+   * \brief Number of aborts
+   */
+  std::size_t aborts() const;
+
+
+private:
+
+  enum class Type
+  {
+    Write,
+    Query,
+    Task
+  };
+
+
+  struct Command
+  {
+    Type                                        type = Type::Write;
+    std::string                                 message;
+    std::shared_ptr<std::promise<std::string>> response;
+    std::function<void(Instrument&)>            task;
+  };
+
+
+  Instrument*                       _instrument;
+  std::array<MpscQueue<Command>, 3> _lanes;
+
+
+  // thread
+  std::thread              _worker;
+  std::mutex               _mutex;
+  std::condition_variable  _condition;
+  std::atomic<bool>        _isIdle;
+  std::atomic<bool>        _isRunning;
+  std::atomic<bool>        _isStopRequested;
+  std::atomic<bool>        _isAbortRequested;
+
+
+  // statistics
+  std::atomic<std::size_t> _commands;
+  std::atomic<std::size_t> _busWrites;
+  std::atomic<std::size_t> _errors;
+  std::atomic<std::size_t> _aborts;
+
+
+  // helpers
+
+  /**
+   * \brief Formats a program message, with terminator
+   */
+  template<class... Args>
+  static std::string format(const std::string& scpi_command, Args&&... args)
+  {
+    auto format = boost::format(scpi_command);
+    ([&]
+    {
+      format % args;
+    } (), ...);
+
+    auto message = format.str();
+    if (message.empty() || message.back() != '\n')
+    {
+      message.push_back('\n');
+    }
+    return message;
+  }
+
+
+  /**
+   * \brief Queues `command` in `lane` and wakes the I/O thread, if idle
+   */
+  bool push(Lane lane, Command command);
+
+
+  /**
+   * \brief Takes the next command, by priority
+   *
+   * \returns lane of the command; `nullptr` if all lanes are empty
+   */
+  MpscQueue<Command>* next(Command* command);
+
+
+  /**
+   * \brief Checks for empty lanes
+   */
+  bool isEmpty() const;
+
+
+  /**
+   * \brief Clears the instrument, then sends queued urgent writes
+   */
+  void recover();
+
+
+  /**
+   * \brief I/O thread
+   */
+  void run();
+
+
+  /**
+   * \brief Executes a write or query and the writes batched with it
+   */
+  void execute(MpscQueue<Command>& lane, Command& command);
+
+
+};  // SharedInstrument
+
+
+}       // rohdeschwarz::instruments
+#endif  // ROHDESCHWARZ_INSTRUMENTS_SHARED_INSTRUMENT_HPP
@@ -0,0 +1,222 @@
+/**
+ * \file transfer_governor.hpp
+ * \brief rohdeschwarz::instruments::TransferGovernor definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_TRANSFER_GOVERNOR_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_TRANSFER_GOVERNOR_HPP
+
+
+// std lib
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+
+
+namespace rohdeschwarz::instruments
+{
+
+
+// forward declarations
+class Instrument;
+
+
+/**
+ * \brief Limits the bytes in flight of bulk transfers across instruments
+ *
+ * When many instruments return large block data at once, their transfers
+ * share, and saturate, the same network link; round trips of unrelated
+ * queries then wait behind them. A `TransferGovernor` shared by several
+ * instruments admits bulk transfers only while the sum of their sizes is
+ * within a budget:
+ *
+ * ```c++
+ * TransferGovernor governor(16 * 1024 * 1024);
+ * for (Vna& vna : vnas)
+ * {
+ *   vna.setTransferGovernor(&governor);
+ * }
+ * ```
+ *
+ * `Instrument` requests a grant for each block data payload larger than
+ * the bypass size, after reading the block header, and releases it when
+ * the payload is read. Smaller responses, e.g. of control queries, bypass
+ * the governor entirely.
+ *
+ * Waiting transfers are granted in round-robin order of instruments, so
+ * that an instrument with many queued transfers cannot starve the others.
+ * A transfer larger than the budget is granted when nothing else is in
+ * flight.
+ *
+ * Note: a transfer that waits for its grant is held back by TCP flow
+ * control. Up to one socket receive buffer per waiting instrument is in
+ * flight in addition to the budget.
+ */
+class TransferGovernor
+{
+
+public:
+
+  /**
+   * \brief Admission of a bulk transfer; releases it on destruction
+   */
+  class Grant
+  {
+
+  public:
+
+    Grant();
+    Grant(Grant&& other);
+    Grant& operator=(Grant&& other);
+    ~Grant();
+
+
+    Grant(const Grant&)            = delete;
+    Grant& operator=(const Grant&) = delete;
+
+
+    /**
+     * \brief Releases the transfer budget
+     */
+    void release();
+
+
+  private:
+
+    friend class TransferGovernor;
+
+    Grant(TransferGovernor* governor, std::size_t size_B);
+
+    TransferGovernor* _governor;
+    std::size_t       _size_B;
+
+  };  // Grant
+
+
+  // life cycle
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] budget_B maximum bytes in flight
+   * \param[in] bypass_B transfers of up to `bypass_B` are not governed
+   */
+  TransferGovernor(std::size_t budget_B, std::size_t bypass_B = 64 * 1024);
+
+
+  TransferGovernor(const TransferGovernor&)            = delete;
+  TransferGovernor& operator=(const TransferGovernor&) = delete;
+
+
+  std::size_t budget_B() const;
+
+
+  std::size_t bypass_B() const;
+
+
+  // transfers
+
+  /**
+   * \brief Waits until a transfer of `size_B` bytes by `instrument` fits
+   * into the budget
+   *
+   * \returns grant; releases the budget when destroyed
+   */
+  Grant acquire(const Instrument* instrument, std::size_t size_B);
+
+
+  // statistics
+
+  /**
+   * \brief Bytes in flight
+   */
+  std::size_t inFlight_B() const;
+
+
+  /**
+   * \brief Maximum of bytes in flight
+   */
+  std::size_t peakInFlight_B() const;
+
+
+  /**
+   * \brief Number of granted transfers
+   */
+  std::size_t grants() const;
+
+
+  /**
+   * \brief Number of granted transfers that had to wait
+   */
+  std::size_t waited() const;
+
+
+  /**
+   * \brief Number of transfers that bypassed the governor
+   */
+  std::size_t bypassed() const;
+
+
+private:
+
+  /**
+   * \brief Waiting transfer
+   */
+  struct Ticket
+  {
+    std::size_t size_B;
+    bool        isGranted;
+  };
+
+
+  const std::size_t _budget_B;
+  const std::size_t _bypass_B;
+
+
+  // note: guarded by _mutex
+  mutable std::mutex                               _mutex;
+  std::condition_variable                          _condition;
+  std::map<const Instrument*, std::deque<Ticket*>> _queues;
+  std::deque<const Instrument*>                    _turns;
+  std::size_t                                      _inFlight_B;
+  std::size_t                                      _peakInFlight_B;
+
+
+  // statistics
+  std::atomic<std::size_t> _grants;
+  std::atomic<std::size_t> _waited;
+  std::atomic<std::size_t> _bypassed;
+
+
+  // helpers
+
+  /**
+   * \brief Checks that a transfer of `size_B` fits into the budget
+   */
+  bool fits(std::size_t size_B) const;
+
+
+  /**
+   * \brief Grants `size_B`; requires a lock of `_mutex`
+   */
+  void grant(std::size_t size_B);
+
+
+  /**
+   * \brief Grants waiting transfers, in turn, while they fit
+   */
+  void dispatch();
+
+
+  void release(std::size_t size_B);
+
+
+};  // TransferGovernor
+
+
+}       // rohdeschwarz::instruments
+#endif  // ROHDESCHWARZ_INSTRUMENTS_TRANSFER_GOVERNOR_HPP
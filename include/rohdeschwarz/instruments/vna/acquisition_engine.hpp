@@ -0,0 +1,214 @@
+/**
+ * \file acquisition_engine.hpp
+ * \brief rohdeschwarz::instruments::vna::AcquisitionEngine definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_ACQUISITION_ENGINE_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_ACQUISITION_ENGINE_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/trace_data.hpp"
+#include "rohdeschwarz/spsc_ring.hpp"
+
+
+// std lib
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+// forward declarations
+class Vna;
+
+
+/**
+ * \brief A completed sweep, in a slot of `AcquisitionEngine`
+ */
+struct Sweep
+{
+  std::size_t                           sequence;
+  std::chrono::steady_clock::time_point time;
+  TraceData                             data;
+};
+
+
+/**
+ * \brief What `AcquisitionEngine` does when all slots are full
+ */
+enum class OverflowPolicy
+{
+  Block,      ///< wait for the consumer before triggering the next sweep
+  DropNewest  ///< keep sweeping; discard sweeps until a slot is free
+};
+
+
+/**
+ * \brief Continuous background acquisition into a ring of preallocated slots
+ *
+ * A background thread repeatedly triggers a channel, waits for the sweep
+ * and fetches the selected traces (see `Channel::acquire`) directly into
+ * the next free slot of a lock-free single-producer, single-consumer ring.
+ * All slots are allocated on `start`; nothing is allocated per sweep.
+ *
+ * The consumer thread reads completed sweeps in place:
+ *
+ * ```c++
+ * AcquisitionEngine engine(&vna, 1, {"Trc1", "Trc2"});
+ * engine.start();
+ * while (const Sweep* sweep = engine.read(1000))
+ * {
+ *   process(sweep->data);
+ *   engine.release();
+ * }
+ * engine.stop();
+ * ```
+ *
+ * `Sweep::sequence` counts all sweeps, including dropped sweeps, so gaps
+ * are visible to the consumer. While running, the background thread owns
+ * the `Vna` connection; do not use `vna` from other threads.
+ */
+class AcquisitionEngine
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] vna     pointer to underlying `Vna` instance
+   * \param[in] channel channel index
+   * \param[in] traces  names of traces in `channel` to fetch
+   * \param[in] slots   number of ring slots; rounded up to a power of two
+   * \param[in] policy  overflow policy
+   */
+  AcquisitionEngine(Vna* vna, unsigned int channel, std::vector<std::string> traces,
+                    std::size_t slots = 8, OverflowPolicy policy = OverflowPolicy::Block);
+
+
+  /**
+   * \brief Destructor; stops acquisition
+   */
+  ~AcquisitionEngine();
+
+
+  AcquisitionEngine(const AcquisitionEngine&)            = delete;
+  AcquisitionEngine& operator=(const AcquisitionEngine&) = delete;
+
+
+  // control
+
+  /**
+   * \brief Allocates slots and starts the background thread
+   */
+  bool start();
+
+
+  /**
+   * \brief Stops the background thread, after the sweep in progress
+   */
+  void stop();
+
+
+  /**
+   * \brief Checks if the background thread is running
+   */
+  bool isRunning() const;
+
+
+  /**
+   * \brief Checks if the background thread stopped on an error
+   */
+  bool isError() const;
+
+
+  // consumer
+
+  /**
+   * \brief Gets the oldest completed sweep, if any
+   *
+   * Call `release` when done with the sweep.
+   *
+   * \returns completed sweep; `nullptr` if none
+   */
+  const Sweep* tryRead();
+
+
+  /**
+   * \brief Waits for the oldest completed sweep
+   *
+   * Call `release` when done with the sweep.
+   *
+   * \param[in] timeout_ms timeout, in milliseconds
+   * \returns completed sweep; `nullptr` on timeout or if stopped
+   */
+  const Sweep* read(unsigned int timeout_ms);
+
+
+  /**
+   * \brief Returns the slot of the sweep from `tryRead` / `read`
+   */
+  void release();
+
+
+  // statistics
+
+  /**
+   * \brief Number of sweeps handed to the consumer
+   */
+  std::size_t sweeps() const;
+
+
+  /**
+   * \brief Number of sweeps dropped (`OverflowPolicy::DropNewest`)
+   */
+  std::size_t dropped() const;
+
+
+private:
+
+  Vna*                     _vna;
+  unsigned int             _channel;
+  std::vector<std::string> _traces;
+  std::size_t              _slots;
+  OverflowPolicy           _policy;
+
+
+  // ring
+  std::unique_ptr<SpscRing<Sweep>> _ring;
+  Sweep                            _scratch;
+
+
+  // thread
+  std::thread              _thread;
+  std::atomic<bool>        _isRunning;
+  std::atomic<bool>        _isStopRequested;
+  std::atomic<bool>        _isError;
+  std::atomic<std::size_t> _sweeps;
+  std::atomic<std::size_t> _dropped;
+
+
+  // helpers
+
+  /**
+   * \brief Background thread: trigger, wait, fetch into ring
+   */
+  void run();
+
+
+};  // AcquisitionEngine
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_ACQUISITION_ENGINE_HPP
@@ -9,6 +9,8 @@
 
 
 // std lib
+#include <complex>
+#include <string>
 #include <vector>
 
 
@@ -17,9 +19,45 @@ namespace rohdeschwarz::instruments::vna
 
 
 // forward declarations
+class SParameterMatrix;
+class TraceData;
 class Vna;
 
 
+/**
+ * \brief Channel sweep configuration
+ *
+ * See `Channel::configuration()`
+ */
+struct ChannelConfiguration
+{
+  unsigned int points;
+  double       startFrequency_Hz;
+  double       stopFrequency_Hz;
+};
+
+
+/**
+ * \brief Channel sweep timing
+ *
+ * See `Channel::sweepTiming()`
+ */
+struct SweepTiming
+{
+  double       sweepTime_s;
+  unsigned int sweeps;
+
+
+  /**
+   * \brief predicted duration of a triggered sweep (all `sweeps`), in `s`
+   */
+  double duration_s() const
+  {
+    return sweepTime_s * sweeps;
+  }
+};
+
+
 /** \brief Object-oriented measurement channel control
  *
  * `Channel` provides object-oriented control of an R&S ZNX-series VNA Channel
@@ -100,12 +138,199 @@ public:
   std::vector<double> frequencies_Hz();
 
 
+  // configuration
+
+  /**
+   * \brief queries the sweep configuration in a single round trip
+   *
+   * Uses a compound query parsed with `rohdeschwarz::scpi::Schema`.
+   *
+   * \exception `std::invalid_argument` if the response cannot be parsed
+   */
+  ChannelConfiguration configuration();
+
+
+  // sweep time (s)
+
+  /**
+   * \brief queries the duration of a single sweep, in `s`
+   */
+  double sweepTime_s();
+
+
+  /**
+   * \brief sets the duration of a single sweep
+   *
+   * \param[in] time_s sweep duration, in `s`
+   */
+  void setSweepTime(double time_s);
+
+
+  // sweep count
+
+  /**
+   * \brief queries the number of sweeps per trigger
+   */
+  unsigned int sweepCount();
+
+
+  /**
+   * \brief sets the number of sweeps per trigger
+   *
+   * \param[in] count number of sweeps
+   */
+  void setSweepCount(unsigned int count);
+
+
+  // averaging
+
+  /**
+   * \brief queries the averaging state
+   */
+  bool isAveraging();
+
+
+  /**
+   * \brief sets the averaging state
+   *
+   * \param[in] isAveraging `true` to enable averaging
+   */
+  void setAveraging(bool isAveraging);
+
+
+  /**
+   * \brief queries the averaging factor
+   */
+  unsigned int averageCount();
+
+
+  /**
+   * \brief sets the averaging factor
+   *
+   * \param[in] count averaging factor
+   */
+  void setAverageCount(unsigned int count);
+
+
+  // sweep
+
+  /**
+   * \brief Predicted sweep timing
+   *
+   * Queried once per configuration and cached by `Vna`.
+   * Setters of `Channel` invalidate the cache; use
+   * `Vna::clearSweepTimingCache` after changing the
+   * configuration by other means.
+   */
+  SweepTiming sweepTiming();
+
+
+  /**
+   * \brief Starts a sweep and arms the operation complete event
+   *
+   * See `Vna::startSweep`
+   */
+  bool startSweep();
+
+
+  /**
+   * \brief Waits for the sweep started with `startSweep`
+   *
+   * See `Vna::waitForSweep`
+   */
+  bool waitForSweep();
+
+
+  /**
+   * \brief Performs a sweep; `startSweep`, then `waitForSweep`
+   */
+  bool sweep();
+
+
+  // acquire
+
+  /**
+   * \brief Performs a sweep and returns the unformatted Y values of `traces`
+   *
+   * Sends a single program message that sets the data format, starts the
+   * sweep, waits for it (`*WAI`) and queries the data of all `traces`.
+   * The blocks of the compound response are then read in order.
+   * The read timeout is derived from `sweepTiming()`.
+   *
+   * As in `Trace::y_complex`, the data format is restored afterwards.
+   * On a read error, pending responses are discarded with `Vna::clear`.
+   *
+   * \param[in] traces names of traces in this channel
+   * \returns data per trace, in order of `traces`; empty on error
+   */
+  std::vector<std::vector<std::complex<double>>> acquire(const std::vector<std::string>& traces);
+
+
+  /**
+   * \brief Performs a sweep and reads the unformatted Y values of `traces`
+   * into preallocated `data`
+   *
+   * Same as `acquire(const std::vector<std::string>&)`, without allocation.
+   *
+   * \param[in]  traces names of traces in this channel
+   * \param[out] data   trace data, shaped for `traces` and the number of points
+   * \returns `true` on success; `false` otherwise
+   */
+  bool acquire(const std::vector<std::string>& traces, TraceData* data);
+
+
+  // bulk data
+
+  /**
+   * \brief Reads the unformatted data of all traces in this channel
+   *
+   * Reads the data in a single round trip and a single block transfer;
+   * preserving the data format takes one more round trip.
+   * See `Vna::allTraceData`.
+   */
+  TraceData allTraceData();
+
+
+  /**
+   * \brief Reads the S-parameter matrix of `ports`
+   *
+   * Defines an S-parameter group for `ports` (`CALC<ch>:PAR:DEF:SGR`),
+   * which does not create traces, and reads all `N x N` S-parameters in a
+   * single block (`CALC<ch>:DATA:SGR? SDAT`), in a single round trip.
+   *
+   * The previous S-parameter group is queried in the same round trip and
+   * restored afterwards, or deleted if there was none. The data format is
+   * restored afterwards, which takes one more round trip. On a read error,
+   * the pending block is discarded with `Vna::clear`.
+   *
+   * \param[in] ports physical port numbers, e.g. `{1, 2, 3, 4}`
+   * \returns S-parameter matrix; empty on error
+   */
+  SParameterMatrix sParameterMatrix(const std::vector<unsigned int>& ports);
+
+
 private:
 
   Vna*         _vna;
   unsigned int _index;
 
 
+  // helpers
+
+  /**
+   * \brief Extends the timeout for a sweep, then writes the
+   * sweep-and-fetch program message for `traces`
+   */
+  bool writeAcquire(const std::vector<std::string>& traces);
+
+
+  /**
+   * \brief Restores the S-parameter group `ports`, as queried with
+   * `CALC<ch>:PAR:DEF:SGR?`; deletes the group if `ports` is empty
+   */
+  void restoreSParameterGroup(const std::string& ports);
+
+
 };  // Channel
 
 
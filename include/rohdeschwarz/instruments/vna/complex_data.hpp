@@ -0,0 +1,89 @@
+/**
+ * \file complex_data.hpp
+ * \brief rohdeschwarz::instruments::vna::ComplexData definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_COMPLEX_DATA_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_COMPLEX_DATA_HPP
+
+
+// std lib
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+/**
+ * \brief Unformatted complex data in a single contiguous buffer
+ *
+ * The buffer is allocated once, on construction, and can be filled
+ * directly from block data (binary 64-bit, little-endian).
+ *
+ * Shared storage of `TraceData`, `SweepHistory` and `SParameterMatrix`,
+ * which define the shape of the data.
+ */
+class ComplexData
+{
+
+public:
+
+  // data
+
+  /**
+   * \brief Checks for no data
+   */
+  bool isEmpty() const;
+
+
+  /**
+   * \brief Pointer to all data
+   */
+  std::complex<double>*       data();
+  const std::complex<double>* data() const;
+
+
+  /**
+   * \brief Number of values
+   */
+  std::size_t size() const;
+
+
+  /**
+   * \brief Size of all data, in bytes
+   */
+  std::size_t size_B() const;
+
+
+protected:
+
+  // life cycle
+
+  /**
+   * \brief Default constructor; no data
+   */
+  ComplexData();
+
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] size number of values
+   */
+  explicit ComplexData(std::size_t size);
+
+
+private:
+
+  std::vector<std::complex<double>> _data;
+
+
+};  // ComplexData
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_COMPLEX_DATA_HPP
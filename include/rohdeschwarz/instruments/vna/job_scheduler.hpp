@@ -0,0 +1,274 @@
+/**
+ * \file job_scheduler.hpp
+ * \brief rohdeschwarz::instruments::vna::JobScheduler definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_JOB_SCHEDULER_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_JOB_SCHEDULER_HPP
+
+
+// std lib
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+// forward declarations
+class Vna;
+
+
+/**
+ * \brief Utilization of an instrument of `JobScheduler`
+ */
+struct InstrumentUtilization
+{
+  std::size_t jobs             = 0;  ///< jobs executed
+  std::size_t reconfigurations = 0;  ///< setup changes
+  std::size_t steals           = 0;  ///< jobs taken from other instruments
+  double      busy_s           = 0;  ///< time spent in jobs, including setup
+  double      utilization      = 0;  ///< busy time / time since construction
+  std::string setup;                 ///< current setup; empty if unknown
+};
+
+
+/**
+ * \brief Runs measurement jobs on a pool of equivalent instruments
+ *
+ * Each `Vna` is driven by its own worker thread, with its own job queue. A
+ * job names the instrument setup it needs; the scheduler remembers the
+ * setup of each instrument and only calls the job's `configure` function
+ * if the instrument it runs on has a different setup:
+ *
+ * ```c++
+ * JobScheduler scheduler({&vna1, &vna2, &vna3});
+ *
+ * auto configure = [](Vna& vna)
+ * {
+ *   return vna.write(":MMEM:LOAD:STAT 1,'s21_1GHz.znxml'")
+ *       && vna.blockUntilOperationComplete(10000);
+ * };
+ * std::future<bool> result = scheduler.submit("s21_1GHz", configure, [&](Vna& vna)
+ * {
+ *   return measure(vna, dut);
+ * });
+ * ```
+ *
+ * Jobs are routed, in order of preference, to an idle instrument with the
+ * same setup, the instrument that has the same setup after its queued jobs,
+ * any idle instrument, or the shortest queue. A worker that runs out of
+ * jobs steals from the queues of busy workers: first a job for its own
+ * setup, otherwise the newest job of the longest queue. Instruments are
+ * never idle while jobs are queued.
+ *
+ * Idle workers sleep until a job is routed to them, or until jobs become
+ * available to steal; then a single idle worker is woken.
+ *
+ * Jobs without a setup run on any instrument, without reconfiguration.
+ * If `configure` fails, the setup of the instrument is unknown and the job
+ * fails without running.
+ *
+ * While running, the scheduler owns the `Vna` connections; do not use them
+ * from other threads.
+ */
+class JobScheduler
+{
+
+public:
+
+  /**
+   * \brief Job or setup function; returns `true` on success
+   */
+  using Function = std::function<bool(Vna&)>;
+
+
+  // life cycle
+
+  /**
+   * \brief Constructor; starts a worker thread per instrument
+   *
+   * \param[in] vnas pointers to open, equivalent `Vna` sessions
+   */
+  JobScheduler(std::vector<Vna*> vnas);
+
+
+  /**
+   * \brief Destructor; executes queued jobs, then stops
+   */
+  ~JobScheduler();
+
+
+  JobScheduler(const JobScheduler&)            = delete;
+  JobScheduler& operator=(const JobScheduler&) = delete;
+
+
+  /**
+   * \brief Executes queued jobs, then stops the worker threads
+   */
+  void stop();
+
+
+  // jobs
+
+  /**
+   * \brief Queues a job that needs `setup`
+   *
+   * \param[in] setup     name of the instrument setup
+   * \param[in] configure applies `setup` to an instrument
+   * \param[in] job       measurement
+   * \returns future result of `job`; `false` on error or if stopped.
+   *   If `configure` or `job` throws, the exception is rethrown by
+   *   `std::future::get`.
+   */
+  std::future<bool> submit(std::string setup, Function configure, Function job);
+
+
+  /**
+   * \brief Queues a job that runs with any setup
+   */
+  std::future<bool> submit(Function job);
+
+
+  /**
+   * \brief Waits until all queued jobs are complete
+   */
+  void wait();
+
+
+  // statistics
+
+  /**
+   * \brief Number of instruments
+   */
+  std::size_t size() const;
+
+
+  InstrumentUtilization utilization(std::size_t index) const;
+
+
+private:
+
+  using clock_type = std::chrono::steady_clock;
+
+
+  struct Job
+  {
+    std::string                          setup;
+    Function                             configure;
+    Function                             function;
+    std::shared_ptr<std::promise<bool>> result;
+  };
+
+
+  /**
+   * \brief Instrument, its job queue and statistics
+   */
+  struct Worker
+  {
+    Vna*        vna;
+    std::thread thread;
+
+    // note: guarded by mutex
+    mutable std::mutex mutex;
+    std::deque<Job>    jobs;
+    std::string        setup;
+    bool               isBusy = false;
+
+    // sleep
+    // note: guarded by JobScheduler::_mutex
+    std::condition_variable condition;
+    bool                    isSleeping      = false;
+    bool                    isWakeRequested = false;
+
+    // statistics
+    std::atomic<std::size_t>   executed{0};
+    std::atomic<std::size_t>   reconfigurations{0};
+    std::atomic<std::size_t>   steals{0};
+    std::atomic<std::uint64_t> busy_ns{0};
+  };
+
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  clock_type::time_point               _start;
+
+
+  // sleep, completion
+  std::mutex               _mutex;
+  std::condition_variable  _done;
+  std::size_t              _queued;
+  std::size_t              _stealable;  ///< incremented when jobs become stealable
+  std::size_t              _unfinished;
+  bool                     _isStopRequested;
+  bool                     _isRunning;
+
+
+  // helpers
+
+  /**
+   * \brief Selects the worker for a job that needs `setup`
+   */
+  Worker& route(const std::string& setup);
+
+
+  /**
+   * \brief Worker thread
+   */
+  void run(Worker& worker);
+
+
+  /**
+   * \brief Takes the next job of `worker`
+   */
+  bool pop(Worker& worker, Job* job);
+
+
+  /**
+   * \brief Takes a job from another worker's queue
+   */
+  bool steal(Worker& worker, Job* job);
+
+
+  /**
+   * \brief Configures, if necessary, and runs `job` on `worker`
+   */
+  void execute(Worker& worker, Job& job);
+
+
+  /**
+   * \brief Wakes `worker`; requires `_mutex`
+   */
+  void notify(Worker& worker);
+
+
+  /**
+   * \brief Signals that jobs of `owner` can be stolen,
+   * and wakes one sleeping worker to steal them; requires `_mutex`
+   */
+  void notifyThief(const Worker& owner);
+
+
+  /**
+   * \brief Wakes all workers; requires `_mutex`
+   */
+  void notifyAll();
+
+
+};  // JobScheduler
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_JOB_SCHEDULER_HPP
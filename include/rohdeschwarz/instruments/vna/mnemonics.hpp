@@ -0,0 +1,130 @@
+/**
+ * \file mnemonics.hpp
+ * \brief rohdeschwarz::instruments::vna SCPI mnemonic types and tables
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_MNEMONICS_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_MNEMONICS_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/scpi/schema.hpp"
+
+
+// std lib
+#include <array>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+// data transfer format
+
+/**
+ * \brief Data transfer format, as in SCPI query `FORM?`
+ */
+enum class TransferFormat
+{
+  Ascii,
+  Binary32Bit,
+  Binary64Bit
+};
+
+
+/**
+ * \brief Mnemonic table for `TransferFormat`
+ *
+ * For use with `rohdeschwarz::scpi::Mnemonic`
+ */
+struct TransferFormats
+{
+  using type = TransferFormat;
+  static constexpr std::array<scpi::MnemonicEntry<type>, 3> entries
+  {{
+    {"ASC",     TransferFormat::Ascii},
+    {"REAL,32", TransferFormat::Binary32Bit},
+    {"REAL,64", TransferFormat::Binary64Bit}
+  }};
+};
+
+
+// byte order
+
+/**
+ * \brief Byte order for binary data transfer, as in SCPI query `FORM:BORD?`
+ */
+enum class ByteOrder
+{
+  BigEndian,
+  LittleEndian
+};
+
+
+/**
+ * \brief Mnemonic table for `ByteOrder`
+ *
+ * For use with `rohdeschwarz::scpi::Mnemonic`
+ */
+struct ByteOrders
+{
+  using type = ByteOrder;
+  static constexpr std::array<scpi::MnemonicEntry<type>, 2> entries
+  {{
+    {"NORM", ByteOrder::BigEndian},
+    {"SWAP", ByteOrder::LittleEndian}
+  }};
+};
+
+
+// trace format
+
+/**
+ * \brief Trace format, as in SCPI query `CALC<ch>:FORM?`
+ *
+ * See the [table of formats](https://www.rohde-schwarz.com/webhelp/ZNA_HTML_UserManual_en/Content/132d40cd4d1d43c4.htm#d843242e119475) from the ZNA manual.
+ */
+enum class TraceFormat
+{
+  LinearMagnitude,     // MLIN
+  LogMagnitude,        // MLOG
+  Phase,               // PHAS
+  UnwrappedPhase,      // UPH
+  Polar,               // POL
+  Smith,               // SMIT
+  InvertedSmith,       // ISM
+  GroupDelay,          // GDEL
+  Real,                // REAL
+  Imaginary,           // IMAG
+  Swr                  // SWR
+};
+
+
+/**
+ * \brief Mnemonic table for `TraceFormat`
+ *
+ * For use with `rohdeschwarz::scpi::Mnemonic`
+ */
+struct TraceFormats
+{
+  using type = TraceFormat;
+  static constexpr std::array<scpi::MnemonicEntry<type>, 11> entries
+  {{
+    {"MLIN", TraceFormat::LinearMagnitude},
+    {"MLOG", TraceFormat::LogMagnitude},
+    {"PHAS", TraceFormat::Phase},
+    {"UPH",  TraceFormat::UnwrappedPhase},
+    {"POL",  TraceFormat::Polar},
+    {"SMIT", TraceFormat::Smith},
+    {"ISM",  TraceFormat::InvertedSmith},
+    {"GDEL", TraceFormat::GroupDelay},
+    {"REAL", TraceFormat::Real},
+    {"IMAG", TraceFormat::Imaginary},
+    {"SWR",  TraceFormat::Swr}
+  }};
+};
+
+
+}       // namespace rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_MNEMONICS_HPP
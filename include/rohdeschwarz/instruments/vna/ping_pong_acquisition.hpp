@@ -0,0 +1,137 @@
+/**
+ * \file ping_pong_acquisition.hpp
+ * \brief rohdeschwarz::instruments::vna::PingPongAcquisition definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_PING_PONG_ACQUISITION_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_PING_PONG_ACQUISITION_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/trace_data.hpp"
+
+
+// std lib
+#include <cstddef>
+#include <string>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+// forward declarations
+class Vna;
+
+
+/**
+ * \brief Alternating acquisition on two identically configured channels
+ *
+ * While one channel sweeps, the data of the other channel's completed
+ * sweep is read and processed. When transfer and processing take about
+ * as long as a sweep, this roughly doubles the sweep rate.
+ *
+ * ```c++
+ * PingPongAcquisition acquisition(&vna, 1, 2);
+ * acquisition.start();
+ * TraceData data;
+ * while (acquisition.next(&data))
+ * {
+ *   // process data, while the other channel sweeps
+ * }
+ * acquisition.stop();
+ * ```
+ *
+ * `start` turns continuous sweep off and restricts the trigger scope
+ * to a single channel (`INIT:SCOP SING`), so that each channel can be
+ * triggered separately. `stop`, or the destructor, restores the previous
+ * sweep mode (`INIT:CONT:ALL`, `INIT:SCOP`).
+ */
+class PingPongAcquisition
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] vna      pointer to underlying `Vna` instance
+   * \param[in] channelA index of first channel
+   * \param[in] channelB index of second channel
+   */
+  PingPongAcquisition(Vna* vna, unsigned int channelA, unsigned int channelB);
+
+
+  /**
+   * \brief Destructor; stops acquisition and restores the sweep mode
+   */
+  ~PingPongAcquisition();
+
+
+  PingPongAcquisition(const PingPongAcquisition&)            = delete;
+  PingPongAcquisition& operator=(const PingPongAcquisition&) = delete;
+
+
+  /**
+   * \brief Starts acquisition; triggers the first channel
+   */
+  bool start();
+
+
+  /**
+   * \brief Checks if acquisition is started
+   */
+  bool isStarted() const;
+
+
+  /**
+   * \brief Gets the data of the next completed sweep
+   *
+   * Waits for the sweeping channel to complete, triggers the other
+   * channel, then reads all traces of the completed channel while the
+   * other channel sweeps.
+   *
+   * \param[out] data    trace data of the completed sweep
+   * \param[out] channel index of the completed channel (optional)
+   * \returns `true` on success; `false` otherwise
+   */
+  bool next(TraceData* data, unsigned int* channel = nullptr);
+
+
+  /**
+   * \brief Stops acquisition; waits for the pending sweep, if any, and
+   * restores the sweep mode saved by `start`
+   *
+   * Also restores the sweep mode after `next` failed.
+   */
+  bool stop();
+
+
+  /**
+   * \brief Number of sweeps completed since `start`
+   */
+  std::size_t sweeps() const;
+
+
+private:
+
+  Vna*         _vna;
+  unsigned int _channels[2];
+  std::size_t  _sweeping;
+  bool         _isStarted;
+  std::size_t  _sweeps;
+
+  // sweep mode before start
+  bool         _isSweepModeSaved;
+  bool         _isContinuous;
+  std::string  _triggerScope;
+
+
+};  // PingPongAcquisition
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_PING_PONG_ACQUISITION_HPP
@@ -58,6 +58,7 @@ private:
   bool _is64Bit;
   bool _isBigEndian;
   DataFormat _dataFormat;
+  Vna*       _vna;
 
 
   // helpers
@@ -0,0 +1,115 @@
+/**
+ * \file s_parameter_matrix.hpp
+ * \brief rohdeschwarz::instruments::vna::SParameterMatrix definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_S_PARAMETER_MATRIX_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_S_PARAMETER_MATRIX_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/complex_data.hpp"
+
+
+// std lib
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+/**
+ * \brief N-port S-parameter data in a contiguous `[point][i][j]` tensor
+ *
+ * For each measurement point, the `N x N` S-parameter matrix is stored
+ * row-major: `S(point, i, j)` is at
+ * `data() + point * pointStride() + i * rowStride() + j`.
+ * `i` and `j` index into `ports()`; that is, `(0, 1)` is `S12` for
+ * ports `{1, 2}`.
+ *
+ * Each matrix can be passed directly to BLAS-style routines as a
+ * row-major `N x N` matrix with leading dimension `rowStride()`.
+ *
+ * See `Channel::sParameterMatrix`.
+ */
+class SParameterMatrix : public ComplexData
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Default constructor; no data
+   */
+  SParameterMatrix();
+
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] ports  physical port numbers
+   * \param[in] points number of measurement points
+   */
+  SParameterMatrix(std::vector<unsigned int> ports, std::size_t points);
+
+
+  // shape
+
+  /**
+   * \brief Port numbers, in matrix order
+   */
+  const std::vector<unsigned int>& ports() const;
+
+
+  /**
+   * \brief Number of measurement points
+   */
+  std::size_t points() const;
+
+
+  // strides, in elements
+
+  /**
+   * \brief Distance between the matrices of consecutive points
+   */
+  std::size_t pointStride() const;
+
+
+  /**
+   * \brief Distance between consecutive rows of a matrix
+   */
+  std::size_t rowStride() const;
+
+
+  // data
+
+  /**
+   * \brief Pointer to the `N x N` matrix of measurement point `point`
+   */
+  std::complex<double>*       matrix(std::size_t point);
+  const std::complex<double>* matrix(std::size_t point) const;
+
+
+  /**
+   * \brief S-parameter `(i, j)` of measurement point `point`
+   */
+  std::complex<double>&       operator()(std::size_t point, std::size_t i, std::size_t j);
+  const std::complex<double>& operator()(std::size_t point, std::size_t i, std::size_t j) const;
+
+
+private:
+
+  std::vector<unsigned int> _ports;
+  std::size_t               _points;
+
+
+};  // SParameterMatrix
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_S_PARAMETER_MATRIX_HPP
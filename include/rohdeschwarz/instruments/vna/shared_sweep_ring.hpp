@@ -0,0 +1,278 @@
+/**
+ * \file shared_sweep_ring.hpp
+ * \brief rohdeschwarz::instruments::vna::SharedSweepRingWriter and
+ * SharedSweepRingReader definitions
+ *
+ * Available on POSIX systems only.
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_SHARED_SWEEP_RING_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_SHARED_SWEEP_RING_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/trace_data.hpp"
+
+
+// std lib
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+/**
+ * \brief Read-only view of a sweep in a `SharedSweepRingReader`
+ *
+ * The view points directly into shared memory. The writer may overwrite
+ * the slot at any time; check `SharedSweepRingReader::isValid` after
+ * using the data.
+ */
+struct SharedSweepView
+{
+  std::size_t                     sweep;
+  std::int64_t                    time_ns;
+  unsigned int                    channel;
+  std::size_t                     frequencyGridId;
+  const std::vector<std::string>* names;
+  const std::complex<double>*     data;
+  std::size_t                     points;
+  std::uint64_t                   sequence;
+
+
+  /**
+   * \brief View of trace `index`
+   */
+  TraceView trace(std::size_t index) const
+  {
+    return {&(*names)[index], data + index * points, points};
+  }
+};
+
+
+/**
+ * \brief Publishes sweeps to a POSIX shared-memory ring
+ *
+ * Creates the shared-memory object `name` (see `shm_open`) with a fixed
+ * number of slots, each shaped for `traces` with `points` points. Each
+ * published sweep overwrites the oldest slot; slots are protected by a
+ * seqlock, so the writer never waits for readers. Readers in other
+ * processes use `SharedSweepRingReader`.
+ *
+ * On Linux, waiting readers are woken with a futex.
+ */
+class SharedSweepRingWriter
+{
+
+public:
+
+  // life cycle
+
+  SharedSweepRingWriter();
+
+
+  /**
+   * \brief Destructor; closes and removes the ring
+   */
+  ~SharedSweepRingWriter();
+
+
+  SharedSweepRingWriter(const SharedSweepRingWriter&)            = delete;
+  SharedSweepRingWriter& operator=(const SharedSweepRingWriter&) = delete;
+
+
+  /**
+   * \brief Creates the ring
+   *
+   * Fails if a shared-memory object `name` exists, e.g. the ring of
+   * another writer. To replace a stale ring left by a writer that did not
+   * close it, call `remove` first.
+   *
+   * \param[in] name   shared-memory object name, e.g. `/znb-sweeps`
+   * \param[in] slots  number of slots
+   * \param[in] traces trace names
+   * \param[in] points number of points per trace
+   * \returns `true` on success; `false` otherwise
+   */
+  bool create(const std::string& name, std::size_t slots,
+              const std::vector<std::string>& traces, std::size_t points);
+
+
+  /**
+   * \brief Removes the shared-memory object `name`
+   *
+   * Readers that have it mapped keep their mapping.
+   *
+   * \returns `true` on success; `false` otherwise
+   */
+  static bool remove(const std::string& name);
+
+
+  /**
+   * \brief Checks for an open ring
+   */
+  bool isOpen() const;
+
+
+  /**
+   * \brief Closes and removes the ring
+   */
+  void close();
+
+
+  /**
+   * \brief Publishes a sweep
+   *
+   * \param[in] data            trace data, shaped as the ring
+   * \param[in] channel         channel index
+   * \param[in] frequencyGridId see `frequencyGridId`
+   * \returns `true` on success; `false` if not open or shapes differ
+   */
+  bool publish(const TraceData& data, unsigned int channel = 0, std::size_t frequencyGridId = 0);
+
+
+  /**
+   * \brief Number of published sweeps
+   */
+  std::size_t published() const;
+
+
+private:
+
+  std::string    _name;
+  void*          _memory;
+  std::size_t    _size_B;
+  std::size_t    _published;
+
+
+};  // SharedSweepRingWriter
+
+
+/**
+ * \brief Maps a `SharedSweepRingWriter` ring for reading
+ *
+ * ```c++
+ * SharedSweepRingReader reader;
+ * reader.open("/znb-sweeps");
+ * std::size_t sweep = reader.published();
+ * SharedSweepView view;
+ * while (reader.wait(sweep, 1000) && reader.view(sweep, &view))
+ * {
+ *   process(view.trace(0));
+ *   if (!reader.isValid(view))
+ *   {
+ *     // overwritten while processing; too slow
+ *   }
+ *   sweep++;
+ * }
+ * ```
+ */
+class SharedSweepRingReader
+{
+
+public:
+
+  // life cycle
+
+  SharedSweepRingReader();
+
+
+  /**
+   * \brief Destructor; unmaps the ring
+   */
+  ~SharedSweepRingReader();
+
+
+  SharedSweepRingReader(const SharedSweepRingReader&)            = delete;
+  SharedSweepRingReader& operator=(const SharedSweepRingReader&) = delete;
+
+
+  /**
+   * \brief Maps the ring `name`
+   *
+   * The layout in the ring header is checked against the size of the
+   * shared-memory object.
+   *
+   * \returns `true` on success; `false` if not found, not ready,
+   *   truncated or not a ring
+   */
+  bool open(const std::string& name);
+
+
+  /**
+   * \brief Checks for an open ring
+   */
+  bool isOpen() const;
+
+
+  /**
+   * \brief Unmaps the ring
+   */
+  void close();
+
+
+  // shape
+
+  std::size_t slots()  const;
+  std::size_t points() const;
+  const std::vector<std::string>& names() const;
+
+
+  // sweeps
+
+  /**
+   * \brief Number of sweeps published by the writer
+   */
+  std::size_t published() const;
+
+
+  /**
+   * \brief Waits until sweep `sweep` (0-based) is published
+   *
+   * \returns `true` if published; `false` on timeout
+   */
+  bool wait(std::size_t sweep, unsigned int timeout_ms) const;
+
+
+  /**
+   * \brief Gets a view of sweep `sweep`
+   *
+   * \returns `true` on success; `false` if not published yet, or overwritten
+   */
+  bool view(std::size_t sweep, SharedSweepView* view) const;
+
+
+  /**
+   * \brief Checks that the slot of `view` has not been overwritten
+   */
+  bool isValid(const SharedSweepView& view) const;
+
+
+  /**
+   * \brief Copies sweep `sweep` consistently into `data`
+   *
+   * \param[in]  sweep sweep number
+   * \param[out] data  trace data, shaped as the ring
+   * \returns `true` on success; `false` if not published, or overwritten
+   */
+  bool copy(std::size_t sweep, TraceData* data) const;
+
+
+private:
+
+  void*                    _memory;
+  std::size_t              _size_B;
+  std::vector<std::string> _names;
+
+
+};  // SharedSweepRingReader
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_SHARED_SWEEP_RING_HPP
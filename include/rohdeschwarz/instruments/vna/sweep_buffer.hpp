@@ -0,0 +1,234 @@
+/**
+ * \file sweep_buffer.hpp
+ * \brief rohdeschwarz::instruments::vna::SweepBuffer, SweepRef and
+ * SweepBufferPool definitions
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_BUFFER_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_BUFFER_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/channel.hpp"
+#include "rohdeschwarz/instruments/vna/trace_data.hpp"
+
+
+// std lib
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+// forward declarations
+class SweepBufferPool;
+
+
+/**
+ * \brief Sweep metadata
+ */
+struct SweepMetadata
+{
+  std::size_t                           sequence;
+  std::chrono::steady_clock::time_point time;
+  unsigned int                          channel;
+  std::size_t                           frequencyGridId;
+};
+
+
+/**
+ * \brief Identifies a frequency grid, for comparing sweeps
+ *
+ * Sweeps with equal ids share points, start and stop frequency.
+ */
+std::size_t frequencyGridId(const ChannelConfiguration& configuration);
+
+
+/**
+ * \brief Sweep data and metadata, owned by a `SweepBufferPool`
+ *
+ * A buffer is filled by the producer, then published as a `SweepRef`.
+ * Once published, it is immutable and shared by all references.
+ */
+class SweepBuffer
+{
+
+public:
+
+  SweepMetadata metadata;
+  TraceData     data;
+
+
+private:
+
+  friend class SweepBufferPool;
+  friend class SweepRef;
+
+  std::atomic<std::size_t> _references;
+  SweepBufferPool*         _pool;
+
+
+  /**
+   * \brief Constructor
+   */
+  SweepBuffer(SweepBufferPool* pool, const TraceData& prototype);
+
+
+};  // SweepBuffer
+
+
+/**
+ * \brief Reference-counted, read-only reference to a published `SweepBuffer`
+ *
+ * Copying a `SweepRef` copies the reference, not the data. When the last
+ * reference is destroyed, the buffer returns to its pool.
+ */
+class SweepRef
+{
+
+public:
+
+  // life cycle
+
+  SweepRef();
+  SweepRef(const SweepRef& other);
+  SweepRef(SweepRef&& other) noexcept;
+  SweepRef& operator=(const SweepRef& other);
+  SweepRef& operator=(SweepRef&& other) noexcept;
+  ~SweepRef();
+
+
+  // access
+
+  /**
+   * \brief Checks for a referenced buffer
+   */
+  explicit operator bool() const;
+
+
+  const SweepBuffer* get() const;
+  const SweepBuffer* operator->() const;
+  const SweepBuffer& operator*() const;
+
+
+  /**
+   * \brief Number of references to the buffer
+   */
+  std::size_t useCount() const;
+
+
+  /**
+   * \brief Releases the reference
+   */
+  void reset();
+
+
+private:
+
+  friend class SweepBufferPool;
+
+  SweepBuffer* _buffer;
+
+
+  /**
+   * \brief Constructor; adopts a reference to `buffer`
+   */
+  explicit SweepRef(SweepBuffer* buffer);
+
+
+};  // SweepRef
+
+
+/**
+ * \brief Fixed pool of preallocated `SweepBuffer`s
+ *
+ * ```c++
+ * SweepBufferPool pool(16, TraceData(names, points));
+ * SweepBuffer* buffer = pool.acquire();
+ * channel.acquire(names, &buffer->data);
+ * buffer->metadata = {sequence, now, channel.index(), grid_id};
+ * SweepRef sweep = pool.publish(buffer);
+ * ```
+ *
+ * All buffers are allocated on construction. The pool must outlive all
+ * `SweepRef`s to its buffers.
+ */
+class SweepBufferPool
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] buffers   number of buffers
+   * \param[in] prototype shape of the data of each buffer
+   */
+  SweepBufferPool(std::size_t buffers, const TraceData& prototype);
+
+
+  SweepBufferPool(const SweepBufferPool&)            = delete;
+  SweepBufferPool& operator=(const SweepBufferPool&) = delete;
+
+
+  // buffers
+
+  /**
+   * \brief Takes a free buffer for writing
+   *
+   * \returns free buffer; `nullptr` if all buffers are in use
+   */
+  SweepBuffer* acquire();
+
+
+  /**
+   * \brief Publishes a buffer from `acquire`
+   *
+   * The buffer must not be modified afterwards.
+   *
+   * \returns first reference to the buffer
+   */
+  SweepRef publish(SweepBuffer* buffer);
+
+
+  /**
+   * \brief Returns an unpublished buffer from `acquire`
+   */
+  void discard(SweepBuffer* buffer);
+
+
+  /**
+   * \brief Number of free buffers
+   */
+  std::size_t available() const;
+
+
+private:
+
+  friend class SweepRef;
+
+  std::vector<std::unique_ptr<SweepBuffer>> _buffers;
+  std::vector<SweepBuffer*>                 _free;
+  mutable std::mutex                        _mutex;
+
+
+  /**
+   * \brief Returns `buffer` to the free list
+   */
+  void recycle(SweepBuffer* buffer);
+
+
+};  // SweepBufferPool
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_BUFFER_HPP
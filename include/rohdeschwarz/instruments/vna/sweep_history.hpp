@@ -0,0 +1,87 @@
+/**
+ * \file sweep_history.hpp
+ * \brief rohdeschwarz::instruments::vna::SweepHistory definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_HISTORY_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_HISTORY_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/complex_data.hpp"
+
+
+// std lib
+#include <complex>
+#include <cstddef>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+/**
+ * \brief Unformatted data of consecutive sweeps of a trace in a single
+ * contiguous `[sweep][point]` buffer
+ *
+ * Sweep `0` is the first sweep of the sweep group.
+ *
+ * See `Trace::sweepHistory`.
+ */
+class SweepHistory : public ComplexData
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Default constructor; no data
+   */
+  SweepHistory();
+
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] sweeps number of sweeps
+   * \param[in] points number of points per sweep
+   */
+  SweepHistory(std::size_t sweeps, std::size_t points);
+
+
+  // shape
+
+  /**
+   * \brief Number of sweeps
+   */
+  std::size_t sweeps() const;
+
+
+  /**
+   * \brief Number of points per sweep
+   */
+  std::size_t points() const;
+
+
+  // data
+
+  /**
+   * \brief Pointer to the data of sweep `index`
+   */
+  std::complex<double>*       sweep(std::size_t index);
+  const std::complex<double>* sweep(std::size_t index) const;
+
+
+private:
+
+  std::size_t _sweeps;
+  std::size_t _points;
+
+
+};  // SweepHistory
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_HISTORY_HPP
@@ -0,0 +1,146 @@
+/**
+ * \file sweep_publisher.hpp
+ * \brief rohdeschwarz::instruments::vna::SweepSubscription and
+ * SweepPublisher definitions
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_PUBLISHER_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_PUBLISHER_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/sweep_buffer.hpp"
+#include "rohdeschwarz/spsc_ring.hpp"
+
+
+// std lib
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+/**
+ * \brief Bounded queue of published sweeps for a single consumer
+ *
+ * See `SweepPublisher::subscribe`.
+ */
+class SweepSubscription
+{
+
+public:
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] capacity queue capacity; rounded up to a power of two
+   */
+  explicit SweepSubscription(std::size_t capacity);
+
+
+  /**
+   * \brief Takes the oldest sweep, if any
+   *
+   * \param[out] sweep reference to the sweep
+   * \returns `true` if a sweep was taken; `false` if empty
+   */
+  bool tryTake(SweepRef* sweep);
+
+
+  /**
+   * \brief Number of sweeps dropped because the queue was full
+   */
+  std::size_t dropped() const;
+
+
+private:
+
+  friend class SweepPublisher;
+
+  SpscRing<SweepRef>       _queue;
+  std::atomic<std::size_t> _dropped;
+
+
+  /**
+   * \brief Queues a reference to `sweep`; drops it if full
+   */
+  void push(const SweepRef& sweep);
+
+
+};  // SweepSubscription
+
+
+/**
+ * \brief Fans out published sweeps to several subscribers without copying
+ *
+ * Each subscriber gets its own bounded queue of `SweepRef`s to the same,
+ * immutable buffers. A subscriber that falls behind drops sweeps without
+ * affecting other subscribers; buffers return to their pool once every
+ * subscriber has released them.
+ *
+ * ```c++
+ * SweepPublisher publisher;
+ * auto plot    = publisher.subscribe(4);
+ * auto archive = publisher.subscribe(64);
+ *
+ * // producer thread
+ * publisher.publish(pool.publish(buffer));
+ *
+ * // consumer threads
+ * SweepRef sweep;
+ * while (plot->tryTake(&sweep))
+ * {
+ *   draw(sweep->data);
+ * }
+ * ```
+ *
+ * `publish` must be called from a single producer thread.
+ */
+class SweepPublisher
+{
+
+public:
+
+  /**
+   * \brief Adds a subscriber
+   *
+   * \param[in] capacity queue capacity of the subscriber
+   */
+  std::shared_ptr<SweepSubscription> subscribe(std::size_t capacity);
+
+
+  /**
+   * \brief Removes a subscriber
+   */
+  void unsubscribe(const std::shared_ptr<SweepSubscription>& subscription);
+
+
+  /**
+   * \brief Number of subscribers
+   */
+  std::size_t subscribers() const;
+
+
+  /**
+   * \brief Queues a reference to `sweep` for each subscriber
+   */
+  void publish(const SweepRef& sweep);
+
+
+private:
+
+  std::vector<std::shared_ptr<SweepSubscription>> _subscriptions;
+  mutable std::mutex                              _mutex;
+
+
+};  // SweepPublisher
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_SWEEP_PUBLISHER_HPP
@@ -19,6 +19,7 @@ namespace rohdeschwarz::instruments::vna
 
 
 // forward declarations
+class SweepHistory;
 class Vna;
 
 /**
@@ -52,6 +53,16 @@ public:
   Trace(Vna* vna, const std::string& name);
 
 
+  /**
+   * \brief Constructor
+   *
+   * \param[in] vna     Pointer to underlying `Vna` instance
+   * \param[in] name    Name of existing trace to control as C++ style string
+   * \param[in] channel Index of the channel of the trace, if known
+   */
+  Trace(Vna* vna, const std::string& name, unsigned int channel);
+
+
   /**
    * \brief Trace name
    */
@@ -130,6 +141,8 @@ public:
 
   /**
    * \brief Queries the index of the measurement channel for this trace
+   *
+   * The channel of a trace does not change; it is queried once, then cached.
    */
   unsigned int channel();
 
@@ -168,10 +181,38 @@ public:
   std::vector<std::complex<double>> y_complex();
 
 
+  /**
+   * \brief Performs a sweep and returns the unformatted Y values
+   *
+   * See `Channel::acquire`.
+   */
+  std::vector<std::complex<double>> acquire();
+
+
+  /**
+   * \brief Reads the unformatted data of the first `count` sweeps of the
+   * last sweep group
+   *
+   * Requires a completed single sweep with a sweep count
+   * (`Channel::setSweepCount`) of at least `count`. The trace is selected,
+   * and all `count` sweeps are queried (`CALC<ch>:DATA:NSW:FIRS? SDAT,<n>`)
+   * in a single program message. The blocks are read, back to back,
+   * directly into a preallocated buffer.
+   *
+   * The data format is restored afterwards. On a read error, the
+   * remaining blocks are discarded with `Vna::clear`.
+   *
+   * \param[in] count number of sweeps
+   * \returns sweep history; empty on error
+   */
+  SweepHistory sweepHistory(std::size_t count);
+
+
 private:
 
-  Vna*        _vna;
-  std::string _name;
+  Vna*         _vna;
+  std::string  _name;
+  unsigned int _channel;
 
 
 };
@@ -0,0 +1,143 @@
+/**
+ * \file trace_data.hpp
+ * \brief rohdeschwarz::instruments::vna::TraceData definition
+ */
+
+
+#ifndef ROHDESCHWARZ_INSTRUMENTS_VNA_TRACE_DATA_HPP
+#define ROHDESCHWARZ_INSTRUMENTS_VNA_TRACE_DATA_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/complex_data.hpp"
+
+
+// std lib
+#include <complex>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace rohdeschwarz::instruments::vna
+{
+
+
+/**
+ * \brief Read-only view of the data of a single trace in `TraceData`
+ */
+struct TraceView
+{
+  const std::string*          name;
+  const std::complex<double>* data;
+  std::size_t                 points;
+
+
+  const std::complex<double>* begin() const
+  {
+    return data;
+  }
+
+
+  const std::complex<double>* end() const
+  {
+    return data + points;
+  }
+
+
+  const std::complex<double>& operator[](std::size_t point) const
+  {
+    return data[point];
+  }
+};
+
+
+/**
+ * \brief Unformatted data of several traces in a single contiguous buffer
+ *
+ * Data is stored `[trace][point]`: the points of each trace are
+ * contiguous, and traces follow each other in order. Traces may
+ * differ in number of points (e.g. traces of different channels).
+ *
+ * See `Channel::allTraceData` and `Vna::allTraceData`.
+ */
+class TraceData : public ComplexData
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Default constructor; no traces
+   */
+  TraceData();
+
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] names  trace names
+   * \param[in] points number of points, per trace
+   */
+  TraceData(std::vector<std::string> names, const std::vector<std::size_t>& points);
+
+
+  // shape
+
+  /**
+   * \brief Number of traces
+   */
+  std::size_t traces() const;
+
+
+  /**
+   * \brief Number of points of trace `index`
+   */
+  std::size_t points(std::size_t index) const;
+
+
+  /**
+   * \brief Trace names, in order
+   */
+  const std::vector<std::string>& names() const;
+
+
+  // data
+
+  /**
+   * \brief Pointer to the data of trace `index`
+   */
+  std::complex<double>*       row(std::size_t index);
+  const std::complex<double>* row(std::size_t index) const;
+
+
+  // views
+
+  /**
+   * \brief View of trace `index`
+   */
+  TraceView operator[](std::size_t index) const;
+
+
+  /**
+   * \brief Finds a trace by name
+   *
+   * \param[in]  name trace name
+   * \param[out] view view of the trace, if found
+   * \returns `true` if found; `false` otherwise
+   */
+  bool find(const std::string& name, TraceView* view) const;
+
+
+private:
+
+  std::vector<std::string> _names;
+  std::vector<std::size_t> _offsets;
+
+
+};  // TraceData
+
+
+}       // rohdeschwarz::instruments::vna
+#endif  // ROHDESCHWARZ_INSTRUMENTS_VNA_TRACE_DATA_HPP
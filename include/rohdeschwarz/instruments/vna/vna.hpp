@@ -10,13 +10,22 @@
 
 // rohdeschwarz
 #include "rohdeschwarz/instruments/instrument.hpp"
+#include "rohdeschwarz/instruments/vna/acquisition_engine.hpp"
 #include "rohdeschwarz/instruments/vna/channel.hpp"
 #include "rohdeschwarz/instruments/vna/data_format.hpp"
 #include "rohdeschwarz/instruments/vna/display.hpp"
+#include "rohdeschwarz/instruments/vna/ping_pong_acquisition.hpp"
+#include "rohdeschwarz/instruments/vna/s_parameter_matrix.hpp"
+#include "rohdeschwarz/instruments/vna/sweep_buffer.hpp"
+#include "rohdeschwarz/instruments/vna/sweep_history.hpp"
+#include "rohdeschwarz/instruments/vna/sweep_publisher.hpp"
 #include "rohdeschwarz/instruments/vna/trace.hpp"
+#include "rohdeschwarz/instruments/vna/trace_data.hpp"
 
 
 // std lib
+#include <chrono>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -139,6 +148,104 @@ public:
   std::vector<std::string> traces();
 
 
+  // bulk data
+
+
+  /**
+   * \brief Reads the unformatted data of all traces in all channels
+   *
+   * See `allTraceData(const std::vector<unsigned int>&)`
+   */
+  TraceData allTraceData();
+
+
+  /**
+   * \brief Reads the unformatted data of all traces in `channels`
+   *
+   * Sends a single program message that queries the number of points and
+   * the trace catalog of each channel, followed by one bulk data query
+   * (`CALC<ch>:DATA:CHAN:ALL? SDAT`) per channel. Each block is read
+   * directly into the rows of the returned `TraceData`.
+   *
+   * The data format is restored afterwards. On a read error, pending
+   * responses are discarded with `clear`.
+   *
+   * \param[in] channels channel indexes
+   * \returns trace data; empty on error
+   */
+  TraceData allTraceData(const std::vector<unsigned int>& channels);
+
+
+  // sweep
+
+
+  /**
+   * \brief Starts a sweep on channel `index` and arms the operation
+   * complete event
+   *
+   * The sweep timing is queried (or taken from the cache) before the
+   * sweep is started. Use `waitForSweep` to wait for completion.
+   *
+   * \param[in] index channel index
+   */
+  bool startSweep(unsigned int index);
+
+
+  /**
+   * \brief Waits for the sweep started with `startSweep`
+   *
+   * Sleeps until 95% of the predicted sweep duration has elapsed, then
+   * waits for the operation complete event (see
+   * `Instrument::waitForOperationComplete`). The timeout is derived from
+   * the predicted duration.
+   *
+   * \param[in] index channel index
+   * \return `false` if no sweep was started, or on timeout
+   */
+  bool waitForSweep(unsigned int index);
+
+
+  /**
+   * \brief Gets the cached sweep timing of channel `index`, if any
+   *
+   * See `Channel::sweepTiming`
+   *
+   * \param[in]  index  channel index
+   * \param[out] timing cached sweep timing
+   * \return `true` if cached
+   */
+  bool cachedSweepTiming(unsigned int index, SweepTiming* timing) const;
+
+
+  /**
+   * \brief Caches the sweep timing of channel `index`
+   *
+   * \param[in] index  channel index
+   * \param[in] timing sweep timing
+   */
+  void cacheSweepTiming(unsigned int index, const SweepTiming& timing);
+
+
+  /**
+   * \brief Clears the cached sweep timing of channel `index`
+   *
+   * \param[in] index channel index
+   */
+  void clearSweepTimingCache(unsigned int index);
+
+
+  /**
+   * \brief Clears the cached sweep timing of all channels
+   */
+  void clearSweepTimingCache();
+
+
+private:
+
+  std::map<unsigned int, SweepTiming>                           _sweepTimings;
+  std::map<unsigned int, std::chrono::steady_clock::time_point> _sweepStarts;
+
+
 };
 
 
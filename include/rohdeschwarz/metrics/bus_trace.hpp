@@ -0,0 +1,182 @@
+/**
+ * \file bus_trace.hpp
+ * \brief rohdeschwarz::metrics::BusTrace definition
+ */
+
+
+#ifndef ROHDESCHWARZ_METRICS_BUS_TRACE_HPP
+#define ROHDESCHWARZ_METRICS_BUS_TRACE_HPP
+
+
+// std lib
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace rohdeschwarz::metrics
+{
+
+
+/**
+ * \brief One bus operation, as recorded by `BusTrace`
+ */
+struct BusEvent
+{
+  enum class Type : std::uint8_t
+  {
+    Write,
+    Read,           ///< one chunk of a response
+    BlockHeader,    ///< `size_B` is the payload size
+    BlockComplete,  ///< from the first read to the complete payload
+    Timeout         ///< failed write or read
+  };
+
+  static constexpr std::size_t MESSAGE_SIZE = 32;
+
+  Type          type;
+  std::uint32_t thread;       ///< see `BusTrace::threadId`
+  std::uint32_t source;       ///< see `BusTrace::source`
+  std::uint64_t start_ns;     ///< since construction of `BusTrace`
+  std::uint64_t duration_ns;
+  std::uint64_t size_B;
+  char          message[MESSAGE_SIZE];  ///< start of a written message; null-terminated
+};
+
+
+/**
+ * \brief Records bus operations of instruments on a timeline
+ *
+ * Every write, read chunk, block header, completed block and timeout of
+ * the instruments that use the trace is recorded with the calling thread
+ * and a timestamp into a fixed-size ring of binary events; when the ring
+ * is full, the oldest events are overwritten:
+ *
+ * ```c++
+ * BusTrace trace;
+ * vna.setBusTrace(&trace);
+ * BusTrace::setThreadName("sequencer");
+ * ...
+ * std::ofstream file("bus.json");
+ * trace.writeChromeTrace(file);
+ * ```
+ *
+ * The Chrome trace-event JSON opens in `chrome://tracing` and in the
+ * Perfetto UI, with one track per thread, so that instrument traffic lines
+ * up with the threads of the application that caused it.
+ *
+ * `BusTrace` may be shared by instruments and threads. It must outlive
+ * the instruments that use it.
+ */
+class BusTrace
+{
+
+public:
+
+  // types
+  using clock_type = std::chrono::steady_clock;
+
+
+  // constants
+  static constexpr std::size_t   DEFAULT_CAPACITY = 64 * 1024;
+  static constexpr std::uint32_t NO_SOURCE        = 0xFFFFFFFF;
+
+
+  // life cycle
+
+  BusTrace(std::size_t capacity = DEFAULT_CAPACITY);
+
+
+  BusTrace(const BusTrace&)            = delete;
+  BusTrace& operator=(const BusTrace&) = delete;
+
+
+  // threads
+
+  /**
+   * \brief Small, process-wide id of the calling thread
+   */
+  static std::uint32_t threadId();
+
+
+  /**
+   * \brief Names the calling thread in all traces
+   */
+  static void setThreadName(const std::string& name);
+
+
+  // record
+
+  /**
+   * \brief Id of source `connection`, e.g. a bus endpoint
+   */
+  std::uint32_t source(const std::string& connection);
+
+
+  void record(BusEvent::Type type, std::uint32_t source,
+              clock_type::time_point start, clock_type::time_point end,
+              std::uint64_t size_B);
+
+
+  /**
+   * \brief Records a write, with the start of `data` as message
+   */
+  void recordWrite(std::uint32_t source,
+                   clock_type::time_point start, clock_type::time_point end,
+                   const unsigned char* data, std::size_t size);
+
+
+  // dump
+
+  std::size_t capacity() const;
+
+
+  /**
+   * \brief Number of events overwritten since construction or `clear`
+   */
+  std::uint64_t dropped() const;
+
+
+  /**
+   * \brief Recorded events, oldest first
+   */
+  std::vector<BusEvent> events() const;
+
+
+  /**
+   * \brief Writes events as Chrome trace-event JSON
+   */
+  void writeChromeTrace(std::ostream& stream) const;
+
+
+  std::string chromeTrace() const;
+
+
+  void clear();
+
+
+private:
+
+  const clock_type::time_point _start;
+
+  mutable std::mutex       _mutex;
+  std::vector<BusEvent>    _events;
+  std::uint64_t            _next;
+  std::vector<std::string> _sources;
+
+
+  std::uint64_t since(clock_type::time_point time) const;
+
+
+  void push(const BusEvent& event);
+
+
+};  // BusTrace
+
+
+}       // rohdeschwarz::metrics
+#endif  // ROHDESCHWARZ_METRICS_BUS_TRACE_HPP
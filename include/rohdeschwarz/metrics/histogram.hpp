@@ -0,0 +1,135 @@
+/**
+ * \file histogram.hpp
+ * \brief rohdeschwarz::metrics::Histogram definition
+ */
+
+
+#ifndef ROHDESCHWARZ_METRICS_HISTOGRAM_HPP
+#define ROHDESCHWARZ_METRICS_HISTOGRAM_HPP
+
+
+// std lib
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace rohdeschwarz::metrics
+{
+
+
+/**
+ * \brief Log-linear latency histogram (HDR style)
+ *
+ * Values are integers, e.g. microseconds. Each power of two is divided
+ * into 8 linear sub-buckets, so every value is recorded with a relative
+ * error of at most 12.5%, from `0` to 2^40, in a fixed array of
+ * `BUCKETS` counters. Histograms of the same layout are merged by adding
+ * their counters.
+ *
+ * ```c++
+ * Histogram latency_us;
+ * latency_us.record(elapsed_us);
+ * latency_us.percentile(0.99);
+ * ```
+ */
+class Histogram
+{
+
+public:
+
+  // layout
+
+  static constexpr unsigned    SUB_BUCKET_BITS = 3;
+  static constexpr std::size_t SUB_BUCKETS     = std::size_t(1) << SUB_BUCKET_BITS;
+  static constexpr unsigned    MAX_VALUE_BITS  = 40;
+  static constexpr std::size_t BUCKETS         = SUB_BUCKETS * (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1);
+
+
+  /**
+   * \brief Index of the bucket of `value`
+   *
+   * Values of 2^40 and more are recorded in the last bucket.
+   */
+  static std::size_t bucketIndex(std::uint64_t value);
+
+
+  /**
+   * \brief Smallest value of bucket `index`
+   */
+  static std::uint64_t bucketLowerBound(std::size_t index);
+
+
+  /**
+   * \brief Smallest value of the next bucket
+   */
+  static std::uint64_t bucketUpperBound(std::size_t index);
+
+
+  // life cycle
+
+  Histogram();
+
+
+  // record
+
+  void record(std::uint64_t value);
+
+
+  /**
+   * \brief Adds `count` values to bucket `index`; e.g. to merge histograms
+   */
+  void add(std::size_t index, std::uint64_t count, std::uint64_t sum);
+
+
+  void merge(const Histogram& other);
+
+
+  // statistics
+
+  std::uint64_t count() const;
+
+
+  std::uint64_t sum() const;
+
+
+  double mean() const;
+
+
+  /**
+   * \brief Largest recorded value, to bucket precision
+   */
+  std::uint64_t max() const;
+
+
+  /**
+   * \brief Value at percentile `p`, from `0` to `1`, to bucket precision
+   *
+   * \returns the upper bound of the bucket of the percentile; `0` if empty
+   */
+  std::uint64_t percentile(double p) const;
+
+
+  /**
+   * \brief Number of values less than `value`, to bucket precision
+   *
+   * Counts the buckets with an upper bound of at most `value`.
+   */
+  std::uint64_t countBelow(std::uint64_t value) const;
+
+
+  std::uint64_t bucket(std::size_t index) const;
+
+
+private:
+
+  std::array<std::uint64_t, BUCKETS> _buckets;
+  std::uint64_t                      _count;
+  std::uint64_t                      _sum;
+
+
+};  // Histogram
+
+
+}       // rohdeschwarz::metrics
+#endif  // ROHDESCHWARZ_METRICS_HISTOGRAM_HPP
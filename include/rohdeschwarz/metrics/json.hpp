@@ -0,0 +1,28 @@
+/**
+ * \file json.hpp
+ * \brief rohdeschwarz::metrics JSON helper definitions
+ */
+
+
+#ifndef ROHDESCHWARZ_METRICS_JSON_HPP
+#define ROHDESCHWARZ_METRICS_JSON_HPP
+
+
+// std lib
+#include <string>
+
+
+namespace rohdeschwarz::metrics
+{
+
+
+/**
+ * \brief Quotes and escapes a JSON string
+ *
+ * Control characters are escaped as `\uXXXX`.
+ */
+std::string json_string(const std::string& value);
+
+
+}       // namespace rohdeschwarz::metrics
+#endif  // ROHDESCHWARZ_METRICS_JSON_HPP
@@ -0,0 +1,197 @@
+/**
+ * \file metrics.hpp
+ * \brief rohdeschwarz::metrics::Metrics definition
+ */
+
+
+#ifndef ROHDESCHWARZ_METRICS_METRICS_HPP
+#define ROHDESCHWARZ_METRICS_METRICS_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/metrics/histogram.hpp"
+
+
+// std lib
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace rohdeschwarz::metrics
+{
+
+
+/**
+ * \brief Traffic of one SCPI header on one connection
+ */
+struct HeaderMetrics
+{
+  std::string   connection;  ///< bus endpoint, e.g. `192.168.35.1:5025`
+  std::string   header;      ///< normalized header of the program message
+  std::uint64_t commands = 0;  ///< program messages without queries
+  std::uint64_t queries  = 0;  ///< program messages with queries
+  std::uint64_t bytesOut = 0;
+  std::uint64_t bytesIn  = 0;
+  std::uint64_t timeouts = 0;  ///< failed writes and reads
+  Histogram     write_us;      ///< duration of the write
+  Histogram     firstByte_us;  ///< end of the write to first response data
+  Histogram     reply_us;      ///< end of the write to complete response
+};
+
+
+/**
+ * \brief Aggregated metrics, sorted by connection and header
+ */
+class Snapshot
+{
+
+public:
+
+  std::vector<HeaderMetrics> headers;
+
+
+  /**
+   * \brief Totals per connection; `header` is empty
+   */
+  std::vector<HeaderMetrics> connections() const;
+
+
+  // export
+
+  /**
+   * \brief Prometheus text exposition format
+   *
+   * Counters `rohdeschwarz_<name>_total` and histograms
+   * `rohdeschwarz_<name>_seconds`, labelled with `connection` and `header`.
+   */
+  std::string prometheus() const;
+
+
+  /**
+   * \brief JSON; latencies in microseconds
+   */
+  std::string json() const;
+
+
+};  // Snapshot
+
+
+/**
+ * \brief Per-connection, per-header metrics of instrument traffic
+ *
+ * Collects command, query, byte and timeout counters and latency
+ * histograms of each SCPI header, from any number of instruments:
+ *
+ * ```c++
+ * Metrics metrics;
+ * vna.setMetrics(&metrics);
+ * ...
+ * std::cout << metrics.snapshot().prometheus();
+ * ```
+ *
+ * Each thread records into its own shard of counters, without locks or
+ * shared cache lines; `snapshot` aggregates all shards. Take snapshots
+ * periodically, e.g. when scraped.
+ *
+ * Headers are normalized: upper case, without leading colon and numeric
+ * suffixes, so that `:calc2:data:trac? 'Trc1', sdat` is counted as
+ * `CALC:DATA:TRAC?`. Compound messages are counted by their first header.
+ *
+ * `Metrics` must outlive the instruments that use it.
+ */
+class Metrics
+{
+
+public:
+
+  /**
+   * \brief Counters of one header on one connection, in one thread
+   *
+   * Written by the owning thread only, and read by `snapshot`.
+   */
+  struct Counters
+  {
+    std::atomic<std::uint64_t> commands{0};
+    std::atomic<std::uint64_t> queries{0};
+    std::atomic<std::uint64_t> bytesOut{0};
+    std::atomic<std::uint64_t> bytesIn{0};
+    std::atomic<std::uint64_t> timeouts{0};
+
+    /**
+     * \brief Histogram buckets, counts and sums
+     */
+    struct Latency
+    {
+      std::array<std::atomic<std::uint64_t>, Histogram::BUCKETS> buckets{};
+      std::atomic<std::uint64_t>                                 count{0};
+      std::atomic<std::uint64_t>                                 sum{0};
+
+      void record(std::uint64_t value_us);
+    };
+
+    Latency write_us;
+    Latency firstByte_us;
+    Latency reply_us;
+
+    /**
+     * \brief Increments a counter of the owning thread
+     */
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t value);
+  };
+
+
+  // life cycle
+
+  Metrics();
+
+
+  ~Metrics();
+
+
+  Metrics(const Metrics&)            = delete;
+  Metrics& operator=(const Metrics&) = delete;
+
+
+  // record
+
+  /**
+   * \brief Counters of `connection`, `header` for the calling thread
+   *
+   * \returns counters; valid for the lifetime of `Metrics`
+   */
+  Counters* counters(const std::string& connection, const std::string& header);
+
+
+  // aggregate
+
+  Snapshot snapshot() const;
+
+
+private:
+
+  struct Shard;
+
+
+  const std::uint64_t _id;
+
+  mutable std::mutex                  _mutex;
+  std::vector<std::shared_ptr<Shard>> _shards;
+
+
+  /**
+   * \brief Shard of the calling thread
+   */
+  Shard* shard();
+
+
+};  // Metrics
+
+
+}       // rohdeschwarz::metrics
+#endif  // ROHDESCHWARZ_METRICS_METRICS_HPP
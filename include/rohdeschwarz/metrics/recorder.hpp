@@ -0,0 +1,123 @@
+/**
+ * \file recorder.hpp
+ * \brief rohdeschwarz::metrics::Recorder definition
+ */
+
+
+#ifndef ROHDESCHWARZ_METRICS_RECORDER_HPP
+#define ROHDESCHWARZ_METRICS_RECORDER_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/metrics/metrics.hpp"
+
+
+// std lib
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+
+namespace rohdeschwarz::metrics
+{
+
+
+/**
+ * \brief Records the traffic of one instrument into `Metrics`
+ *
+ * Used by `Instrument`; see `Instrument::setMetrics`. Attributes each read
+ * to the header of the preceding write, and measures the time to first
+ * byte and to the last read of the reply. A reply is complete at the next
+ * write, or when `finish` is called.
+ */
+class Recorder
+{
+
+public:
+
+  // types
+  using clock_type = std::chrono::steady_clock;
+
+
+  // life cycle
+
+  Recorder(Metrics* metrics);
+
+
+  ~Recorder();
+
+
+  Recorder(const Recorder&)            = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+
+  // connection
+
+  const std::string& connection() const;
+
+
+  void setConnection(std::string connection);
+
+
+  // record
+
+  /**
+   * \brief Records a write that started at `start`
+   *
+   * \param[in] data   program message
+   * \param[in] size   size of `data`
+   * \param[in] start  start of the write
+   * \param[in] isOk   `false` if the write failed
+   */
+  void recordWrite(const unsigned char* data, std::size_t size, clock_type::time_point start, bool isOk);
+
+
+  /**
+   * \brief Records a read of `size` bytes
+   */
+  void recordRead(std::size_t size, bool isOk);
+
+
+  /**
+   * \brief Records the reply of the last query, if any
+   */
+  void finish();
+
+
+  // helpers
+
+  /**
+   * \brief Normalized header of program message `data`
+   *
+   * Upper case, without leading colon and numeric suffixes;
+   * e.g. `CALC:DATA:TRAC?` for `:calc2:data:trac? 'Trc1', sdat`.
+   */
+  static std::string header(const unsigned char* data, std::size_t size);
+
+
+private:
+
+  Metrics*    _metrics;
+  std::string _connection;
+
+  // counters of the last header
+  std::string        _header;
+  std::thread::id    _thread;
+  Metrics::Counters* _counters;
+
+  // reply of the last query
+  bool                   _isReplyPending;
+  bool                   _isFirstByteRead;
+  clock_type::time_point _written;
+  clock_type::time_point _lastRead;
+
+
+  Metrics::Counters* counters(const std::string& header);
+
+
+};  // Recorder
+
+
+}       // rohdeschwarz::metrics
+#endif  // ROHDESCHWARZ_METRICS_RECORDER_HPP
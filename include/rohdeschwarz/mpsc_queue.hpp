@@ -0,0 +1,153 @@
+/**
+ * \file mpsc_queue.hpp
+ * \brief rohdeschwarz::MpscQueue definition and implementation
+ */
+
+
+#ifndef ROHDESCHWARZ_MPSC_QUEUE_HPP
+#define ROHDESCHWARZ_MPSC_QUEUE_HPP
+
+
+// std lib
+#include <atomic>
+#include <utility>
+
+
+namespace rohdeschwarz
+{
+
+
+/**
+ * \brief Lock-free, unbounded multi-producer, single-consumer queue
+ *
+ * A linked queue of nodes (Vyukov): producers append with a single atomic
+ * exchange and never wait for each other or for the consumer. One node is
+ * allocated per `push`.
+ *
+ * ```c++
+ * // any thread
+ * queue.push(value);
+ *
+ * // consumer thread
+ * T value;
+ * while (queue.tryPop(&value))
+ * {
+ *   process(value);
+ * }
+ * ```
+ *
+ * Any number of threads may push; exactly one thread may pop.
+ * `T` must be default-constructible.
+ */
+template <class T>
+class MpscQueue
+{
+
+public:
+
+  MpscQueue() :
+    _head(new Node()),
+    _tail(_head.load())
+  {
+    // no operations
+  }
+
+
+  ~MpscQueue()
+  {
+    while (_tail != nullptr)
+    {
+      Node* next = _tail->next.load();
+      delete _tail;
+      _tail = next;
+    }
+  }
+
+
+  MpscQueue(const MpscQueue&)            = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+
+  // producers
+
+  /**
+   * \brief Appends `value`
+   */
+  void push(T value)
+  {
+    Node* node = new Node();
+    node->value = std::move(value);
+
+    // note: sequentially consistent, so that a consumer
+    // that checks `isEmpty` before sleeping sees the node,
+    // or the producer sees the consumer sleeping
+    Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_seq_cst);
+  }
+
+
+  // consumer
+
+  /**
+   * \brief Checks for an empty queue
+   *
+   * A `push` in progress may not be visible yet.
+   */
+  bool isEmpty() const
+  {
+    return _tail->next.load(std::memory_order_seq_cst) == nullptr;
+  }
+
+
+  /**
+   * \brief Removes the oldest value, if any
+   *
+   * \param[out] value oldest value
+   * \returns `true` if a value was removed; `false` if empty
+   */
+  bool tryPop(T* value)
+  {
+    Node* next = _tail->next.load(std::memory_order_acquire);
+    if (next == nullptr)
+    {
+      // empty
+      return false;
+    }
+    *value = std::move(next->value);
+    delete _tail;
+    _tail = next;
+    return true;
+  }
+
+
+  /**
+   * \brief Gets the oldest value without removing it
+   *
+   * \returns oldest value; `nullptr` if empty
+   */
+  T* front()
+  {
+    Node* next = _tail->next.load(std::memory_order_acquire);
+    return next == nullptr? nullptr : &next->value;
+  }
+
+
+private:
+
+  struct Node
+  {
+    std::atomic<Node*> next{nullptr};
+    T                  value;
+  };
+
+
+  // note: producers and consumer on separate cache lines
+  alignas(64) std::atomic<Node*> _head;
+  alignas(64) Node*              _tail;
+
+
+};  // MpscQueue
+
+
+}       // rohdeschwarz
+#endif  // ROHDESCHWARZ_MPSC_QUEUE_HPP
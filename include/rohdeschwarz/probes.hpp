@@ -0,0 +1,55 @@
+/**
+ * \file probes.hpp
+ * \brief Static tracepoints (USDT) in the bus hot path
+ *
+ * With CMake option `ROHDESCHWARZ_ENABLE_PROBES`, each `ROHDESCHWARZ_PROBE`
+ * is a SystemTap-compatible static tracepoint of provider `rohdeschwarz`:
+ * a single `nop` until a tracer attaches, e.g.
+ *
+ * ```shell
+ * bpftrace -e 'usdt:./librohdeschwarz.so:rohdeschwarz:socket__read__done { @bytes = hist(arg1); }'
+ * ```
+ *
+ * Otherwise probes compile to nothing, and their arguments are not evaluated.
+ *
+ * Probes:
+ *
+ * | probe                                 | arguments                       |
+ * |---------------------------------------|---------------------------------|
+ * | `socket__read__start`                 | socket, buffer size             |
+ * | `socket__read__done`                  | socket, bytes read, success     |
+ * | `socket__write__start`                | socket, size                    |
+ * | `socket__write__done`                 | socket, bytes written, success  |
+ * | `visa__read__start`                   | visa, buffer size               |
+ * | `visa__read__done`                    | visa, bytes read, success       |
+ * | `visa__write__start`                  | visa, size                      |
+ * | `visa__write__done`                   | visa, bytes written, success    |
+ * | `block__push`                         | block, size, bytes in block     |
+ * | `instrument__query__start`            | instrument, command (format)    |
+ * | `instrument__query__done`             | instrument, response size       |
+ */
+
+
+#ifndef ROHDESCHWARZ_PROBES_HPP
+#define ROHDESCHWARZ_PROBES_HPP
+
+
+#ifdef ROHDESCHWARZ_ENABLE_PROBES
+
+// systemtap
+#include <sys/sdt.h>
+
+#define ROHDESCHWARZ_PROBE1(name, a1)             DTRACE_PROBE1(rohdeschwarz, name, a1)
+#define ROHDESCHWARZ_PROBE2(name, a1, a2)         DTRACE_PROBE2(rohdeschwarz, name, a1, a2)
+#define ROHDESCHWARZ_PROBE3(name, a1, a2, a3)     DTRACE_PROBE3(rohdeschwarz, name, a1, a2, a3)
+
+#else
+
+#define ROHDESCHWARZ_PROBE1(name, a1)             ((void)0)
+#define ROHDESCHWARZ_PROBE2(name, a1, a2)         ((void)0)
+#define ROHDESCHWARZ_PROBE3(name, a1, a2, a3)     ((void)0)
+
+#endif  // ROHDESCHWARZ_ENABLE_PROBES
+
+
+#endif  // ROHDESCHWARZ_PROBES_HPP
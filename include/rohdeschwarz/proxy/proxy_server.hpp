@@ -0,0 +1,300 @@
+/**
+ * \file proxy_server.hpp
+ * \brief rohdeschwarz::proxy::ProxyServer definition
+ *
+ * Available on POSIX systems only.
+ */
+
+
+#ifndef ROHDESCHWARZ_PROXY_PROXY_SERVER_HPP
+#define ROHDESCHWARZ_PROXY_PROXY_SERVER_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/shared_sweep_ring.hpp"
+#include "rohdeschwarz/instruments/vna/vna.hpp"
+
+
+// boost
+#include <boost/asio.hpp>
+
+
+// std lib
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace rohdeschwarz::proxy
+{
+
+
+/**
+ * \brief Shares one instrument connection with many local clients
+ *
+ * `ProxyServer` accepts clients on a Unix-domain socket and forwards their
+ * SCPI program messages, one at a time, to a single `Vna` session. Clients
+ * speak the same protocol as the instrument raw socket port; connect with
+ * `Instrument::openLocal`:
+ *
+ * ```c++
+ * // daemon
+ * Vna vna;
+ * vna.openTcp("192.168.35.1");
+ * ProxyServer proxy(&vna, "/tmp/znb.sock");
+ * proxy.start();
+ *
+ * // clients, in any number of processes
+ * Vna client;
+ * client.openLocal("/tmp/znb.sock");
+ * client.id();
+ * ```
+ *
+ * Messages from each client are executed in order. In addition:
+ *
+ * -   `*IDN?` and `*OPT?` are answered from a cache after the first query
+ * -   identical read-only queries that are waiting, or that arrive while
+ *     the same query is in flight, share a single instrument round trip.
+ *     A query is read-only if every message unit is a query, other than
+ *     destructive reads of event registers (`*ESR?`, `STAT:...:EVEN?`)
+ *     and the error queue (`SYST:ERR?`), and `*OPC?`.
+ *
+ * Bulk trace data is handed over in shared memory. The proxy query
+ * `PROX:TRAC:DATA? <channel>` reads all traces of `channel` with
+ * `Vna::allTraceData` and publishes them to a `SharedSweepRingWriter` ring.
+ * The response is the ring name and the sweep number, e.g.
+ * `'/rohdeschwarz-proxy-1234-ch1',7`; open the ring with
+ * `SharedSweepRingReader`. The ring is recreated, and sweep numbers
+ * restart, when the shape of the channel changes. The response is empty
+ * on error.
+ *
+ * If a forwarded query fails, e.g. on timeout or malformed block data,
+ * pending instrument responses are discarded with `Vna::clear` and the
+ * response is empty, so that a late reply is not taken as the answer to
+ * the next query.
+ *
+ * While running, the proxy owns the `Vna` connection; do not use `vna`
+ * from other threads.
+ */
+class ProxyServer
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] vna       pointer to an open `Vna`
+   * \param[in] path      Unix-domain socket path
+   * \param[in] shmPrefix shared-memory name prefix for trace data rings;
+   *   defaults to `/rohdeschwarz-proxy-<pid>`
+   */
+  ProxyServer(instruments::vna::Vna* vna, std::string path, std::string shmPrefix = std::string());
+
+
+  /**
+   * \brief Destructor; stops the proxy
+   */
+  ~ProxyServer();
+
+
+  ProxyServer(const ProxyServer&)            = delete;
+  ProxyServer& operator=(const ProxyServer&) = delete;
+
+
+  // control
+
+  /**
+   * \brief Listens on `path` and starts the I/O and instrument threads
+   *
+   * A stale socket file at `path` is removed. Fails if `path` exists and
+   * is not a socket.
+   *
+   * \returns `true` on success; `false` otherwise
+   */
+  bool start();
+
+
+  /**
+   * \brief Disconnects all clients, stops and removes the socket file
+   */
+  void stop();
+
+
+  bool isRunning() const;
+
+
+  std::string path() const;
+
+
+  // statistics
+
+  /**
+   * \brief Number of connected clients
+   */
+  std::size_t clients() const;
+
+
+  /**
+   * \brief Number of program messages received from clients
+   */
+  std::size_t requests() const;
+
+
+  /**
+   * \brief Number of program messages sent to the instrument
+   */
+  std::size_t forwarded() const;
+
+
+  /**
+   * \brief Number of queries answered by another client's round trip
+   */
+  std::size_t coalesced() const;
+
+
+  /**
+   * \brief Number of queries answered from the cache
+   */
+  std::size_t cached() const;
+
+
+private:
+
+  struct Client;
+
+
+  /**
+   * \brief Program message from a client
+   */
+  struct Request
+  {
+    std::shared_ptr<Client> client;
+    std::string             message;
+    std::string             key;
+    bool                    isQuery;
+    bool                    isReadOnly;
+  };
+
+
+  /**
+   * \brief Trace data ring of a channel
+   */
+  struct Ring
+  {
+    instruments::vna::SharedSweepRingWriter writer;
+    std::vector<std::string>                names;
+    std::size_t                             points;
+  };
+
+
+  instruments::vna::Vna* _vna;
+  std::string            _path;
+  std::string            _shmPrefix;
+
+
+  // clients
+  boost::asio::io_context                        _io_context;
+  boost::asio::local::stream_protocol::acceptor  _acceptor;
+  std::set<std::shared_ptr<Client>>              _connected;
+  std::thread                                    _ioThread;
+
+
+  // requests
+  std::mutex               _mutex;
+  std::condition_variable  _condition;
+  std::deque<Request>      _requests;
+  std::thread              _worker;
+  std::atomic<bool>        _isRunning;
+
+
+  // worker state
+  std::map<std::string, std::string>           _cache;
+  std::map<unsigned int, std::unique_ptr<Ring>> _rings;
+
+
+  // statistics
+  std::atomic<std::size_t> _clients;
+  std::atomic<std::size_t> _received;
+  std::atomic<std::size_t> _forwarded;
+  std::atomic<std::size_t> _coalesced;
+  std::atomic<std::size_t> _cached;
+
+
+  // helpers
+
+  /**
+   * \brief I/O thread: accepts the next client
+   */
+  void accept();
+
+
+  /**
+   * \brief I/O thread: reads program messages from `client`
+   */
+  void read(std::shared_ptr<Client> client);
+
+
+  /**
+   * \brief Queues `response` for `client`; any thread
+   */
+  void send(std::shared_ptr<Client> client, std::string response);
+
+
+  /**
+   * \brief I/O thread: writes queued responses to `client`
+   */
+  void write(std::shared_ptr<Client> client);
+
+
+  /**
+   * \brief Instrument thread: executes requests in order
+   */
+  void run();
+
+
+  /**
+   * \brief Takes queued queries identical to `request` that can be
+   * answered together with it
+   */
+  void coalesce(const Request& request, std::vector<Request>* requests);
+
+
+  /**
+   * \brief Executes `request` on the instrument
+   *
+   * \param[out] response response message, with terminator
+   * \returns `true` if `response` should be sent; `false` otherwise
+   */
+  bool execute(const Request& request, std::string* response);
+
+
+  /**
+   * \brief Reads a complete response message from the instrument
+   *
+   * \returns `true` on success; `false` on error or malformed block data
+   */
+  bool readResponse(std::string* response);
+
+
+  /**
+   * \brief Reads and publishes all trace data of `channel`
+   */
+  bool publishTraceData(unsigned int channel, std::string* response);
+
+
+};  // ProxyServer
+
+
+}       // rohdeschwarz::proxy
+#endif  // ROHDESCHWARZ_PROXY_PROXY_SERVER_HPP
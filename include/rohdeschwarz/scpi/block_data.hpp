@@ -67,12 +67,35 @@ public:
   bool isComplete() const;
 
 
+  /**
+   * \brief Parses a Block Data header from raw data
+   *
+   * Indefinite-length blocks (`#0`) are not supported.
+   *
+   * \param[in]  data          raw data, starting with the header
+   * \param[in]  size          size of `data`, in bytes
+   * \param[out] headerSize_B  header size, in bytes
+   * \param[out] payloadSize_B payload size, in bytes
+   * \param[out] isError       `true` if `data` cannot start with a valid header
+   * \returns `true` if the header is complete and valid; `false` otherwise
+   */
+  static bool parseHeader(const unsigned char* data, std::size_t size,
+                          std::size_t* headerSize_B, std::size_t* payloadSize_B,
+                          bool* isError);
+
+
   // push back
 
   /**
    * \brief Copies data to block
+   *
+   * Only the bytes belonging to the block are copied. Any bytes
+   * after the end of the block (e.g. the next response of a
+   * compound query) are left to the caller.
+   *
+   * \returns number of bytes consumed from `begin`
    */
-  void push_back(std::vector<unsigned char>::const_iterator begin, std::size_t size);
+  std::size_t push_back(std::vector<unsigned char>::const_iterator begin, std::size_t size);
 
 
   // payload data
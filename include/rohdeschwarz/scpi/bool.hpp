@@ -10,6 +10,7 @@
 
 // std lib
 #include <string>
+#include <string_view>
 
 
 namespace rohdeschwarz::scpi
@@ -29,7 +30,7 @@ std::string toScpi(bool value);
  *
  * \returns `true` if `scpi` is `"1"`; `false` otherwise
  */
-bool toBool(std::string scpi);
+bool toBool(std::string_view scpi);
 
 
 }       // namespace rohdeschwarz::scpi
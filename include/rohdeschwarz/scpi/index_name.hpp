@@ -10,6 +10,7 @@
 
 // std lib
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -52,6 +53,37 @@ struct IndexName
   static std::vector<IndexName> parse(const std::string& csvList);
 
 
+  /**
+   * \brief Parses index-name pairs from text
+   *
+   * Allocates only the output list (and names too long for the
+   * small string optimization).
+   *
+   * \param[in] csvList CSV list of index-name pairs as a string view
+   */
+  static std::vector<IndexName> parse(std::string_view csvList);
+
+
+  /**
+   * \brief Parses only the indexes of index-name pairs from text
+   *
+   * Equivalent to `indexesFrom(parse(csvList))`, without intermediate copies.
+   *
+   * \param[in] csvList CSV list of index-name pairs as a string view
+   */
+  static std::vector<unsigned int> parseIndexes(std::string_view csvList);
+
+
+  /**
+   * \brief Parses only the names of index-name pairs from text
+   *
+   * Equivalent to `namesFrom(parse(csvList))`, without intermediate copies.
+   *
+   * \param[in] csvList CSV list of index-name pairs as a string view
+   */
+  static std::vector<std::string> parseNames(std::string_view csvList);
+
+
   /**
    * \brief Returns index list from IndexName list
    */
@@ -0,0 +1,116 @@
+/**
+ * \file message_scanner.hpp
+ * \brief rohdeschwarz::scpi::MessageScanner definition
+ */
+
+
+#ifndef ROHDESCHWARZ_SCPI_MESSAGE_SCANNER_HPP
+#define ROHDESCHWARZ_SCPI_MESSAGE_SCANNER_HPP
+
+
+// std lib
+#include <cstddef>
+
+
+namespace rohdeschwarz::scpi
+{
+
+
+/**
+ * \brief Incremental framing of SCPI program and response messages
+ *
+ * `MessageScanner` finds the message terminator (`\n`) in a byte stream
+ * that arrives in chunks. Terminators inside quoted strings and IEEE 488.2
+ * block data (`#<n><length><payload>`) do not end the message; block
+ * payloads are skipped without inspecting each byte. An indefinite-length
+ * block (`#0`) ends with the message terminator.
+ *
+ * ```c++
+ * MessageScanner scanner;
+ * std::size_t size;
+ * if (scanner.scan(data, data_size, &size))
+ * {
+ *   // message is data[0, size), including the terminator
+ *   scanner.reset();
+ * }
+ * ```
+ */
+class MessageScanner
+{
+
+public:
+
+  // life cycle
+
+  MessageScanner();
+
+
+  /**
+   * \brief Resets the scanner for the next message
+   */
+  void reset();
+
+
+  // scan
+
+  /**
+   * \brief Scans the next chunk of a message
+   *
+   * \param[in]  data     next chunk
+   * \param[in]  size     chunk size, in bytes
+   * \param[out] consumed bytes consumed: up to and including the terminator
+   *   if found; `size` otherwise
+   * \returns `true` if the message is complete, or on a framing error
+   *   (see `isError`); `false` otherwise
+   */
+  bool scan(const unsigned char* data, std::size_t size, std::size_t* consumed);
+
+
+  /**
+   * \brief Checks if the message contains a query (`?`) outside of
+   * quotes and block data
+   */
+  bool isQuery() const;
+
+
+  /**
+   * \brief Checks if the message contains block data
+   */
+  bool isBlockData() const;
+
+
+  /**
+   * \brief Checks for a framing error: a non-digit in the length of a
+   * block header
+   *
+   * On a framing error, `scan` returns `true` and consumes data up to the
+   * offending byte. The message is malformed; the stream is not in sync.
+   */
+  bool isError() const;
+
+
+private:
+
+  enum class State
+  {
+    Text,
+    BlockDigits,
+    BlockLength,
+    BlockPayload,
+    IndefiniteBlock,
+    Error
+  };
+
+  State       _state;
+  char        _quote;
+  std::size_t _digits;
+  std::size_t _remaining;
+  bool        _isQuery;
+  bool        _isBlockData;
+
+
+};  // class MessageScanner
+
+
+}       // namespace rohdeschwarz::scpi
+#endif  // ROHDESCHWARZ_SCPI_MESSAGE_SCANNER_HPP
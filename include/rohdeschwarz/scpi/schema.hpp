@@ -0,0 +1,524 @@
+/**
+ * \file schema.hpp
+ * \brief rohdeschwarz::scpi::Schema and response field type definitions
+ */
+
+
+#ifndef ROHDESCHWARZ_SCPI_SCHEMA_HPP
+#define ROHDESCHWARZ_SCPI_SCHEMA_HPP
+
+
+// rohdeschwarz
+#include "rohdeschwarz/scpi/bool.hpp"
+#include "rohdeschwarz/scpi/tokenizer.hpp"
+#include "rohdeschwarz/helpers.hpp"
+#include "rohdeschwarz/to_value.hpp"
+
+
+// std lib
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+
+namespace rohdeschwarz::scpi
+{
+
+
+// field types
+
+/**
+ * \brief Schema field: a quoted string, which may contain separators
+ *
+ * Parses to `std::string`, without quotes.
+ */
+struct Quoted {};
+
+
+/**
+ * \brief Schema field: a list of `ElementType` values
+ *
+ * Consumes all remaining data elements of the current response message unit
+ * (i.e. up to the next `;`). Parses to `std::vector<ElementType>`.
+ */
+template <class ElementType>
+struct List {};
+
+
+/**
+ * \brief Schema field: a character data mnemonic (e.g. `SWAP`, `MLOG`)
+ *
+ * Parses to `Traits::type`, usually an `enum class`, with a `constexpr`
+ * perfect hash table built from `Traits::entries`. See `MnemonicTable`.
+ */
+template <class Traits>
+struct Mnemonic {};
+
+
+/**
+ * \brief Mnemonic table entry
+ */
+template <class Type>
+struct MnemonicEntry
+{
+  std::string_view mnemonic;
+  Type             value;
+};
+
+
+// cursor
+
+/**
+ * \brief Single-pass read position in a SCPI response
+ *
+ * `SchemaCursor` reads data elements separated by `,` (within a response
+ * message unit) or `;` (between response message units). Separators inside
+ * quotes do not split. Elements are returned as views into the response.
+ */
+class SchemaCursor
+{
+
+public:
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] response SCPI response; must outlive the cursor
+   */
+  explicit SchemaCursor(std::string_view response) :
+    _text(trimView(response)),
+    _position(0),
+    _separator(_text.empty()? '\0' : ',')
+  {
+    // no operations
+  }
+
+
+  /**
+   * \brief Checks if the end of the response has been reached
+   */
+  bool isEnd() const
+  {
+    return _separator == '\0';
+  }
+
+
+  /**
+   * \brief Returns the separator that ended the last element
+   *
+   * \returns `,`, `;`, or `\0` at the end of the response
+   */
+  char separator() const
+  {
+    return _separator;
+  }
+
+
+  /**
+   * \brief Reads the next data element
+   *
+   * \exception `std::invalid_argument` if there are no more elements
+   */
+  std::string_view next()
+  {
+    if (isEnd())
+    {
+      throw std::invalid_argument("scpi schema: response has too few fields");
+    }
+
+    // find separator outside of quotes
+    const std::size_t begin = _position;
+    _position = findUnquoted(_text, ",;", _position);
+
+    // element; advance past separator
+    const std::string_view element = _text.substr(begin, _position - begin);
+    _separator = _position < _text.size()? _text[_position] : '\0';
+    _position++;
+    return trimView(element);
+  }
+
+
+  /**
+   * \brief Extends `element` through the next data element
+   *
+   * Used for mnemonics that contain `,` (e.g. `REAL,64`).
+   * Requires `separator()` to be `,`.
+   */
+  std::string_view extend(std::string_view element)
+  {
+    const std::string_view next_element = next();
+    const char* begin = element.data();
+    const char* end   = next_element.data() + next_element.size();
+    return std::string_view(begin, std::size_t(end - begin));
+  }
+
+
+private:
+
+  std::string_view _text;
+  std::size_t      _position;
+  char             _separator;
+
+
+};  // class SchemaCursor
+
+
+// mnemonic table
+
+/**
+ * \brief Compile-time perfect hash table for SCPI mnemonics
+ *
+ * `Traits` must provide:
+ *
+ * - `type`: the decoded value type
+ * - `entries`: a `static constexpr std::array<MnemonicEntry<type>, N>`
+ *
+ * The hash seed is searched at compile time so that every mnemonic occupies
+ * its own bucket; lookup is one hash and one string comparison.
+ */
+template <class Traits>
+class MnemonicTable
+{
+
+public:
+
+  using type = typename Traits::type;
+
+
+  /**
+   * \brief Looks up `mnemonic`
+   *
+   * \param[in]  mnemonic mnemonic to decode
+   * \param[out] value    decoded value
+   * \returns `true` if `mnemonic` is in the table; `false` otherwise
+   */
+  static bool lookup(std::string_view mnemonic, type* value)
+  {
+    const int slot = SLOTS[hash(mnemonic, SEED) & (BUCKETS - 1)];
+    if (slot < 0 || Traits::entries[std::size_t(slot)].mnemonic != mnemonic)
+    {
+      return false;
+    }
+    *value = Traits::entries[std::size_t(slot)].value;
+    return true;
+  }
+
+
+  /**
+   * \brief Largest number of `,` in any mnemonic
+   */
+  static constexpr std::size_t maxSeparators()
+  {
+    std::size_t max = 0;
+    for (const auto& entry : Traits::entries)
+    {
+      std::size_t count = 0;
+      for (const char character : entry.mnemonic)
+      {
+        count += character == ','? 1 : 0;
+      }
+      max = count > max? count : max;
+    }
+    return max;
+  }
+
+
+private:
+
+  static constexpr std::size_t ENTRIES = Traits::entries.size();
+
+
+  /**
+   * \brief Seeded FNV-1a hash
+   */
+  static constexpr std::uint32_t hash(std::string_view text, std::uint32_t seed)
+  {
+    std::uint32_t value = 2166136261u ^ seed;
+    for (const char character : text)
+    {
+      value ^= std::uint8_t(character);
+      value *= 16777619u;
+    }
+    return value ^ (value >> 15);
+  }
+
+
+  /**
+   * \brief Number of buckets: power of two, at least twice the entries
+   */
+  static constexpr std::size_t bucketCount()
+  {
+    std::size_t buckets = 4;
+    while (buckets < 2 * ENTRIES)
+    {
+      buckets *= 2;
+    }
+    return buckets;
+  }
+
+
+  static constexpr std::size_t BUCKETS = bucketCount();
+
+
+  /**
+   * \brief Checks that `seed` maps each entry to its own bucket
+   */
+  static constexpr bool isPerfect(std::uint32_t seed)
+  {
+    std::array<bool, BUCKETS> used {};
+    for (const auto& entry : Traits::entries)
+    {
+      const std::size_t bucket = hash(entry.mnemonic, seed) & (BUCKETS - 1);
+      if (used[bucket])
+      {
+        return false;
+      }
+      used[bucket] = true;
+    }
+    return true;
+  }
+
+
+  /**
+   * \brief Searches for a perfect seed
+   *
+   * \returns seed, or `0` if none was found
+   */
+  static constexpr std::uint32_t findSeed()
+  {
+    for (std::uint32_t seed = 1; seed < 4096; seed++)
+    {
+      if (isPerfect(seed))
+      {
+        return seed;
+      }
+    }
+    return 0;
+  }
+
+
+  static constexpr std::uint32_t SEED = findSeed();
+  static_assert(SEED != 0, "MnemonicTable: no perfect hash seed found");
+
+
+  /**
+   * \brief Builds bucket to entry index table; `-1` for empty buckets
+   */
+  static constexpr std::array<int, BUCKETS> buildSlots()
+  {
+    std::array<int, BUCKETS> slots {};
+    for (std::size_t i = 0; i < BUCKETS; i++)
+    {
+      slots[i] = -1;
+    }
+    for (std::size_t i = 0; i < ENTRIES; i++)
+    {
+      slots[hash(Traits::entries[i].mnemonic, SEED) & (BUCKETS - 1)] = int(i);
+    }
+    return slots;
+  }
+
+
+  static constexpr std::array<int, BUCKETS> SLOTS = buildSlots();
+
+
+};  // class MnemonicTable
+
+
+// field parsers
+
+/**
+ * \brief Parses one schema field of type `FieldType` from a cursor
+ *
+ * Specialized for `int`, `unsigned int`, `double`, `bool`, `std::string`,
+ * `Quoted`, `List<T>` and `Mnemonic<Traits>`.
+ */
+template <class FieldType>
+struct FieldParser;
+
+
+template <>
+struct FieldParser<int>
+{
+  using value_type = int;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    return to_value<int>(cursor.next());
+  }
+};
+
+
+template <>
+struct FieldParser<unsigned int>
+{
+  using value_type = unsigned int;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    return to_value<unsigned int>(cursor.next());
+  }
+};
+
+
+template <>
+struct FieldParser<double>
+{
+  using value_type = double;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    return to_value<double>(cursor.next());
+  }
+};
+
+
+template <>
+struct FieldParser<bool>
+{
+  using value_type = bool;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    return toBool(cursor.next());
+  }
+};
+
+
+template <>
+struct FieldParser<std::string>
+{
+  using value_type = std::string;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    return to_value<std::string>(cursor.next());
+  }
+};
+
+
+template <>
+struct FieldParser<Quoted>
+{
+  using value_type = std::string;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    const std::string_view element = cursor.next();
+    if (unquoteView(element).size() + 2 != element.size())
+    {
+      throw std::invalid_argument("scpi schema: expected quoted string");
+    }
+    return std::string(unquoteView(element));
+  }
+};
+
+
+template <class ElementType>
+struct FieldParser<List<ElementType>>
+{
+  using value_type = std::vector<typename FieldParser<ElementType>::value_type>;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    value_type values;
+    do
+    {
+      values.push_back(FieldParser<ElementType>::parse(cursor));
+    }
+    while (cursor.separator() == ',');
+    return values;
+  }
+};
+
+
+template <class Traits>
+struct FieldParser<Mnemonic<Traits>>
+{
+  using value_type = typename Traits::type;
+  static value_type parse(SchemaCursor& cursor)
+  {
+    using table = MnemonicTable<Traits>;
+    std::string_view element = cursor.next();
+    value_type value {};
+    for (std::size_t extensions = 0; !table::lookup(element, &value); extensions++)
+    {
+      if (extensions == table::maxSeparators() || cursor.separator() != ',')
+      {
+        throw std::invalid_argument("scpi schema: unknown mnemonic");
+      }
+
+      // mnemonic contains a separator (e.g. REAL,64)
+      element = cursor.extend(element);
+    }
+    return value;
+  }
+};
+
+
+// schema
+
+/**
+ * \brief Compile-time SCPI response schema
+ *
+ * `Schema` describes the fields of a SCPI response, in order. It generates
+ * a single-pass parser over the response text, with no intermediate
+ * strings. Fields may be separated by `,` or `;`, so a schema can describe
+ * the response to a compound query.
+ *
+ * For example, `:FORM?;:FORM:BORD?;:SENS1:SWE:POIN?` might be parsed with:
+ *
+ * ```c++
+ * using Format = Schema<Mnemonic<TransferFormats>, Mnemonic<ByteOrders>, unsigned int>;
+ * auto [transfer, byte_order, points] = Format::parse("REAL,64;SWAP;201\n");
+ * ```
+ *
+ * See `rohdeschwarz::instruments::Instrument::queryValues`.
+ */
+template <class... Fields>
+struct Schema
+{
+
+  /**
+   * \brief Parsed response type
+   */
+  using value_type = std::tuple<typename FieldParser<Fields>::value_type...>;
+
+
+  /**
+   * \brief Parses `response`
+   *
+   * \exception `std::invalid_argument` if `response` does not match the schema
+   */
+  static value_type parse(std::string_view response)
+  {
+    SchemaCursor cursor(response);
+
+    // note: braced initializers are evaluated in order
+    return value_type {FieldParser<Fields>::parse(cursor)...};
+  }
+
+
+  /**
+   * \brief Parses `response`
+   *
+   * \param[in]  response SCPI response
+   * \param[out] values   parsed values
+   * \returns `true` on success; `false` if `response` does not match the schema
+   */
+  static bool parse(std::string_view response, value_type* values)
+  {
+    try
+    {
+      *values = parse(response);
+    }
+    catch (const std::invalid_argument&)
+    {
+      return false;
+    }
+    return true;
+  }
+
+};  // struct Schema
+
+
+}       // namespace rohdeschwarz::scpi
+#endif  // ROHDESCHWARZ_SCPI_SCHEMA_HPP
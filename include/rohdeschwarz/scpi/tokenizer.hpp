@@ -0,0 +1,140 @@
+/**
+ * \file tokenizer.hpp
+ * \brief rohdeschwarz::scpi::Tokenizer definition
+ */
+
+
+#ifndef ROHDESCHWARZ_SCPI_TOKENIZER_HPP
+#define ROHDESCHWARZ_SCPI_TOKENIZER_HPP
+
+
+// std lib
+#include <cstddef>
+#include <string_view>
+
+
+namespace rohdeschwarz::scpi
+{
+
+
+/**
+ * \brief Finds the first of `characters` in `text` outside of single or
+ * double quotes
+ *
+ * This is the quote-aware scan shared by all SCPI text parsing. The quote
+ * state is kept in `quote`, so that text arriving in chunks can be scanned
+ * incrementally.
+ *
+ * \param[in]     text       text to scan
+ * \param[in]     characters characters to find, e.g. `",;"`
+ * \param[in]     position   position to start at
+ * \param[in,out] quote      open quote character; `'\0'` outside quotes.
+ *   Optional; if `nullptr`, scanning starts outside quotes.
+ * \returns position of the character found; `text.size()` if not found
+ */
+std::size_t findUnquoted(std::string_view text, std::string_view characters,
+                         std::size_t position = 0, char* quote = nullptr);
+
+
+/**
+ * \brief Lazy, zero-allocation tokenizer for SCPI responses
+ *
+ * `Tokenizer` splits a SCPI response into tokens on a separator
+ * (e.g. `,` for data elements, `;` for response message units).
+ * Separators inside single or double quotes do not split.
+ *
+ * Tokens are returned as `std::string_view`s into the original text,
+ * with surrounding whitespace removed. The text must outlive the tokenizer
+ * and its tokens.
+ *
+ * Example:
+ *
+ * ```c++
+ * Tokenizer tokenizer("1,'Trc1',2,'Trc2'");
+ * std::string_view token;
+ * while (tokenizer.next(&token))
+ * {
+ *   // "1", "'Trc1'", "2", "'Trc2'"
+ * }
+ * ```
+ */
+class Tokenizer
+{
+
+public:
+
+  // life cycle
+
+  /**
+   * \brief Constructor
+   *
+   * An empty (or whitespace-only) `text` contains no tokens.
+   *
+   * \param[in] text      text to tokenize
+   * \param[in] separator character to separate on; defaults to comma `,`
+   */
+  Tokenizer(std::string_view text, char separator = ',');
+
+
+  // tokens
+
+  /**
+   * \brief Checks if all tokens have been read
+   */
+  bool isEnd() const;
+
+
+  /**
+   * \brief Reads the next token
+   *
+   * \param[out] token next token, trimmed of whitespace
+   * \returns `true` if a token was read; `false` if there are no more tokens
+   */
+  bool next(std::string_view* token);
+
+
+  /**
+   * \brief Skips the next token
+   *
+   * \returns `true` if a token was skipped; `false` if there are no more tokens
+   */
+  bool skip();
+
+
+  /**
+   * \brief Returns the text that has not been tokenized yet
+   */
+  std::string_view remainder() const;
+
+
+  /**
+   * \brief Counts the remaining tokens without consuming them
+   */
+  std::size_t count() const;
+
+
+private:
+
+  std::string_view _text;
+  std::size_t      _position;
+  char             _separator;
+  bool             _isEnd;
+  bool             _hasQuotes;
+
+
+  // helpers
+
+  /**
+   * \brief Finds the next separator outside of quotes, starting at `position`
+   *
+   * \returns position of separator; `_text.size()` if not found
+   * \see findUnquoted
+   */
+  std::size_t findSeparator(std::size_t position) const;
+
+
+};  // class Tokenizer
+
+
+}       // namespace rohdeschwarz::scpi
+#endif  // ROHDESCHWARZ_SCPI_TOKENIZER_HPP
@@ -0,0 +1,186 @@
+/**
+ * \file spsc_ring.hpp
+ * \brief rohdeschwarz::SpscRing definition and implementation
+ */
+
+
+#ifndef ROHDESCHWARZ_SPSC_RING_HPP
+#define ROHDESCHWARZ_SPSC_RING_HPP
+
+
+// std lib
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+namespace rohdeschwarz
+{
+
+
+/**
+ * \brief Lock-free single-producer, single-consumer ring of preallocated slots
+ *
+ * Slots are constructed once and reused; nothing is allocated after
+ * construction. The producer fills a slot in place and commits it; the
+ * consumer reads it in place and releases it:
+ *
+ * ```c++
+ * // producer thread
+ * if (T* slot = ring.beginWrite())
+ * {
+ *   fill(slot);
+ *   ring.commitWrite();
+ * }
+ *
+ * // consumer thread
+ * if (const T* slot = ring.beginRead())
+ * {
+ *   process(*slot);
+ *   ring.endRead();
+ * }
+ * ```
+ *
+ * Exactly one thread may write and exactly one thread may read.
+ */
+template <class T>
+class SpscRing
+{
+
+public:
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] capacity number of slots; rounded up to a power of two
+   * \param[in] prototype initial value of each slot
+   */
+  SpscRing(std::size_t capacity, const T& prototype = T()) :
+    _head(0),
+    _tail(0)
+  {
+    std::size_t size = 1;
+    while (size < capacity)
+    {
+      size *= 2;
+    }
+    _mask = size - 1;
+    _slots.assign(size, prototype);
+  }
+
+
+  /**
+   * \brief Number of slots
+   */
+  std::size_t capacity() const
+  {
+    return _slots.size();
+  }
+
+
+  /**
+   * \brief Number of committed, unreleased slots
+   */
+  std::size_t size() const
+  {
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+  }
+
+
+  /**
+   * \brief Access to all slots, e.g. for preallocation before use
+   */
+  std::vector<T>& slots()
+  {
+    return _slots;
+  }
+
+
+  // producer
+
+  /**
+   * \brief Gets the next free slot
+   *
+   * \returns slot to fill; `nullptr` if full
+   */
+  T* beginWrite()
+  {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) == _slots.size())
+    {
+      // full
+      return nullptr;
+    }
+    return &_slots[head & _mask];
+  }
+
+
+  /**
+   * \brief Publishes the slot returned by `beginWrite`
+   */
+  void commitWrite()
+  {
+    _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+
+  // consumer
+
+  /**
+   * \brief Gets the oldest committed slot
+   *
+   * \returns slot to read; `nullptr` if empty
+   */
+  const T* beginRead() const
+  {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    if (_head.load(std::memory_order_acquire) == tail)
+    {
+      // empty
+      return nullptr;
+    }
+    return &_slots[tail & _mask];
+  }
+
+
+  /**
+   * \brief Gets the oldest committed slot, e.g. to move from it
+   *
+   * \returns slot to read; `nullptr` if empty
+   */
+  T* beginRead()
+  {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    if (_head.load(std::memory_order_acquire) == tail)
+    {
+      // empty
+      return nullptr;
+    }
+    return &_slots[tail & _mask];
+  }
+
+
+  /**
+   * \brief Returns the slot returned by `beginRead` to the producer
+   */
+  void endRead()
+  {
+    _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+
+private:
+
+  // note: head and tail on separate cache lines
+  // to avoid false sharing between producer and consumer
+  alignas(64) std::atomic<std::size_t> _head;
+  alignas(64) std::atomic<std::size_t> _tail;
+  alignas(64) std::size_t              _mask;
+  std::vector<T>                       _slots;
+
+
+};  // SpscRing
+
+
+}       // rohdeschwarz
+#endif  // ROHDESCHWARZ_SPSC_RING_HPP
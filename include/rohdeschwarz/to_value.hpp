@@ -1,18 +1,31 @@
+/**
+ * \file to_value.hpp
+ * \brief rohdeschwarz::to_value() definitions
+ */
+
+
 #ifndef ROHDESCHWARZ_TO_VALUE_HPP
 #define ROHDESCHWARZ_TO_VALUE_HPP
 
 
 // std lib
 #include <string>
+#include <string_view>
 
 
 namespace rohdeschwarz
 {
 
 
-// definition
+/**
+ * \brief Converts a SCPI response to a value of type `OutputType`
+ *
+ * Surrounding whitespace is ignored. Numeric conversions do not allocate.
+ *
+ * \exception `std::invalid_argument` if `input` cannot be converted
+ */
 template <class OutputType>
-OutputType to_value(std::string input);
+OutputType to_value(std::string_view input);
 
 
 // specializations
@@ -20,22 +33,22 @@ OutputType to_value(std::string input);
 
 // int
 template<>
-int to_value(std::string input);
+int to_value(std::string_view input);
 
 
 // unsigned int
 template<>
-unsigned int to_value(std::string input);
+unsigned int to_value(std::string_view input);
 
 
 // double
 template<>
-double to_value(std::string input);
+double to_value(std::string_view input);
 
 
 // string
 template<>
-std::string to_value(std::string input);
+std::string to_value(std::string_view input);
 
 
 }       // rohdeschwarz
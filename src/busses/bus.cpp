@@ -74,3 +74,33 @@ bool Bus::readData(std::size_t* readSize)
 {
   return readData(_buffer.data(), _buffer.size(), readSize);
 }
+
+
+bool Bus::readStatusByte(unsigned char* statusByte)
+{
+  // not supported
+  (void)statusByte;
+  return false;
+}
+
+
+bool Bus::enableServiceRequest()
+{
+  // not supported
+  return false;
+}
+
+
+bool Bus::waitForServiceRequest(unsigned int timeout_ms)
+{
+  // not supported
+  (void)timeout_ms;
+  return false;
+}
+
+
+bool Bus::clear()
+{
+  // not supported
+  return false;
+}
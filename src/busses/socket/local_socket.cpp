@@ -0,0 +1,143 @@
+/**
+ * \file  local_socket.cpp
+ * \brief rohdeschwarz::busses::socket::LocalSocket class implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/busses/socket/local_socket.hpp"
+using namespace rohdeschwarz::busses::socket;
+
+
+// posix
+#include <poll.h>
+
+
+// types
+using char_p       = char*;
+using const_char_p = const char*;
+using protocol     = boost::asio::local::stream_protocol;
+
+
+LocalSocket::LocalSocket(const std::string& path) :
+  _path(path),
+  _timeout_ms(2000),
+  _socket(_io_context)
+{
+  _socket.connect(protocol::endpoint(path));
+}
+
+
+LocalSocket::~LocalSocket()
+{
+  boost::system::error_code ignore;
+  _socket.shutdown(protocol::socket::shutdown_both, ignore);
+  _socket.close(ignore);
+}
+
+
+std::string LocalSocket::path() const
+{
+  return _path;
+}
+
+
+std::string LocalSocket::endpoint() const
+{
+  return "local:" + _path;
+}
+
+
+int LocalSocket::timeout_ms() const
+{
+  return _timeout_ms;
+}
+
+
+bool LocalSocket::setTimeout(int timeout_ms)
+{
+  if (timeout_ms < 0)
+  {
+    // error
+    return false;
+  }
+  _timeout_ms = timeout_ms;
+  return true;
+}
+
+
+bool LocalSocket::readData(unsigned char* buffer, std::size_t bufferSize, std::size_t* readSize)
+{
+  // wait for data
+  // note: blocking asio reads do not time out
+  boost::system::error_code ignore;
+  if (_timeout_ms > 0 && _socket.available(ignore) == 0)
+  {
+    pollfd descriptor = {_socket.native_handle(), POLLIN, 0};
+    if (poll(&descriptor, 1, _timeout_ms) <= 0)
+    {
+      // timeout or error
+      return false;
+    }
+  }
+
+  // read
+  std::size_t _readSize;
+  try
+  {
+    _readSize = _socket.read_some(boost::asio::buffer(char_p(buffer), bufferSize));
+  }
+
+  // error?
+  catch (const system_error& error)
+  {
+    return false;
+  }
+
+  // return read size?
+  if (readSize != nullptr)
+  {
+    *readSize = _readSize;
+  }
+
+  // success
+  return true;
+}
+
+
+bool LocalSocket::writeData(const unsigned char* data, std::size_t dataSize, std::size_t* writeSize)
+{
+  // write
+  std::size_t _writeSize;
+  try
+  {
+    _writeSize = boost::asio::write(_socket, boost::asio::buffer(const_char_p(data), dataSize));
+  }
+
+  // error?
+  catch (const system_error& error)
+  {
+    return false;
+  }
+
+  // return write size?
+  if (writeSize != nullptr)
+  {
+    *writeSize = _writeSize;
+  }
+
+  // success
+  return true;
+}
+
+
+bool LocalSocket::isError() const
+{
+  return !_socket.is_open();
+}
+
+
+std::string LocalSocket::statusMessage() const
+{
+  return _socket.is_open()? "connection is open" : "warning: connection is closed";
+}
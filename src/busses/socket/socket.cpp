@@ -7,30 +7,68 @@
 // rohdeschwarz
 #include "rohdeschwarz/busses/socket/helpers.hpp"
 #include "rohdeschwarz/busses/socket/socket.hpp"
+#include "rohdeschwarz/scpi/message_scanner.hpp"
+#include "rohdeschwarz/probes.hpp"
 using namespace rohdeschwarz::busses::socket;
+using namespace rohdeschwarz::scpi;
 
 
 // boost
 const auto shutdown_both = boost::asio::ip::tcp::socket::shutdown_both;
 
 
+// poll
+#ifdef _WIN32
+#define poll WSAPoll
+#else
+#include <poll.h>
+#endif
+
+
 // std lib
+#include <chrono>
 #include <sstream>
+#include <vector>
+
+
+// constants
+const int QUIET_ms                 = 10;
+const int DEFAULT_CLEAR_TIMEOUT_ms = 2000;
 
 
 // types
-// Note: do I need WS2tcpip.h on windows?
-// See https://stackoverflow.com/a/4454036/1390788
-using char_p       = char*;
-using const_char_p = const char*;
-using socklen_t_p  = socklen_t*;
+using char_p        = char*;
+using const_char_p  = const char*;
+using const_uchar_p = const unsigned char*;
+using error_code    = boost::system::error_code;
+using clock_type    = std::chrono::steady_clock;
+
+
+namespace
+{
+
+
+/**
+ * \brief Waits for `events` on `socket`
+ *
+ * \param[in] timeout_ms timeout, in milliseconds; `0` waits indefinitely
+ * \returns `true` if ready; `false` on timeout or error
+ */
+bool wait_for(boost::asio::ip::tcp::socket::native_handle_type socket, short events, int timeout_ms)
+{
+  pollfd descriptor = {socket, events, 0};
+  return poll(&descriptor, 1, timeout_ms > 0? timeout_ms : -1) > 0;
+}
+
+
+}  // namespace
 
 
 Socket::Socket(const char* host, int port) :
   _host(host),
   _port(port),
-  _socket(_io_context),
-  _native_handle(_socket.native_handle())
+  _timeout_ms(0),
+  _socket(_io_context)
 {
   open();
 }
@@ -39,8 +77,8 @@ Socket::Socket(const char* host, int port) :
 Socket::Socket(const std::string& host, int port) :
   _host(host),
   _port(port),
-  _socket(_io_context),
-  _native_handle(_socket.native_handle())
+  _timeout_ms(0),
+  _socket(_io_context)
 {
   open();
 }
@@ -74,62 +112,49 @@ std::string Socket::endpoint() const
 
 int Socket::timeout_ms() const
 {
-  // use read timeout
-  int timeout_ms;
-  int bytes_read;
-  getsockopt(
-    _native_handle,
-    SOL_SOCKET, SO_RCVTIMEO,
-    char_p(&timeout_ms),
-    socklen_t_p(&bytes_read)
-  );
-  return timeout_ms;
+  return _timeout_ms;
 }
 
 
 bool Socket::setTimeout(int timeout_ms)
 {
-  // set read timeout
-  int result = setsockopt
-  (
-      _native_handle,
-      SOL_SOCKET, SO_RCVTIMEO,
-      const_char_p(&timeout_ms),
-      sizeof(timeout_ms)
-  );
-  if (result != 0)
+  if (timeout_ms < 0)
   {
     // error
     return false;
   }
-
-  // set write timeout
-  result = setsockopt(
-    _native_handle,
-    SOL_SOCKET, SO_SNDTIMEO,
-    const_char_p(&timeout_ms),
-    sizeof(timeout_ms)
-  );
-
-  // success?
-  return result == 0;
+  _timeout_ms = timeout_ms;
+  return true;
 }
 
 
 bool Socket::readData(unsigned char* buffer, std::size_t bufferSize, std::size_t* readSize)
 {
+  ROHDESCHWARZ_PROBE2(socket__read__start, this, bufferSize);
+
   // read
+  // note: read_some returns as soon as any data is available;
+  // boost::asio::read would block until buffer is full
   boost::asio::mutable_buffer _buffer
     = boost::asio::buffer(char_p(buffer), bufferSize);
-  std::size_t _readSize;
-  try
+  error_code error;
+  std::size_t _readSize = _socket.read_some(_buffer, error);
+  if (error == boost::asio::error::would_block)
   {
-    _readSize = boost::asio::read(_socket, _buffer);
+    // wait for data
+    if (!wait_for(_socket.native_handle(), POLLIN, _timeout_ms))
+    {
+      // timeout
+      ROHDESCHWARZ_PROBE3(socket__read__done, this, 0, false);
+      return false;
+    }
+    _readSize = _socket.read_some(_buffer, error);
   }
 
   // error?
-  catch (const system_error& error)
+  if (error)
   {
+    ROHDESCHWARZ_PROBE3(socket__read__done, this, 0, false);
     return false;
   }
 
@@ -140,25 +165,40 @@ bool Socket::readData(unsigned char* buffer, std::size_t bufferSize, std::size_t
   }
 
   // success
+  ROHDESCHWARZ_PROBE3(socket__read__done, this, _readSize, true);
   return true;
 }
 
 
 bool Socket::writeData(const unsigned char* data, std::size_t dataSize, std::size_t* writeSize)
 {
-  // write
-  boost::asio::const_buffer _buffer
-    = boost::asio::buffer(const_char_p(data), dataSize);
-  std::size_t _writeSize;
-  try
-  {
-    _writeSize = boost::asio::write(_socket, _buffer);
-  }
+  ROHDESCHWARZ_PROBE2(socket__write__start, this, dataSize);
 
-  // error?
-  catch (const system_error& error)
+  // write
+  std::size_t _writeSize = 0;
+  while (_writeSize < dataSize)
   {
-    return false;
+    boost::asio::const_buffer _buffer
+      = boost::asio::buffer(const_char_p(data) + _writeSize, dataSize - _writeSize);
+    error_code error;
+    _writeSize += _socket.write_some(_buffer, error);
+    if (error == boost::asio::error::would_block)
+    {
+      // wait for send buffer
+      if (!wait_for(_socket.native_handle(), POLLOUT, _timeout_ms))
+      {
+        // timeout
+        break;
+      }
+      continue;
+    }
+
+    // error?
+    if (error)
+    {
+      ROHDESCHWARZ_PROBE3(socket__write__done, this, _writeSize, false);
+      return false;
+    }
   }
 
   // return write size?
@@ -167,8 +207,9 @@ bool Socket::writeData(const unsigned char* data, std::size_t dataSize, std::siz
     *writeSize = _writeSize;
   }
 
-  // success
-  return true;
+  // success?
+  ROHDESCHWARZ_PROBE3(socket__write__done, this, _writeSize, _writeSize == dataSize);
+  return _writeSize == dataSize;
 }
 
 
@@ -184,10 +225,85 @@ std::string Socket::statusMessage() const
 }
 
 
+bool Socket::tcpInfo(TcpInfo* info)
+{
+#ifdef __linux__
+  return read_tcp_info(_socket.native_handle(), info);
+#else
+  (void)info;
+  return false;
+#endif
+}
+
+
+bool Socket::clear()
+{
+  std::vector<unsigned char>& buffer = *this->buffer();
+  const int timeout_ms = _timeout_ms > 0? _timeout_ms : DEFAULT_CLEAR_TIMEOUT_ms;
+  const auto deadline  = clock_type::now() + std::chrono::milliseconds(timeout_ms);
+
+  // drain until quiet
+  std::size_t read_size;
+  while (wait_for(_socket.native_handle(), POLLIN, QUIET_ms))
+  {
+    if (clock_type::now() > deadline || !readData(buffer.data(), buffer.size(), &read_size))
+    {
+      // error or timeout
+      return false;
+    }
+  }
+
+  // resynchronize with marker query
+  const std::string marker = "*STB?\n";
+  if (!writeData(const_uchar_p(marker.data()), marker.size()))
+  {
+    // error
+    return false;
+  }
+
+  // read until quiet after a complete response message
+  MessageScanner scanner;
+  bool is_message_end = false;
+  while (!is_message_end || wait_for(_socket.native_handle(), POLLIN, QUIET_ms))
+  {
+    if (clock_type::now() > deadline || !readData(buffer.data(), buffer.size(), &read_size))
+    {
+      // error or timeout
+      return false;
+    }
+
+    // frame response messages
+    std::size_t offset = 0;
+    is_message_end = false;
+    while (offset < read_size)
+    {
+      std::size_t consumed;
+      const bool is_complete = scanner.scan(buffer.data() + offset, read_size - offset, &consumed);
+      is_message_end = is_complete && !scanner.isError();
+      offset += consumed;
+      if (is_complete)
+      {
+        scanner.reset();
+      }
+    }
+  }
+  return true;
+}
+
+
 bool Socket::open()
 {
   auto endpoints = resolve(_host, _port, _io_context);
   boost::asio::connect(_socket, endpoints);
+
+  // disable nagle algorithm;
+  // scpi is request / response, and consecutive small writes
+  // would otherwise wait on delayed acks
+  _socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+  // non-blocking, for read and write timeouts;
+  // note: blocking asio operations ignore SO_RCVTIMEO
+  _socket.non_blocking(true);
   return _socket.is_open();
 }
 
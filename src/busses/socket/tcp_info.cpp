@@ -0,0 +1,57 @@
+/**
+ * \file  tcp_info.cpp
+ * \brief rohdeschwarz::busses::socket::TcpInfo implementation
+ *
+ * Note: uses the kernel's `struct tcp_info` from `linux/tcp.h`, which has
+ * fields that the glibc version in `netinet/tcp.h` lacks. The two headers
+ * conflict, so this translation unit does not include boost asio.
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/busses/socket/tcp_info.hpp"
+using namespace rohdeschwarz::busses::socket;
+
+
+// linux
+#ifdef __linux__
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+
+// std lib
+#include <cstring>
+
+
+bool rohdeschwarz::busses::socket::read_tcp_info(int socket, TcpInfo* info)
+{
+#ifdef __linux__
+  // note: older kernels fill a prefix
+  // of the struct; the rest stays 0
+  struct tcp_info kernel_info;
+  std::memset(&kernel_info, 0, sizeof(kernel_info));
+  socklen_t size = sizeof(kernel_info);
+  if (::getsockopt(socket, IPPROTO_TCP, TCP_INFO, &kernel_info, &size) != 0)
+  {
+    // error
+    return false;
+  }
+
+  info->rtt_us           = kernel_info.tcpi_rtt;
+  info->rttVariance_us   = kernel_info.tcpi_rttvar;
+  info->retransmits      = kernel_info.tcpi_retransmits;
+  info->totalRetransmits = kernel_info.tcpi_total_retrans;
+  info->congestionWindow = kernel_info.tcpi_snd_cwnd;
+  info->mss_B            = kernel_info.tcpi_snd_mss;
+  info->deliveryRate_Bps = kernel_info.tcpi_delivery_rate;
+  info->bytesReceived    = kernel_info.tcpi_bytes_received;
+  return true;
+#else
+  // not supported
+  (void)socket;
+  (void)info;
+  return false;
+#endif
+}
@@ -26,6 +26,7 @@ CVisa::CVisa()
     viWaitOnEvent(nullptr),
     viDiscardEvents(nullptr),
     viReadSTB(nullptr),
+    viClear(nullptr),
     viGpibSendIFC(nullptr),
     viSetAttribute(nullptr),
     viGetAttribute(nullptr),
@@ -82,6 +83,7 @@ bool CVisa::load()
   viWaitOnEvent   = _visa.get<VI_WAITON_EVENT_PTR>   ("viWaitOnEvent");
   viDiscardEvents = _visa.get<VI_DISCARD_EVENTS_PTR> ("viDiscardEvents");
   viReadSTB       = _visa.get<VI_READ_STB_PTR>       ("viReadSTB");
+  viClear         = _visa.get<VI_CLEAR_PTR>          ("viClear");
   viGpibSendIFC   = _visa.get<VI_GPIB_SEND_IFC_PTR>  ("viGpibSendIFC");
   viSetAttribute  = _visa.get<VI_SET_ATTRIBUTE_PTR>  ("viSetAttribute");
   viGetAttribute  = _visa.get<VI_GET_ATTRIBUTE_PTR>  ("viGetAttribute");
@@ -102,6 +104,7 @@ bool CVisa::load()
    || !viWaitOnEvent
    || !viDiscardEvents
    || !viReadSTB
+   || !viClear
    || !viGpibSendIFC
    || !viSetAttribute
    || !viGetAttribute
@@ -1,4 +1,5 @@
 #include "rohdeschwarz/busses/visa/visa.hpp"
+#include "rohdeschwarz/probes.hpp"
 using namespace rohdeschwarz::busses::visa;
 
 
@@ -59,31 +60,111 @@ int Visa::timeout_ms() const
 
 bool Visa::setTimeout(int timeout_ms)
 {
-  return setAttribute(VI_ATTR_TMO_VALUE, ViAttrState(timeout_ms)) >= VI_SUCCESS;
+  return setAttribute(VI_ATTR_TMO_VALUE, ViAttrState(timeout_ms));
 }
 
 
 bool Visa::readData(unsigned char* buffer, std::size_t bufferSize, std::size_t* readSize)
 {
+  ROHDESCHWARZ_PROBE2(visa__read__start, this, bufferSize);
+
+  // note: visa reports size as ViUInt32
+  ViUInt32 _readSize = 0;
   _status = _visa.viRead(
     _instrument,
     ViPBuf(buffer),
     ViUInt32(bufferSize),
-    ViPUInt32(readSize)
+    &_readSize
   );
-  return isError();
+
+  // return read size?
+  if (readSize != nullptr)
+  {
+    *readSize = _readSize;
+  }
+  ROHDESCHWARZ_PROBE3(visa__read__done, this, _readSize, !isError());
+  return !isError();
 }
 
 
 bool Visa::writeData(const unsigned char* data, std::size_t dataSize, std::size_t* writeSize)
 {
+  ROHDESCHWARZ_PROBE2(visa__write__start, this, dataSize);
+
+  // note: visa reports size as ViUInt32
+  ViUInt32 _writeSize = 0;
   _status = _visa.viWrite(
     _instrument,
     ViBuf(data),
     ViUInt32(dataSize),
-    ViPUInt32(writeSize)
+    &_writeSize
+  );
+
+  // return write size?
+  if (writeSize != nullptr)
+  {
+    *writeSize = _writeSize;
+  }
+  ROHDESCHWARZ_PROBE3(visa__write__done, this, _writeSize, !isError());
+  return !isError();
+}
+
+
+bool Visa::readStatusByte(unsigned char* statusByte)
+{
+  ViUInt16 status_byte = 0;
+  _status = _visa.viReadSTB(_instrument, &status_byte);
+  if (isError())
+  {
+    return false;
+  }
+
+  *statusByte = (unsigned char)(status_byte);
+  return true;
+}
+
+
+bool Visa::enableServiceRequest()
+{
+  _status = _visa.viEnableEvent(_instrument, VI_EVENT_SERVICE_REQ, VI_QUEUE, VI_NULL);
+  if (isError())
+  {
+    return false;
+  }
+
+  // discard stale events
+  _status = _visa.viDiscardEvents(_instrument, VI_EVENT_SERVICE_REQ, VI_QUEUE);
+  return !isError();
+}
+
+
+bool Visa::waitForServiceRequest(unsigned int timeout_ms)
+{
+  ViEventType event_type;
+  ViEvent     event;
+  _status = _visa.viWaitOnEvent(
+    _instrument,
+    VI_EVENT_SERVICE_REQ,
+    ViUInt32(timeout_ms),
+    &event_type,
+    &event
   );
-  return isError();
+  if (isError())
+  {
+    // timeout or error
+    return false;
+  }
+
+  // release event context
+  _visa.viClose(ViObject(event));
+  return true;
+}
+
+
+bool Visa::clear()
+{
+  _status = _visa.viClear(_instrument);
+  return !isError();
 }
 
 
@@ -97,7 +178,7 @@ bool Visa::attribute(ViAttr name, ViAttrState* value) const
 bool Visa::setAttribute(ViAttr name, ViAttrState value)
 {
   _status = _visa.viSetAttribute(_instrument, name, value);
-  return isError();
+  return !isError();
 }
 
 
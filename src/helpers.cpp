@@ -27,6 +27,14 @@ auto not_a_space = [](unsigned char ch)
 };
 
 
+auto is_space_char = [](char character)
+{
+  // ascii whitespace, as in the "C" locale;
+  // avoids a std::isspace call per character
+  return character == ' ' || (character >= '\t' && character <= '\r');
+};
+
+
 auto is_quote_char = [](char character)
 {
   return character == SINGLE_QUOTE || character == DOUBLE_QUOTE;
@@ -133,6 +141,31 @@ std::string rohdeschwarz::unquote(const std::string& text)
 }
 
 
+std::string_view rohdeschwarz::trimView(std::string_view text)
+{
+  std::size_t begin = 0;
+  std::size_t end   = text.size();
+  while (begin < end && is_space_char(text[begin]))
+  {
+    begin++;
+  }
+  while (end > begin && is_space_char(text[end - 1]))
+  {
+    end--;
+  }
+  return text.substr(begin, end - begin);
+}
+
+
+std::string_view rohdeschwarz::unquoteView(std::string_view text)
+{
+  const bool is_quoted = text.size() >= 2
+    && is_quote_char(text.front())
+    && is_quote_char(text.back());
+  return is_quoted? text.substr(1, text.size() - 2) : text;
+}
+
+
 std::vector<std::string> rohdeschwarz::split(const char* csvList, const char separator)
 {
   const std::string csv_list_str(csvList);
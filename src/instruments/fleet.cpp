@@ -0,0 +1,491 @@
+/**
+ * \file fleet.cpp
+ * \brief rohdeschwarz::instruments::Fleet implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/fleet.hpp"
+#include "rohdeschwarz/scpi/message_scanner.hpp"
+using namespace rohdeschwarz::instruments;
+using namespace rohdeschwarz::scpi;
+
+
+// std lib
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+
+// constants
+const std::size_t CHUNK_SIZE_B = 4096;
+
+
+// types
+using const_char_p = const char*;
+using tcp          = boost::asio::ip::tcp;
+using error_code   = boost::system::error_code;
+using clock_type   = std::chrono::steady_clock;
+using strand_type  = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+
+namespace
+{
+
+
+/**
+ * \brief Result of a complete scan; protocol error on a framing error
+ */
+error_code scan_error(const MessageScanner& scanner)
+{
+  if (scanner.isError())
+  {
+    return boost::system::errc::make_error_code(boost::system::errc::protocol_error);
+  }
+  return error_code();
+}
+
+
+/**
+ * \brief `message` with program message terminator
+ *
+ * Same as `Instrument::write`.
+ */
+std::string terminated(std::string message)
+{
+  if (message.empty() || message.back() != '\n')
+  {
+    message.push_back('\n');
+  }
+  return message;
+}
+
+
+}  // namespace
+
+
+// device
+
+struct Fleet::Device
+{
+  Device(boost::asio::io_context& io_context, std::string host, int port) :
+    host(std::move(host)),
+    port(port),
+    strand(boost::asio::make_strand(io_context)),
+    socket(strand),
+    resolver(strand),
+    timer(strand),
+    chunk(CHUNK_SIZE_B),
+    operation(0),
+    isTimedOut(false)
+  {
+    // no operations
+  }
+
+  std::string               host;
+  int                       port;
+  strand_type               strand;
+  tcp::socket               socket;
+  tcp::resolver             resolver;
+  boost::asio::steady_timer timer;
+
+  // response
+  std::vector<unsigned char> chunk;
+  std::string                readAhead;
+  std::string                response;
+  MessageScanner             scanner;
+
+  // operation
+  std::size_t            operation;
+  bool                   isTimedOut;
+  clock_type::time_point start;
+  DeviceHealth           health;
+};
+
+
+class Fleet::Batch
+{
+
+public:
+
+  Batch(std::size_t pending) :
+    _pending(pending)
+  {
+    // no operations
+  }
+
+
+  void done()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending--;
+    if (_pending == 0)
+    {
+      _condition.notify_all();
+    }
+  }
+
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.wait(lock, [this]()
+    {
+      return _pending == 0;
+    });
+  }
+
+
+private:
+
+  std::mutex              _mutex;
+  std::condition_variable _condition;
+  std::size_t             _pending;
+
+};
+
+
+Fleet::Fleet(std::size_t threads) :
+  _work(boost::asio::make_work_guard(_io_context)),
+  _timeout_ms(2000)
+{
+  if (threads == 0)
+  {
+    threads = 1;
+  }
+  for (std::size_t i = 0; i < threads; i++)
+  {
+    _threads.emplace_back([this]()
+    {
+      _io_context.run();
+    });
+  }
+}
+
+
+Fleet::~Fleet()
+{
+  closeAll();
+  _work.reset();
+  _io_context.stop();
+  for (auto& thread : _threads)
+  {
+    thread.join();
+  }
+}
+
+
+std::size_t Fleet::add(std::string host, int port)
+{
+  _devices.push_back(std::make_unique<Device>(_io_context, std::move(host), port));
+  return _devices.size() - 1;
+}
+
+
+std::size_t Fleet::size() const
+{
+  return _devices.size();
+}
+
+
+std::string Fleet::endpoint(std::size_t index) const
+{
+  const Device& device = *_devices.at(index);
+  return device.host + ":" + std::to_string(device.port);
+}
+
+
+DeviceHealth Fleet::health(std::size_t index) const
+{
+  return _devices.at(index)->health;
+}
+
+
+std::size_t Fleet::healthy() const
+{
+  std::size_t count = 0;
+  for (const auto& device : _devices)
+  {
+    if (device->health.state == DeviceState::Ok)
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+
+int Fleet::timeout_ms() const
+{
+  return _timeout_ms;
+}
+
+
+void Fleet::setTimeout(int timeout_ms)
+{
+  _timeout_ms = timeout_ms;
+}
+
+
+std::size_t Fleet::openAll(int timeout_ms)
+{
+  run(false, [this, timeout_ms](Device& device, std::function<void(bool)> done)
+  {
+    startTimer(device, timeout_ms);
+    device.readAhead.clear();
+    device.resolver.async_resolve(device.host, std::to_string(device.port),
+      [this, &device, done](const error_code& error, tcp::resolver::results_type endpoints)
+    {
+      if (error)
+      {
+        // error
+        finish(device, error);
+        done(false);
+        return;
+      }
+      boost::asio::async_connect(device.socket, endpoints,
+        [this, &device, done](error_code error, const tcp::endpoint&)
+      {
+        // disable nagle algorithm; see Socket
+        if (!error)
+        {
+          device.socket.set_option(tcp::no_delay(true), error);
+        }
+        finish(device, error);
+        done(!error);
+      });
+    });
+  });
+
+  // connected
+  std::size_t count = 0;
+  for (const auto& device : _devices)
+  {
+    if (device->socket.is_open())
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+
+void Fleet::closeAll()
+{
+  run(true, [](Device& device, std::function<void(bool)> done)
+  {
+    error_code ignore;
+    device.socket.shutdown(tcp::socket::shutdown_both, ignore);
+    device.socket.close(ignore);
+    device.readAhead.clear();
+    device.health.state = DeviceState::Closed;
+    done(true);
+  });
+}
+
+
+std::size_t Fleet::writeAll(const std::string& message)
+{
+  const std::string data = terminated(message);
+  return run(true, [this, &data](Device& device, std::function<void(bool)> done)
+  {
+    startTimer(device, _timeout_ms);
+    boost::asio::async_write(device.socket, boost::asio::buffer(data),
+      [this, &device, done](const error_code& error, std::size_t)
+    {
+      finish(device, error);
+      done(!error);
+    });
+  });
+}
+
+
+std::vector<std::string> Fleet::queryAll(const std::string& message)
+{
+  const std::string data = terminated(message);
+  for (auto& device : _devices)
+  {
+    device->response.clear();
+  }
+  run(true, [this, &data](Device& device, std::function<void(bool)> done)
+  {
+    startTimer(device, _timeout_ms);
+    boost::asio::async_write(device.socket, boost::asio::buffer(data),
+      [this, &device, done](const error_code& error, std::size_t)
+    {
+      if (error)
+      {
+        // error
+        finish(device, error);
+        done(false);
+        return;
+      }
+      device.scanner.reset();
+      readResponse(device, [this, &device, done](const error_code& error)
+      {
+        finish(device, error);
+        done(!error);
+      });
+    });
+  });
+
+  // gather
+  std::vector<std::string> responses;
+  responses.reserve(_devices.size());
+  for (auto& device : _devices)
+  {
+    responses.push_back(std::move(device->response));
+  }
+  return responses;
+}
+
+
+std::size_t Fleet::run(bool isConnected,
+                       const std::function<void(Device&, std::function<void(bool)> done)>& operation)
+{
+  std::vector<Device*> devices;
+  for (auto& device : _devices)
+  {
+    if (device->socket.is_open() == isConnected)
+    {
+      devices.push_back(device.get());
+    }
+  }
+  if (devices.empty())
+  {
+    return 0;
+  }
+
+  // start on each device strand
+  Batch batch(devices.size());
+  std::atomic<std::size_t> succeeded(0);
+  for (Device* device : devices)
+  {
+    boost::asio::post(device->strand, [&, device]()
+    {
+      operation(*device, [&](bool isSuccess)
+      {
+        if (isSuccess)
+        {
+          succeeded++;
+        }
+        batch.done();
+      });
+    });
+  }
+  batch.wait();
+  return succeeded;
+}
+
+
+void Fleet::startTimer(Device& device, int timeout_ms)
+{
+  const std::size_t operation = ++device.operation;
+  device.isTimedOut = false;
+  device.start      = clock_type::now();
+  if (timeout_ms <= 0)
+  {
+    // wait indefinitely
+    return;
+  }
+
+  device.timer.expires_after(std::chrono::milliseconds(timeout_ms));
+  device.timer.async_wait([&device, operation](const error_code& error)
+  {
+    // note: a completed operation may race
+    // with the expiry of its timer
+    if (error || operation != device.operation)
+    {
+      // cancelled
+      return;
+    }
+
+    // abort pending operations
+    device.isTimedOut = true;
+    error_code ignore;
+    device.resolver.cancel();
+    device.socket.close(ignore);
+  });
+}
+
+
+void Fleet::finish(Device& device, const error_code& error)
+{
+  device.operation++;
+  device.timer.cancel();
+  DeviceHealth& health = device.health;
+  if (!error)
+  {
+    const auto elapsed = clock_type::now() - device.start;
+    health.state      = DeviceState::Ok;
+    health.failures   = 0;
+    health.latency_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+    return;
+  }
+
+  // error
+  health.failures++;
+  if (device.isTimedOut)
+  {
+    health.state   = DeviceState::Timeout;
+    health.message = "timeout";
+    health.timeouts++;
+  }
+  else
+  {
+    health.state   = DeviceState::Error;
+    health.message = error.message();
+    health.errors++;
+  }
+
+  // disconnect; discards partial responses
+  error_code ignore;
+  device.socket.close(ignore);
+  device.readAhead.clear();
+  device.response.clear();
+}
+
+
+void Fleet::readResponse(Device& device, std::function<void(const error_code&)> done)
+{
+  // data left from a previous read?
+  if (!device.readAhead.empty())
+  {
+    std::size_t consumed;
+    const auto data = reinterpret_cast<const unsigned char*>(device.readAhead.data());
+    const bool is_complete = device.scanner.scan(data, device.readAhead.size(), &consumed);
+    device.response.append(device.readAhead, 0, consumed);
+    device.readAhead.erase(0, consumed);
+    if (is_complete)
+    {
+      done(scan_error(device.scanner));
+      return;
+    }
+  }
+
+  auto buffer = boost::asio::buffer(device.chunk);
+  device.socket.async_read_some(buffer, [this, &device, done](const error_code& error, std::size_t size)
+  {
+    if (error)
+    {
+      // error or timeout
+      done(error);
+      return;
+    }
+
+    std::size_t consumed;
+    const unsigned char* data = device.chunk.data();
+    const bool is_complete = device.scanner.scan(data, size, &consumed);
+    device.response.append(const_char_p(data), consumed);
+    if (is_complete)
+    {
+      // keep data of later messages
+      device.readAhead.assign(const_char_p(data) + consumed, size - consumed);
+      done(scan_error(device.scanner));
+      return;
+    }
+    readResponse(device, done);
+  });
+}
@@ -9,23 +9,52 @@
 #include "rohdeschwarz/busses/visa/visa.hpp"
 #include "rohdeschwarz/instruments/instrument.hpp"
 #include "rohdeschwarz/instruments/preserve_timeout.hpp"
+#include "rohdeschwarz/instruments/profiler.hpp"
+#include "rohdeschwarz/instruments/transfer_governor.hpp"
+#include "rohdeschwarz/metrics/bus_trace.hpp"
+#include "rohdeschwarz/metrics/recorder.hpp"
 #include "rohdeschwarz/scpi/bool.hpp"
+#include "rohdeschwarz/scpi/message_scanner.hpp"
+#include "rohdeschwarz/scpi/tokenizer.hpp"
 #include "rohdeschwarz/helpers.hpp"
 #include "rohdeschwarz/to_vector.hpp"
 using namespace rohdeschwarz::busses::socket;
 using namespace rohdeschwarz::busses::visa;
 using namespace rohdeschwarz::instruments;
+using namespace rohdeschwarz::metrics;
 using namespace rohdeschwarz::scpi;
 using namespace rohdeschwarz;
 
 
+// posix
+#if defined(__unix__) || defined(__APPLE__)
+#include "rohdeschwarz/busses/socket/local_socket.hpp"
+#endif
+
+
 // std lib
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <sstream>
+#include <thread>
+
+
+// constants
+const unsigned char EVENT_STATUS_BIT = 0x20;
+const auto MIN_POLL_INTERVAL = std::chrono::milliseconds(1);
+const auto MAX_POLL_INTERVAL = std::chrono::milliseconds(8);
 
 
 // types
 using const_char_p = const char*;
+using clock_type   = std::chrono::steady_clock;
+
+
+double BlockTransfer::throughput_Bps() const
+{
+  return time_s > 0? double(size_B) / time_s : 0;
+}
 
 
 bool Instrument::isOpen() const
@@ -54,13 +83,37 @@ bool Instrument::openVisa(std::string resource, unsigned int timeout_ms)
 }
 
 
-bool Instrument::openTcp(std::string host, unsigned int timeout_ms)
+bool Instrument::openTcp(std::string host, unsigned int timeout_ms, int port)
 {
   // connect to host
   using rohdeschwarz::busses::socket::system_error;
   try
   {
-    _bus.reset(new Socket(host, timeout_ms));
+    _bus.reset(new Socket(host, port));
+  }
+
+  // error
+  catch (const system_error& error)
+  {
+    return false;
+  }
+
+  // set timeout
+  setTimeout(timeout_ms);
+
+  // success
+  return true;
+}
+
+
+#if defined(__unix__) || defined(__APPLE__)
+bool Instrument::openLocal(std::string path, unsigned int timeout_ms)
+{
+  // connect to local socket
+  using rohdeschwarz::busses::socket::system_error;
+  try
+  {
+    _bus.reset(new LocalSocket(path));
   }
 
   // error
@@ -69,14 +122,103 @@ bool Instrument::openTcp(std::string host, unsigned int timeout_ms)
     return false;
   }
 
+  // set timeout
+  setTimeout(timeout_ms);
+
   // success
   return true;
 }
+#endif
 
 
 void Instrument::close()
 {
+  if (_recorder)
+  {
+    _recorder->setConnection(std::string());
+  }
+  _busTraceSource = BusTrace::NO_SOURCE;
   _bus.reset();
+  _readAhead.clear();
+}
+
+
+void Instrument::setAbortFlag(const std::atomic<bool>* flag)
+{
+  _abortFlag = flag;
+}
+
+
+bool Instrument::isAborted() const
+{
+  return _abortFlag != nullptr && _abortFlag->load(std::memory_order_relaxed);
+}
+
+
+bool Instrument::clear()
+{
+  _readAhead.clear();
+  return _bus->clear();
+}
+
+
+void Instrument::setTransferGovernor(TransferGovernor* governor)
+{
+  _governor = governor;
+}
+
+
+TransferGovernor* Instrument::transferGovernor() const
+{
+  return _governor;
+}
+
+
+void Instrument::setProfiler(Profiler* profiler)
+{
+  _profiler = profiler;
+}
+
+
+Profiler* Instrument::profiler() const
+{
+  return _profiler;
+}
+
+
+void Instrument::setBusTrace(BusTrace* trace)
+{
+  _busTrace       = trace;
+  _busTraceSource = BusTrace::NO_SOURCE;
+}
+
+
+void Instrument::setTcpInfoSampling(bool isSampling)
+{
+  _isTcpInfoSampling = isSampling;
+}
+
+
+bool Instrument::isTcpInfoSampling() const
+{
+  return _isTcpInfoSampling;
+}
+
+
+const BlockTransfer& Instrument::lastBlockTransfer() const
+{
+  return _blockTransfer;
+}
+
+
+void Instrument::setMetrics(metrics::Metrics* metrics)
+{
+  if (metrics == nullptr)
+  {
+    _recorder.reset();
+    return;
+  }
+  _recorder = std::make_shared<metrics::Recorder>(metrics);
 }
 
 
@@ -122,35 +264,119 @@ bool Instrument::setTimeout(int timeout_ms)
 
 bool Instrument::readData(unsigned char* buffer, std::size_t bufferSize, std::size_t* readSize)
 {
-  return _bus->readData(buffer, bufferSize, readSize);
+  if (isAborted())
+  {
+    // aborted
+    return false;
+  }
+  if (!_recorder && _profiler == nullptr && _busTrace == nullptr)
+  {
+    return _bus->readData(buffer, bufferSize, readSize);
+  }
+
+  // record
+  std::size_t read_size = 0;
+  const auto start = clock_type::now();
+  const bool is_ok = _bus->readData(buffer, bufferSize, &read_size);
+  recordRead(start, read_size, is_ok);
+  if (readSize != nullptr)
+  {
+    *readSize = read_size;
+  }
+  return is_ok;
 }
 
 
 bool Instrument::writeData(const unsigned char* data, std::size_t dataSize, std::size_t* writeSize)
 {
-  return _bus->writeData(data, dataSize, writeSize);
+  if (!_recorder && _profiler == nullptr && _busTrace == nullptr)
+  {
+    return _bus->writeData(data, dataSize, writeSize);
+  }
+
+  // record
+  const auto start = clock_type::now();
+  const bool is_ok = _bus->writeData(data, dataSize, writeSize);
+  if (_recorder)
+  {
+    recorder()->recordWrite(data, dataSize, start, is_ok);
+  }
+  if (_profiler != nullptr)
+  {
+    _profiler->recordWrite(data, dataSize, clock_type::now() - start);
+  }
+  if (_busTrace != nullptr && is_ok)
+  {
+    _busTrace->recordWrite(busTraceSource(), start, clock_type::now(), data, dataSize);
+  }
+  else if (_busTrace != nullptr)
+  {
+    _busTrace->record(BusEvent::Type::Timeout, busTraceSource(), start, clock_type::now(), dataSize);
+  }
+  return is_ok;
 }
 
 
 bool Instrument::readData(std::size_t* readSize)
 {
-  return _bus->readData(readSize);
+  if (isAborted())
+  {
+    // aborted
+    return false;
+  }
+  if (!_recorder && _profiler == nullptr && _busTrace == nullptr)
+  {
+    return _bus->readData(readSize);
+  }
+
+  // record
+  std::size_t read_size = 0;
+  const auto start = clock_type::now();
+  const bool is_ok = _bus->readData(&read_size);
+  recordRead(start, read_size, is_ok);
+  if (readSize != nullptr)
+  {
+    *readSize = read_size;
+  }
+  return is_ok;
 }
 
 
 std::string Instrument::read()
 {
-  // read data
+  // take data read ahead of previous response, if any
+  std::vector<unsigned char> data;
+  data.swap(_readAhead);
+
+  // read until the message terminator,
+  // outside of quotes and block data
+  scpi::MessageScanner scanner;
   std::size_t size;
-  if (!readData(&size))
+  bool is_complete = scanner.scan(data.data(), data.size(), &size);
+  while (!is_complete)
   {
-    // error
+    std::size_t read_size;
+    if (!readData(&read_size))
+    {
+      // error
+      return std::string();
+    }
+    const auto begin = buffer()->cbegin();
+    data.insert(data.end(), begin, begin + read_size);
+
+    std::size_t consumed;
+    is_complete = scanner.scan(data.data() + size, read_size, &consumed);
+    size += consumed;
+  }
+  if (scanner.isError())
+  {
+    // error; malformed response
     return std::string();
   }
 
-  // convert to string
-  auto data = const_char_p(buffer()->data());
-  return std::string(data, size);
+  // keep the rest for the next response
+  _readAhead.assign(data.begin() + size, data.end());
+  return std::string(data.begin(), data.begin() + size);
 }
 
 
@@ -168,24 +394,56 @@ std::vector<std::complex<double>> Instrument::readAsciiComplexVector()
 }
 
 
-scpi::BlockData Instrument::readBlockData()
+std::string Instrument::readNextResponse()
 {
-  // read initial data
-  std::size_t read_size;
-  if (!readData(&read_size))
+  std::vector<unsigned char> data;
+  data.swap(_readAhead);
+
+  // find separator, outside of quotes
+  char quote = '\0';
+  std::size_t i = 0;
+  while (true)
   {
-    // error
-    return scpi::BlockData();
+    const std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+    i = scpi::findUnquoted(text, ";\n", i, &quote);
+    if (i < data.size())
+    {
+      // keep the rest for the next response
+      _readAhead.assign(data.begin() + i + 1, data.end());
+      return std::string(data.begin(), data.begin() + i);
+    }
+
+    // read more data
+    std::size_t read_size;
+    if (!readData(&read_size))
+    {
+      // error
+      return std::string();
+    }
+    const auto begin = buffer()->cbegin();
+    data.insert(data.end(), begin, begin + read_size);
   }
+}
 
-  // take initial data from buffer
-  auto data = takeData();
-  data.resize(read_size);
 
-  // create block
-  scpi::BlockData block_data(std::move(data));
+scpi::BlockData Instrument::readBlockData()
+{
+  scpi::BlockData block_data;
+  beginBlock();
+
+  // take data read ahead of previous block, if any
+  if (!_readAhead.empty())
+  {
+    std::vector<unsigned char> read_ahead;
+    read_ahead.swap(_readAhead);
+    const std::size_t consumed = block_data.push_back(read_ahead.cbegin(), read_ahead.size());
+    _readAhead.assign(read_ahead.cbegin() + consumed, read_ahead.cend());
+  }
 
   // read until block data is complete
+  TransferGovernor::Grant grant;
+  bool is_governed = false;
+  bool is_started = false;
   while (!block_data.isComplete())
   {
     if (block_data.isHeaderError())
@@ -194,23 +452,102 @@ scpi::BlockData Instrument::readBlockData()
       return scpi::BlockData();
     }
 
+    // header complete?
+    if (!is_started && block_data.isHeader())
+    {
+      startBlock(block_data.size());
+      is_started = true;
+    }
+
+    // wait for transfer budget?
+    if (_governor != nullptr && !is_governed && block_data.isHeader())
+    {
+      grant = _governor->acquire(this, block_data.size());
+      is_governed = true;
+    }
+
     // read more data
+    std::size_t read_size;
     if (!readData(&read_size))
     {
       // error
       return BlockData();
     }
 
-    // push data to block
-    const auto begin = buffer()->begin();
-    block_data.push_back(begin, read_size);
+    // push data to block; keep the rest for the next response
+    const auto begin = buffer()->cbegin();
+    const std::size_t consumed = block_data.push_back(begin, read_size);
+    _readAhead.assign(begin + consumed, begin + read_size);
   }
 
   // block data is complete
+  if (!consumeResponseSeparator())
+  {
+    // error
+    return BlockData();
+  }
+  if (!is_started)
+  {
+    // header and payload in one read
+    startBlock(block_data.size());
+  }
+  completeBlock(block_data.size());
   return block_data;
 }
 
 
+bool Instrument::readBlockDataHeader(std::size_t* payloadSize_B)
+{
+  beginBlock();
+  std::size_t header_size;
+  bool is_error;
+  while (!BlockData::parseHeader(_readAhead.data(), _readAhead.size(), &header_size, payloadSize_B, &is_error))
+  {
+    if (is_error || !readAhead())
+    {
+      // error
+      return false;
+    }
+  }
+
+  // keep payload data only
+  _readAhead.erase(_readAhead.begin(), _readAhead.begin() + header_size);
+  startBlock(*payloadSize_B);
+  return true;
+}
+
+
+bool Instrument::readBlockDataPayload(unsigned char* destination, std::size_t size_B)
+{
+  // wait for transfer budget?
+  TransferGovernor::Grant grant;
+  if (_governor != nullptr)
+  {
+    grant = _governor->acquire(this, size_B);
+  }
+
+  // take data read ahead
+  const std::size_t ahead = std::min(size_B, _readAhead.size());
+  std::memcpy(destination, _readAhead.data(), ahead);
+  _readAhead.erase(_readAhead.begin(), _readAhead.begin() + ahead);
+
+  // read the rest directly into destination
+  std::size_t offset = ahead;
+  while (offset < size_B)
+  {
+    std::size_t read_size;
+    if (!readData(destination + offset, size_B - offset, &read_size))
+    {
+      // error
+      return false;
+    }
+    offset += read_size;
+  }
+  completeBlock(size_B);
+  return consumeResponseSeparator();
+}
+
+
 std::vector<double> Instrument::read64BitVector()
 {
   // read block data
@@ -241,6 +578,119 @@ std::vector<std::complex<double>> Instrument::read64BitComplexVector()
 }
 
 
+bool Instrument::readAhead()
+{
+  std::size_t read_size;
+  if (!readData(&read_size))
+  {
+    // error
+    return false;
+  }
+  const auto begin = buffer()->cbegin();
+  _readAhead.insert(_readAhead.end(), begin, begin + read_size);
+  return true;
+}
+
+
+bool Instrument::consumeResponseSeparator()
+{
+  // note: the separator (`;`) or terminator (`\n`)
+  // may not have been received yet
+  if (_readAhead.empty() && !readAhead())
+  {
+    // error
+    return false;
+  }
+  if (_readAhead.front() == ';' || _readAhead.front() == '\n')
+  {
+    _readAhead.erase(_readAhead.begin());
+  }
+  return true;
+}
+
+
+metrics::Recorder* Instrument::recorder()
+{
+  // note: connection is known
+  // only once open
+  if (_recorder->connection().empty())
+  {
+    _recorder->setConnection(_bus->endpoint());
+  }
+  return _recorder.get();
+}
+
+
+void Instrument::recordRead(std::chrono::steady_clock::time_point start, std::size_t size, bool isOk)
+{
+  if (_recorder)
+  {
+    recorder()->recordRead(size, isOk);
+  }
+  if (_profiler != nullptr)
+  {
+    _profiler->recordRead(size, clock_type::now() - start);
+  }
+  if (_busTrace != nullptr)
+  {
+    const auto type = isOk? BusEvent::Type::Read : BusEvent::Type::Timeout;
+    _busTrace->record(type, busTraceSource(), start, clock_type::now(), size);
+  }
+}
+
+
+void Instrument::beginBlock()
+{
+  _blockStart = clock_type::now();
+  if (_isTcpInfoSampling)
+  {
+    Socket* socket = dynamic_cast<Socket*>(_bus.get());
+    _blockTransfer.isTcpInfo = socket != nullptr && socket->tcpInfo(&_blockTransfer.before);
+  }
+}
+
+
+void Instrument::startBlock(std::size_t size_B)
+{
+  if (_busTrace != nullptr)
+  {
+    const auto now = clock_type::now();
+    _busTrace->record(BusEvent::Type::BlockHeader, busTraceSource(), now, now, size_B);
+  }
+}
+
+
+void Instrument::completeBlock(std::size_t size_B)
+{
+  const auto now = clock_type::now();
+  if (_profiler != nullptr)
+  {
+    _profiler->recordBlock(size_B);
+  }
+  if (_busTrace != nullptr)
+  {
+    _busTrace->record(BusEvent::Type::BlockComplete, busTraceSource(), _blockStart, now, size_B);
+  }
+  if (_isTcpInfoSampling)
+  {
+    Socket* socket = dynamic_cast<Socket*>(_bus.get());
+    _blockTransfer.size_B = size_B;
+    _blockTransfer.time_s = std::chrono::duration<double>(now - _blockStart).count();
+    _blockTransfer.isTcpInfo = socket != nullptr && _blockTransfer.isTcpInfo && socket->tcpInfo(&_blockTransfer.after);
+  }
+}
+
+
+std::uint32_t Instrument::busTraceSource()
+{
+  if (_busTraceSource == BusTrace::NO_SOURCE)
+  {
+    _busTraceSource = _busTrace->source(_bus->endpoint());
+  }
+  return _busTraceSource;
+}
+
+
 bool Instrument::isBusError() const
 {
   return _bus->isError();
@@ -289,3 +739,88 @@ bool Instrument::blockUntilOperationComplete(unsigned int timeout_ms)
   setTimeout(timeout_ms);
   return queryScpiBool("*OPC?");
 }
+
+
+bool Instrument::readStatusByte(unsigned char* statusByte)
+{
+  // serial poll?
+  if (_bus->readStatusByte(statusByte))
+  {
+    return true;
+  }
+
+  // *STB?
+  const std::string response = query("*STB?");
+  try
+  {
+    *statusByte = (unsigned char)(to_value<unsigned int>(response));
+  }
+  catch (const std::invalid_argument&)
+  {
+    // error
+    return false;
+  }
+  return true;
+}
+
+
+bool Instrument::armOperationComplete()
+{
+  // note: not all busses support service requests
+  _bus->enableServiceRequest();
+
+  // clear a stale event, e.g. of a
+  // timed out or aborted wait
+  return !query("*ESR?;*ESE 1;*SRE 32;*OPC").empty();
+}
+
+
+bool Instrument::isOperationComplete()
+{
+  unsigned char status_byte;
+  if (!readStatusByte(&status_byte))
+  {
+    // error
+    return false;
+  }
+
+  if (!(status_byte & EVENT_STATUS_BIT))
+  {
+    // pending
+    return false;
+  }
+
+  // complete; clear event status register
+  query("*ESR?");
+  return true;
+}
+
+
+bool Instrument::waitForOperationComplete(unsigned int timeout_ms)
+{
+  const auto deadline = clock_type::now() + std::chrono::milliseconds(timeout_ms);
+
+  // service request?
+  if (_bus->waitForServiceRequest(timeout_ms) && isOperationComplete())
+  {
+    return true;
+  }
+
+  // poll status byte
+  // note: also after a service request for another reason
+  auto interval = std::chrono::duration_cast<clock_type::duration>(MIN_POLL_INTERVAL);
+  while (!isOperationComplete())
+  {
+    const auto now = clock_type::now();
+    if (now >= deadline || isAborted())
+    {
+      // timeout or aborted
+      return false;
+    }
+
+    // sleep; back off
+    std::this_thread::sleep_for(std::min(interval, deadline - now));
+    interval = std::min<clock_type::duration>(2 * interval, MAX_POLL_INTERVAL);
+  }
+  return true;
+}
@@ -0,0 +1,284 @@
+/**
+ * \file profiler.cpp
+ * \brief rohdeschwarz::instruments::Profiler implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/instrument.hpp"
+#include "rohdeschwarz/instruments/profiler.hpp"
+using namespace rohdeschwarz::instruments;
+
+
+// std lib
+#include <algorithm>
+#include <cstdio>
+
+
+// types
+using clock_type = std::chrono::steady_clock;
+
+
+namespace
+{
+
+
+/**
+ * \brief Innermost scope of the calling thread
+ */
+thread_local ProfileScope* current_scope = nullptr;
+
+
+/**
+ * \brief Count per call; integer if exact
+ */
+std::string per_call(double count, std::size_t calls)
+{
+  char text[32];
+  const double mean = count / double(calls);
+  std::snprintf(text, sizeof(text), mean == double(std::uint64_t(mean))? "%.0f" : "%.1f", mean);
+  return text;
+}
+
+
+std::string to_size(double size_B)
+{
+  char text[32];
+  if (size_B >= 1e6)
+  {
+    std::snprintf(text, sizeof(text), "%.1f MB", size_B / 1e6);
+  }
+  else if (size_B >= 1e3)
+  {
+    std::snprintf(text, sizeof(text), "%.1f KB", size_B / 1e3);
+  }
+  else
+  {
+    std::snprintf(text, sizeof(text), "%.0f B", size_B);
+  }
+  return text;
+}
+
+
+std::string to_time(double time_ns)
+{
+  char text[32];
+  if (time_ns >= 1e7)
+  {
+    std::snprintf(text, sizeof(text), "%.0f ms", time_ns / 1e6);
+  }
+  else if (time_ns >= 1e6)
+  {
+    std::snprintf(text, sizeof(text), "%.1f ms", time_ns / 1e6);
+  }
+  else
+  {
+    std::snprintf(text, sizeof(text), "%.0f us", time_ns / 1e3);
+  }
+  return text;
+}
+
+
+std::string counted(const std::string& count, const char* singular, const char* plural)
+{
+  return count + " " + (count == "1"? singular : plural);
+}
+
+
+}  // namespace
+
+
+// entry
+
+std::string ProfileEntry::toString() const
+{
+  if (calls == 0)
+  {
+    return name + ": no calls";
+  }
+
+  std::string text = name + ":";
+  text += " "  + counted(per_call(double(roundTrips),  calls), "round trip", "round trips");
+  text += ", " + counted(per_call(double(tinyQueries), calls), "tiny query", "tiny queries");
+  if (writes != 0)
+  {
+    text += ", " + counted(per_call(double(writes), calls), "write", "writes");
+  }
+  if (blockReads != 0)
+  {
+    text += ", " + counted(per_call(double(blockReads), calls), "block read", "block reads");
+    text += " " + to_size(double(blockBytes) / double(calls));
+  }
+  text += ", " + to_time(double(time_ns) / double(calls));
+  if (calls > 1)
+  {
+    text += " (" + std::to_string(calls) + " calls)";
+  }
+  return text;
+}
+
+
+// profiler
+
+void Profiler::recordWrite(const unsigned char* data, std::size_t size, std::chrono::nanoseconds elapsed)
+{
+  const bool is_query = std::find(data, data + size, '?') != data + size;
+  for (ProfileScope* scope = current_scope; scope != nullptr; scope = scope->_parent)
+  {
+    if (scope->_profiler != this)
+    {
+      continue;
+    }
+    scope->finishReply();
+    scope->_entry.bytesOut   += size;
+    scope->_entry.busTime_ns += std::uint64_t(elapsed.count());
+    if (!is_query)
+    {
+      scope->_entry.writes++;
+      continue;
+    }
+    scope->_entry.roundTrips++;
+    scope->_isReplyPending = true;
+    scope->_isBlock        = false;
+    scope->_replySize_B    = 0;
+  }
+}
+
+
+void Profiler::recordRead(std::size_t size, std::chrono::nanoseconds elapsed)
+{
+  for (ProfileScope* scope = current_scope; scope != nullptr; scope = scope->_parent)
+  {
+    if (scope->_profiler != this)
+    {
+      continue;
+    }
+    scope->_entry.bytesIn    += size;
+    scope->_entry.busTime_ns += std::uint64_t(elapsed.count());
+    scope->_replySize_B      += size;
+  }
+}
+
+
+void Profiler::recordBlock(std::size_t size_B)
+{
+  for (ProfileScope* scope = current_scope; scope != nullptr; scope = scope->_parent)
+  {
+    if (scope->_profiler != this)
+    {
+      continue;
+    }
+    scope->_entry.blockReads++;
+    scope->_entry.blockBytes += size_B;
+    scope->_isBlock = true;
+  }
+}
+
+
+std::vector<ProfileEntry> Profiler::entries() const
+{
+  std::vector<ProfileEntry> entries;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& [name, entry] : _entries)
+    {
+      entries.push_back(entry);
+    }
+  }
+  std::stable_sort(entries.begin(), entries.end(), [](const ProfileEntry& a, const ProfileEntry& b)
+  {
+    return a.time_ns > b.time_ns;
+  });
+  return entries;
+}
+
+
+void Profiler::print(std::ostream& stream) const
+{
+  for (const ProfileEntry& entry : entries())
+  {
+    stream << entry.toString() << "\n";
+  }
+}
+
+
+void Profiler::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _entries.clear();
+}
+
+
+void Profiler::add(const ProfileEntry& entry)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  ProfileEntry& total = _entries[entry.name];
+  total.name         = entry.name;
+  total.calls       += entry.calls;
+  total.writes      += entry.writes;
+  total.roundTrips  += entry.roundTrips;
+  total.tinyQueries += entry.tinyQueries;
+  total.blockReads  += entry.blockReads;
+  total.blockBytes  += entry.blockBytes;
+  total.bytesOut    += entry.bytesOut;
+  total.bytesIn     += entry.bytesIn;
+  total.time_ns     += entry.time_ns;
+  total.busTime_ns  += entry.busTime_ns;
+}
+
+
+// scope
+
+ProfileScope::ProfileScope(Instrument* instrument, const char* name) :
+  ProfileScope(instrument->profiler(), name)
+{
+  // no operations
+}
+
+
+ProfileScope::ProfileScope(Profiler* profiler, const char* name) :
+  _profiler(profiler),
+  _parent(nullptr),
+  _isReplyPending(false),
+  _isBlock(false),
+  _replySize_B(0)
+{
+  if (_profiler == nullptr)
+  {
+    // disabled
+    return;
+  }
+  _entry.name   = name;
+  _entry.calls  = 1;
+  _parent       = current_scope;
+  current_scope = this;
+  _start        = clock_type::now();
+}
+
+
+ProfileScope::~ProfileScope()
+{
+  if (_profiler == nullptr)
+  {
+    // disabled
+    return;
+  }
+  finishReply();
+  _entry.time_ns = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - _start).count());
+  current_scope  = _parent;
+  _profiler->add(_entry);
+}
+
+
+void ProfileScope::finishReply()
+{
+  if (!_isReplyPending)
+  {
+    return;
+  }
+  _isReplyPending = false;
+  if (!_isBlock && _replySize_B <= Profiler::TINY_REPLY_SIZE_B)
+  {
+    _entry.tinyQueries++;
+  }
+}
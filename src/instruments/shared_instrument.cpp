@@ -0,0 +1,267 @@
+/**
+ * \file shared_instrument.cpp
+ * \brief rohdeschwarz::instruments::SharedInstrument implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/shared_instrument.hpp"
+using namespace rohdeschwarz::instruments;
+
+
+// constants
+const std::size_t MAX_BATCH_SIZE_B = 64 * 1024;
+
+
+// types
+using uchar_p = unsigned char*;
+
+
+SharedInstrument::SharedInstrument(Instrument* instrument) :
+  _instrument(instrument),
+  _isIdle(false),
+  _isRunning(true),
+  _isStopRequested(false),
+  _isAbortRequested(false),
+  _commands(0),
+  _busWrites(0),
+  _errors(0),
+  _aborts(0)
+{
+  _instrument->setAbortFlag(&_isAbortRequested);
+  _worker = std::thread(&SharedInstrument::run, this);
+}
+
+
+SharedInstrument::~SharedInstrument()
+{
+  stop();
+}
+
+
+void SharedInstrument::stop()
+{
+  if (!_isRunning)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isStopRequested = true;
+  }
+  _condition.notify_one();
+  _worker.join();
+  _instrument->setAbortFlag(nullptr);
+  _isRunning = false;
+}
+
+
+bool SharedInstrument::isRunning() const
+{
+  return _isRunning;
+}
+
+
+std::size_t SharedInstrument::commands() const
+{
+  return _commands;
+}
+
+
+std::size_t SharedInstrument::busWrites() const
+{
+  return _busWrites;
+}
+
+
+std::size_t SharedInstrument::errors() const
+{
+  return _errors;
+}
+
+
+std::size_t SharedInstrument::aborts() const
+{
+  return _aborts;
+}
+
+
+void SharedInstrument::abort()
+{
+  _isAbortRequested = true;
+  if (_isIdle)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _condition.notify_one();
+  }
+}
+
+
+bool SharedInstrument::push(Lane lane, Command command)
+{
+  if (_isStopRequested)
+  {
+    // stopped
+    return false;
+  }
+  _lanes[std::size_t(lane)].push(std::move(command));
+
+  // wake I/O thread?
+  if (_isIdle)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _condition.notify_one();
+  }
+  return true;
+}
+
+
+void SharedInstrument::run()
+{
+  Command command;
+  while (true)
+  {
+    if (_isAbortRequested)
+    {
+      recover();
+    }
+
+    MpscQueue<Command>* lane = next(&command);
+    if (lane == nullptr)
+    {
+      if (_isStopRequested)
+      {
+        // queue drained
+        return;
+      }
+
+      // sleep until next push
+      // note: push checks _isIdle after queueing
+      std::unique_lock<std::mutex> lock(_mutex);
+      _isIdle = true;
+      _condition.wait(lock, [this]()
+      {
+        return !isEmpty() || _isStopRequested || _isAbortRequested;
+      });
+      _isIdle = false;
+      continue;
+    }
+
+    _commands++;
+    if (command.type == Type::Task)
+    {
+      command.task(*_instrument);
+      command.task = nullptr;
+      continue;
+    }
+    execute(*lane, command);
+  }
+}
+
+
+rohdeschwarz::MpscQueue<SharedInstrument::Command>* SharedInstrument::next(Command* command)
+{
+  for (auto& lane : _lanes)
+  {
+    if (lane.tryPop(command))
+    {
+      return &lane;
+    }
+  }
+  return nullptr;
+}
+
+
+bool SharedInstrument::isEmpty() const
+{
+  for (const auto& lane : _lanes)
+  {
+    if (!lane.isEmpty())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void SharedInstrument::recover()
+{
+  // note: reset first; an abort during recovery
+  // applies to the next command
+  _isAbortRequested = false;
+  _aborts++;
+
+  // discard pending responses
+  // note: first; device clear also discards
+  // commands in the instrument input buffer
+  if (!_instrument->clear())
+  {
+    // error
+    _errors++;
+  }
+
+  // then send urgent writes right away
+  auto& urgent = _lanes[std::size_t(Lane::Urgent)];
+  std::string batch;
+  Command command;
+  while (urgent.front() != nullptr && urgent.front()->type == Type::Write)
+  {
+    urgent.tryPop(&command);
+    _commands++;
+    batch += command.message;
+  }
+  if (!batch.empty())
+  {
+    _busWrites++;
+    if (!_instrument->writeData(uchar_p(batch.data()), batch.size()))
+    {
+      // error
+      _errors++;
+    }
+  }
+}
+
+
+void SharedInstrument::execute(MpscQueue<Command>& lane, Command& command)
+{
+  // batch adjacent writes,
+  // and the query that follows them
+  std::string batch = std::move(command.message);
+  while (command.type == Type::Write)
+  {
+    const Command* next = lane.front();
+    if (next == nullptr || next->type == Type::Task
+        || batch.size() + next->message.size() > MAX_BATCH_SIZE_B)
+    {
+      break;
+    }
+    lane.tryPop(&command);
+    _commands++;
+    batch += command.message;
+  }
+
+  // write
+  _busWrites++;
+  std::size_t write_size;
+  const bool is_written = _instrument->writeData(uchar_p(batch.data()), batch.size(), &write_size)
+                          && write_size == batch.size();
+  if (!is_written)
+  {
+    // error
+    _errors++;
+  }
+
+  // read
+  if (command.type == Type::Query)
+  {
+    std::string response = is_written? _instrument->read() : std::string();
+    if (is_written && response.empty())
+    {
+      // error
+      _errors++;
+    }
+    command.response->set_value(std::move(response));
+    command.response.reset();
+  }
+}
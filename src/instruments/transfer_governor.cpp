@@ -0,0 +1,226 @@
+/**
+ * \file transfer_governor.cpp
+ * \brief rohdeschwarz::instruments::TransferGovernor implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/transfer_governor.hpp"
+using namespace rohdeschwarz::instruments;
+
+
+// std lib
+#include <algorithm>
+#include <utility>
+
+
+// grant
+
+TransferGovernor::Grant::Grant() :
+  _governor(nullptr),
+  _size_B(0)
+{
+  // no operations
+}
+
+
+TransferGovernor::Grant::Grant(TransferGovernor* governor, std::size_t size_B) :
+  _governor(governor),
+  _size_B(size_B)
+{
+  // no operations
+}
+
+
+TransferGovernor::Grant::Grant(Grant&& other) :
+  _governor(std::exchange(other._governor, nullptr)),
+  _size_B(std::exchange(other._size_B, 0))
+{
+  // no operations
+}
+
+
+TransferGovernor::Grant& TransferGovernor::Grant::operator=(Grant&& other)
+{
+  if (this != &other)
+  {
+    release();
+    _governor = std::exchange(other._governor, nullptr);
+    _size_B   = std::exchange(other._size_B, 0);
+  }
+  return *this;
+}
+
+
+TransferGovernor::Grant::~Grant()
+{
+  release();
+}
+
+
+void TransferGovernor::Grant::release()
+{
+  if (_governor == nullptr)
+  {
+    return;
+  }
+  _governor->release(_size_B);
+  _governor = nullptr;
+  _size_B   = 0;
+}
+
+
+// governor
+
+TransferGovernor::TransferGovernor(std::size_t budget_B, std::size_t bypass_B) :
+  _budget_B(budget_B),
+  _bypass_B(bypass_B),
+  _inFlight_B(0),
+  _peakInFlight_B(0),
+  _grants(0),
+  _waited(0),
+  _bypassed(0)
+{
+  // no operations
+}
+
+
+std::size_t TransferGovernor::budget_B() const
+{
+  return _budget_B;
+}
+
+
+std::size_t TransferGovernor::bypass_B() const
+{
+  return _bypass_B;
+}
+
+
+TransferGovernor::Grant TransferGovernor::acquire(const Instrument* instrument, std::size_t size_B)
+{
+  if (size_B <= _bypass_B)
+  {
+    // not governed
+    _bypassed++;
+    return Grant();
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _grants++;
+
+  // note: wait behind transfers that are already waiting
+  if (_turns.empty() && fits(size_B))
+  {
+    grant(size_B);
+    return Grant(this, size_B);
+  }
+
+  // queue, and wait for turn
+  _waited++;
+  Ticket ticket = {size_B, false};
+  auto& queue = _queues[instrument];
+  if (queue.empty())
+  {
+    _turns.push_back(instrument);
+  }
+  queue.push_back(&ticket);
+  dispatch();
+  _condition.wait(lock, [&ticket]()
+  {
+    return ticket.isGranted;
+  });
+  return Grant(this, size_B);
+}
+
+
+std::size_t TransferGovernor::inFlight_B() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _inFlight_B;
+}
+
+
+std::size_t TransferGovernor::peakInFlight_B() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _peakInFlight_B;
+}
+
+
+std::size_t TransferGovernor::grants() const
+{
+  return _grants;
+}
+
+
+std::size_t TransferGovernor::waited() const
+{
+  return _waited;
+}
+
+
+std::size_t TransferGovernor::bypassed() const
+{
+  return _bypassed;
+}
+
+
+bool TransferGovernor::fits(std::size_t size_B) const
+{
+  // note: a transfer larger than the budget
+  // is granted alone
+  return _inFlight_B == 0 || _inFlight_B + size_B <= _budget_B;
+}
+
+
+void TransferGovernor::grant(std::size_t size_B)
+{
+  _inFlight_B    += size_B;
+  _peakInFlight_B = std::max(_peakInFlight_B, _inFlight_B);
+}
+
+
+void TransferGovernor::dispatch()
+{
+  // round robin of instruments; the next transfer
+  // waits for budget rather than being overtaken
+  bool is_granted = false;
+  while (!_turns.empty())
+  {
+    const Instrument* instrument = _turns.front();
+    auto queue = _queues.find(instrument);
+    Ticket* ticket = queue->second.front();
+    if (!fits(ticket->size_B))
+    {
+      break;
+    }
+
+    grant(ticket->size_B);
+    ticket->isGranted = true;
+    is_granted = true;
+    queue->second.pop_front();
+    _turns.pop_front();
+    if (queue->second.empty())
+    {
+      _queues.erase(queue);
+    }
+    else
+    {
+      _turns.push_back(instrument);
+    }
+  }
+
+  if (is_granted)
+  {
+    _condition.notify_all();
+  }
+}
+
+
+void TransferGovernor::release(std::size_t size_B)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _inFlight_B -= size_B;
+  dispatch();
+}
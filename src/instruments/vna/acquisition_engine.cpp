@@ -0,0 +1,197 @@
+/**
+ * \file acquisition_engine.cpp
+ * \brief rohdeschwarz::instruments::vna::AcquisitionEngine implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/acquisition_engine.hpp"
+#include "rohdeschwarz/instruments/vna/vna.hpp"
+using namespace rohdeschwarz;
+using namespace rohdeschwarz::instruments::vna;
+
+
+// std lib
+#include <utility>
+
+
+// constants
+const auto POLL_INTERVAL = std::chrono::microseconds(100);
+
+
+// types
+using clock_type = std::chrono::steady_clock;
+
+
+AcquisitionEngine::AcquisitionEngine(Vna* vna, unsigned int channel, std::vector<std::string> traces,
+                                     std::size_t slots, OverflowPolicy policy) :
+  _vna(vna),
+  _channel(channel),
+  _traces(std::move(traces)),
+  _slots(slots),
+  _policy(policy),
+  _scratch{0, clock_type::time_point(), TraceData()},
+  _isRunning(false),
+  _isStopRequested(false),
+  _isError(false),
+  _sweeps(0),
+  _dropped(0)
+{
+  // no operations
+}
+
+
+AcquisitionEngine::~AcquisitionEngine()
+{
+  stop();
+}
+
+
+bool AcquisitionEngine::start()
+{
+  if (_isRunning)
+  {
+    // already running
+    return false;
+  }
+
+  // join thread that exited on error
+  if (_thread.joinable())
+  {
+    _thread.join();
+  }
+
+  // preallocate slots
+  Channel channel = _vna->channel(_channel);
+  const std::size_t points = channel.points();
+  const std::vector<std::size_t> trace_points(_traces.size(), points);
+  _scratch = Sweep{0, clock_type::time_point(), TraceData(_traces, trace_points)};
+  _ring.reset(new SpscRing<Sweep>(_slots, _scratch));
+
+  // prime sweep timing cache
+  channel.sweepTiming();
+
+  // start
+  _isStopRequested = false;
+  _isError         = false;
+  _sweeps          = 0;
+  _dropped         = 0;
+  _isRunning       = true;
+  _thread = std::thread(&AcquisitionEngine::run, this);
+  return true;
+}
+
+
+void AcquisitionEngine::stop()
+{
+  _isStopRequested = true;
+  if (_thread.joinable())
+  {
+    _thread.join();
+  }
+  _isRunning = false;
+}
+
+
+bool AcquisitionEngine::isRunning() const
+{
+  return _isRunning;
+}
+
+
+bool AcquisitionEngine::isError() const
+{
+  return _isError;
+}
+
+
+const Sweep* AcquisitionEngine::tryRead()
+{
+  if (!_ring)
+  {
+    return nullptr;
+  }
+  return _ring->beginRead();
+}
+
+
+const Sweep* AcquisitionEngine::read(unsigned int timeout_ms)
+{
+  const auto deadline = clock_type::now() + std::chrono::milliseconds(timeout_ms);
+  while (true)
+  {
+    const Sweep* sweep = tryRead();
+    if (sweep != nullptr)
+    {
+      return sweep;
+    }
+    if (!_isRunning || clock_type::now() >= deadline)
+    {
+      // stopped, or timeout
+      return nullptr;
+    }
+    std::this_thread::sleep_for(POLL_INTERVAL);
+  }
+}
+
+
+void AcquisitionEngine::release()
+{
+  _ring->endRead();
+}
+
+
+std::size_t AcquisitionEngine::sweeps() const
+{
+  return _sweeps;
+}
+
+
+std::size_t AcquisitionEngine::dropped() const
+{
+  return _dropped;
+}
+
+
+void AcquisitionEngine::run()
+{
+  Channel channel = _vna->channel(_channel);
+  std::size_t sequence = 0;
+  while (!_isStopRequested)
+  {
+    // next free slot
+    Sweep* slot = _ring->beginWrite();
+    if (slot == nullptr)
+    {
+      if (_policy == OverflowPolicy::Block)
+      {
+        // backpressure: wait for consumer
+        std::this_thread::sleep_for(POLL_INTERVAL);
+        continue;
+      }
+
+      // sweep into scratch; drop
+      slot = &_scratch;
+    }
+
+    // sweep, fetch
+    if (!channel.acquire(_traces, &slot->data))
+    {
+      // error
+      _isError = true;
+      break;
+    }
+    slot->sequence = sequence++;
+    slot->time     = clock_type::now();
+
+    // publish
+    if (slot == &_scratch)
+    {
+      _dropped++;
+      continue;
+    }
+    _ring->commitWrite();
+    _sweeps++;
+  }
+  _isRunning = false;
+}
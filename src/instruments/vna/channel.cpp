@@ -5,12 +5,38 @@
 
 
 // rohdeschwarz
+#include "rohdeschwarz/instruments/preserve_timeout.hpp"
+#include "rohdeschwarz/instruments/profiler.hpp"
 #include "rohdeschwarz/instruments/vna/channel.hpp"
 #include "rohdeschwarz/instruments/vna/preserve_data_format.hpp"
+#include "rohdeschwarz/instruments/vna/s_parameter_matrix.hpp"
+#include "rohdeschwarz/instruments/vna/trace_data.hpp"
 #include "rohdeschwarz/instruments/vna/vna.hpp"
+#include "rohdeschwarz/scpi/bool.hpp"
+#include "rohdeschwarz/scpi/schema.hpp"
+#include "rohdeschwarz/helpers.hpp"
+#include "rohdeschwarz/to_value.hpp"
 #include "rohdeschwarz/to_vector.hpp"
 using namespace rohdeschwarz;
+using namespace rohdeschwarz::instruments;
 using namespace rohdeschwarz::instruments::vna;
+using namespace rohdeschwarz::scpi;
+
+
+// std lib
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+
+// constants
+const double ACQUIRE_TIMEOUT_FACTOR    = 1.5;
+const int    ACQUIRE_TIMEOUT_MARGIN_ms = 500;
+
+
+// types
+using ConfigurationSchema = Schema<unsigned int, double, double>;
+using SweepTimingSchema   = Schema<double, unsigned int, bool, unsigned int>;
 
 
 Channel::Channel(Vna *znx, unsigned int index) :
@@ -37,6 +63,7 @@ unsigned int Channel::points()
 void Channel::setPoints(unsigned int points)
 {
   _vna->write(":SENS%1%:SWE:POIN %2%", index(), points);
+  _vna->clearSweepTimingCache(_index);
 }
 
 
@@ -49,6 +76,7 @@ double Channel::startFrequency_Hz()
 void Channel::setStartFrequency(double frequency_Hz)
 {
   _vna->write(":SENS%1%:FREQ:STAR %2%", _index, frequency_Hz);
+  _vna->clearSweepTimingCache(_index);
 }
 
 
@@ -61,11 +89,14 @@ double Channel::stopFrequency_Hz()
 void Channel::setStopFrequency(double frequency_Hz)
 {
   _vna->write(":SENS%1%:FREQ:STOP %2%", _index, frequency_Hz);
+  _vna->clearSweepTimingCache(_index);
 }
 
 
 std::vector<double> Channel::frequencies_Hz()
 {
+  ProfileScope profile(_vna, "Channel::frequencies_Hz");
+
   // set data format to binary 64-bit, little-endian
   PreserveDataFormat preserve_data_format(_vna);
   DataFormat format = _vna->dataFormat();
@@ -82,3 +113,291 @@ std::vector<double> Channel::frequencies_Hz()
   // read
   return _vna->read64BitVector();
 }
+
+
+ChannelConfiguration Channel::configuration()
+{
+  const auto [points, start_Hz, stop_Hz] = _vna->queryValues<ConfigurationSchema>(
+    ":SENS%1%:SWE:POIN?;:SENS%1%:FREQ:STAR?;:SENS%1%:FREQ:STOP?",
+    _index
+  );
+  return {points, start_Hz, stop_Hz};
+}
+
+
+double Channel::sweepTime_s()
+{
+  return to_value<double>(_vna->query(":SENS%1%:SWE:TIME?", _index));
+}
+
+
+void Channel::setSweepTime(double time_s)
+{
+  _vna->write(":SENS%1%:SWE:TIME %2%", _index, time_s);
+  _vna->clearSweepTimingCache(_index);
+}
+
+
+unsigned int Channel::sweepCount()
+{
+  return to_value<unsigned int>(_vna->query(":SENS%1%:SWE:COUN?", _index));
+}
+
+
+void Channel::setSweepCount(unsigned int count)
+{
+  _vna->write(":SENS%1%:SWE:COUN %2%", _index, count);
+  _vna->clearSweepTimingCache(_index);
+}
+
+
+bool Channel::isAveraging()
+{
+  return _vna->queryScpiBool(":SENS%1%:AVER?", _index);
+}
+
+
+void Channel::setAveraging(bool isAveraging)
+{
+  _vna->write(":SENS%1%:AVER %2%", _index, toScpi(isAveraging));
+  _vna->clearSweepTimingCache(_index);
+}
+
+
+unsigned int Channel::averageCount()
+{
+  return to_value<unsigned int>(_vna->query(":SENS%1%:AVER:COUN?", _index));
+}
+
+
+void Channel::setAverageCount(unsigned int count)
+{
+  _vna->write(":SENS%1%:AVER:COUN %2%", _index, count);
+  _vna->clearSweepTimingCache(_index);
+}
+
+
+SweepTiming Channel::sweepTiming()
+{
+  SweepTiming timing;
+  if (_vna->cachedSweepTiming(_index, &timing))
+  {
+    return timing;
+  }
+
+  // query
+  const auto [sweep_time_s, sweep_count, is_averaging, average_count]
+    = _vna->queryValues<SweepTimingSchema>(
+      ":SENS%1%:SWE:TIME?;:SENS%1%:SWE:COUN?;:SENS%1%:AVER?;:SENS%1%:AVER:COUN?",
+      _index
+    );
+
+  // note: an averaging sweep group lasts at least `average_count` sweeps
+  timing.sweepTime_s = sweep_time_s;
+  timing.sweeps      = std::max(sweep_count, is_averaging ? average_count : 1u);
+  timing.sweeps      = std::max(timing.sweeps, 1u);
+  _vna->cacheSweepTiming(_index, timing);
+  return timing;
+}
+
+
+bool Channel::startSweep()
+{
+  return _vna->startSweep(_index);
+}
+
+
+bool Channel::waitForSweep()
+{
+  return _vna->waitForSweep(_index);
+}
+
+
+bool Channel::sweep()
+{
+  return startSweep() && waitForSweep();
+}
+
+
+std::vector<std::vector<std::complex<double>>> Channel::acquire(const std::vector<std::string>& traces)
+{
+  using data_type = std::vector<std::vector<std::complex<double>>>;
+
+  // sweep, query
+  PreserveDataFormat preserve_data_format(_vna);
+  PreserveTimeout    preserve_timeout(_vna);
+  if (!writeAcquire(traces))
+  {
+    // error
+    return data_type();
+  }
+
+  // read blocks
+  data_type data;
+  data.reserve(traces.size());
+  for (std::size_t i = 0; i < traces.size(); i++)
+  {
+    BlockData block = _vna->readBlockData();
+    if (!block.isComplete())
+    {
+      // error; discard remaining blocks
+      _vna->clear();
+      return data_type();
+    }
+    data.push_back(to_vector_complex_double(block.data(), block.size()));
+  }
+  return data;
+}
+
+
+bool Channel::acquire(const std::vector<std::string>& traces, TraceData* data)
+{
+  if (data->traces() != traces.size())
+  {
+    // error: data not shaped for traces
+    return false;
+  }
+
+  // sweep, query
+  PreserveDataFormat preserve_data_format(_vna);
+  PreserveTimeout    preserve_timeout(_vna);
+  if (!writeAcquire(traces))
+  {
+    // error
+    return false;
+  }
+
+  // read blocks directly into rows
+  for (std::size_t i = 0; i < traces.size(); i++)
+  {
+    std::size_t size_B;
+    if (!_vna->readBlockDataHeader(&size_B) || size_B != data->points(i) * sizeof(std::complex<double>))
+    {
+      // error; discard remaining blocks
+      _vna->clear();
+      return false;
+    }
+    using uchar_p = unsigned char*;
+    if (!_vna->readBlockDataPayload(uchar_p(data->row(i)), size_B))
+    {
+      // error; discard remaining blocks
+      _vna->clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+
+TraceData Channel::allTraceData()
+{
+  return _vna->allTraceData({_index});
+}
+
+
+SParameterMatrix Channel::sParameterMatrix(const std::vector<unsigned int>& ports)
+{
+  if (ports.empty())
+  {
+    return SParameterMatrix();
+  }
+
+  PreserveDataFormat preserve_data_format(_vna);
+
+  // previous group, format, define group, points, data
+  // note: the previous group is queried
+  // in the same round trip, before it is replaced
+  std::ostringstream message;
+  message << ":CALC" << _index << ":PAR:DEF:SGR?;:FORM REAL,64;:FORM:BORD SWAP;:CALC" << _index << ":PAR:DEF:SGR ";
+  for (std::size_t i = 0; i < ports.size(); i++)
+  {
+    message << (i ? "," : "") << ports[i];
+  }
+  message << ";:SENS" << _index << ":SWE:POIN?;:CALC" << _index << ":DATA:SGR? SDAT";
+  if (!_vna->write("%1%", message.str()))
+  {
+    // error
+    return SParameterMatrix();
+  }
+
+  // read previous group, points
+  const std::string previous_group = trim(_vna->readNextResponse());
+  std::size_t points;
+  try
+  {
+    points = to_value<unsigned int>(trimView(_vna->readNextResponse()));
+  }
+  catch (const std::invalid_argument&)
+  {
+    // error; discard block
+    _vna->clear();
+    restoreSParameterGroup(previous_group);
+    return SParameterMatrix();
+  }
+
+  // read block, S-parameter major: S11[points], S12[points], ...
+  const std::size_t n = ports.size();
+  std::size_t size_B;
+  if (!_vna->readBlockDataHeader(&size_B) || size_B != n * n * points * sizeof(std::complex<double>))
+  {
+    // error; discard block
+    _vna->clear();
+    restoreSParameterGroup(previous_group);
+    return SParameterMatrix();
+  }
+  std::vector<std::complex<double>> block(n * n * points);
+  using uchar_p = unsigned char*;
+  if (!_vna->readBlockDataPayload(uchar_p(block.data()), size_B))
+  {
+    // error; discard block
+    _vna->clear();
+    restoreSParameterGroup(previous_group);
+    return SParameterMatrix();
+  }
+  restoreSParameterGroup(previous_group);
+
+  // transpose to [point][i][j]
+  SParameterMatrix matrix(ports, points);
+  for (std::size_t parameter = 0; parameter < n * n; parameter++)
+  {
+    const std::complex<double>* source = block.data() + parameter * points;
+    std::complex<double>* destination  = matrix.data() + parameter;
+    for (std::size_t point = 0; point < points; point++)
+    {
+      destination[point * matrix.pointStride()] = source[point];
+    }
+  }
+  return matrix;
+}
+
+
+bool Channel::writeAcquire(const std::vector<std::string>& traces)
+{
+  // extend timeout to cover sweep
+  const double sweep_ms = 1000 * sweepTiming().duration_s();
+  const int timeout_ms  = int(ACQUIRE_TIMEOUT_FACTOR * sweep_ms) + ACQUIRE_TIMEOUT_MARGIN_ms;
+  if (timeout_ms > _vna->timeout_ms())
+  {
+    _vna->setTimeout(timeout_ms);
+  }
+
+  // format, sweep, wait, query
+  std::ostringstream message;
+  message << ":FORM REAL,64;:FORM:BORD SWAP;:INIT" << _index << ":IMM;*WAI";
+  for (const std::string& trace : traces)
+  {
+    message << ";:CALC" << _index << ":DATA:TRAC? \'" << trace << "\',SDAT";
+  }
+  return _vna->write("%1%", message.str());
+}
+
+
+void Channel::restoreSParameterGroup(const std::string& ports)
+{
+  if (ports.empty())
+  {
+    _vna->write(":CALC%1%:PAR:DEL:SGR", _index);
+    return;
+  }
+  _vna->write(":CALC%1%:PAR:DEF:SGR %2%", _index, ports);
+}
@@ -0,0 +1,52 @@
+/**
+ * \file complex_data.cpp
+ * \brief rohdeschwarz::instruments::vna::ComplexData implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/complex_data.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+ComplexData::ComplexData()
+{
+  // no operations
+}
+
+
+ComplexData::ComplexData(std::size_t size) :
+  _data(size)
+{
+  // no operations
+}
+
+
+bool ComplexData::isEmpty() const
+{
+  return _data.empty();
+}
+
+
+std::complex<double>* ComplexData::data()
+{
+  return _data.data();
+}
+
+
+const std::complex<double>* ComplexData::data() const
+{
+  return _data.data();
+}
+
+
+std::size_t ComplexData::size() const
+{
+  return _data.size();
+}
+
+
+std::size_t ComplexData::size_B() const
+{
+  return _data.size() * sizeof(std::complex<double>);
+}
@@ -0,0 +1,421 @@
+/**
+ * \file job_scheduler.cpp
+ * \brief rohdeschwarz::instruments::vna::JobScheduler implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/job_scheduler.hpp"
+#include "rohdeschwarz/instruments/vna/vna.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+// std lib
+#include <exception>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+
+JobScheduler::JobScheduler(std::vector<Vna*> vnas) :
+  _start(clock_type::now()),
+  _queued(0),
+  _stealable(0),
+  _unfinished(0),
+  _isStopRequested(false),
+  _isRunning(true)
+{
+  for (Vna* vna : vnas)
+  {
+    _workers.push_back(std::make_unique<Worker>());
+    _workers.back()->vna = vna;
+  }
+
+  // note: start after all workers exist;
+  // workers steal from each other
+  for (auto& worker : _workers)
+  {
+    worker->thread = std::thread(&JobScheduler::run, this, std::ref(*worker));
+  }
+}
+
+
+JobScheduler::~JobScheduler()
+{
+  stop();
+}
+
+
+void JobScheduler::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_isRunning)
+    {
+      return;
+    }
+    _isStopRequested = true;
+    notifyAll();
+  }
+  for (auto& worker : _workers)
+  {
+    worker->thread.join();
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  _isRunning = false;
+}
+
+
+std::future<bool> JobScheduler::submit(std::string setup, Function configure, Function job)
+{
+  Job queued;
+  queued.setup     = std::move(setup);
+  queued.configure = std::move(configure);
+  queued.function  = std::move(job);
+  queued.result    = std::make_shared<std::promise<bool>>();
+  auto result = queued.result->get_future();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_isStopRequested || _workers.empty())
+    {
+      // stopped
+      queued.result->set_value(false);
+      return result;
+    }
+    _queued++;
+    _unfinished++;
+  }
+
+  // queue
+  Worker& worker = route(queued.setup);
+  bool is_busy;
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.jobs.push_back(std::move(queued));
+    is_busy = worker.isBusy;
+  }
+
+  // wake the selected worker if idle;
+  // otherwise an idle worker steals
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (is_busy)
+  {
+    notifyThief(worker);
+  }
+  else
+  {
+    notify(worker);
+  }
+  return result;
+}
+
+
+std::future<bool> JobScheduler::submit(Function job)
+{
+  return submit(std::string(), Function(), std::move(job));
+}
+
+
+void JobScheduler::wait()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _done.wait(lock, [this]()
+  {
+    return _unfinished == 0;
+  });
+}
+
+
+std::size_t JobScheduler::size() const
+{
+  return _workers.size();
+}
+
+
+InstrumentUtilization JobScheduler::utilization(std::size_t index) const
+{
+  const Worker& worker = *_workers.at(index);
+  const double elapsed_s = std::chrono::duration<double>(clock_type::now() - _start).count();
+
+  InstrumentUtilization utilization;
+  utilization.jobs             = worker.executed;
+  utilization.reconfigurations = worker.reconfigurations;
+  utilization.steals           = worker.steals;
+  utilization.busy_s           = worker.busy_ns / 1e9;
+  utilization.utilization      = elapsed_s > 0? utilization.busy_s / elapsed_s : 0;
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  utilization.setup = worker.setup;
+  return utilization;
+}
+
+
+JobScheduler::Worker& JobScheduler::route(const std::string& setup)
+{
+  // rank: idle with setup, with setup after queued jobs,
+  // idle, any; then queue length
+  // note: queues are balanced by stealing
+  Worker*                      selected = nullptr;
+  std::tuple<int, std::size_t> selected_rank;
+  for (auto& worker : _workers)
+  {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    std::string next_setup = worker->setup;
+    for (const Job& job : worker->jobs)
+    {
+      if (!job.setup.empty())
+      {
+        next_setup = job.setup;
+      }
+    }
+    const bool is_idle  = !worker->isBusy && worker->jobs.empty();
+    const bool is_setup = !setup.empty() && next_setup == setup;
+    const int  rank     = is_setup? (is_idle? 0 : 1) : (is_idle? 2 : 3);
+    const auto queue    = worker->jobs.size() + (worker->isBusy? 1 : 0);
+    if (selected == nullptr || std::make_tuple(rank, queue) < selected_rank)
+    {
+      selected      = worker.get();
+      selected_rank = std::make_tuple(rank, queue);
+    }
+  }
+  return *selected;
+}
+
+
+void JobScheduler::run(Worker& worker)
+{
+  while (true)
+  {
+    // note: jobs that become stealable
+    // from here on keep this worker awake
+    std::size_t stealable;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      stealable = _stealable;
+    }
+
+    Job job;
+    if (pop(worker, &job) || steal(worker, &job))
+    {
+      execute(worker, job);
+      continue;
+    }
+
+    // idle
+    {
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.isBusy = false;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    worker.isSleeping = true;
+    worker.condition.wait(lock, [this, &worker, stealable]()
+    {
+      return worker.isWakeRequested || _stealable != stealable
+          || (_isStopRequested && _queued == 0);
+    });
+    worker.isSleeping      = false;
+    worker.isWakeRequested = false;
+    if (_isStopRequested && _queued == 0)
+    {
+      // done
+      return;
+    }
+  }
+}
+
+
+bool JobScheduler::pop(Worker& worker, Job* job)
+{
+  bool is_stealable;
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.jobs.empty())
+    {
+      return false;
+    }
+    *job = std::move(worker.jobs.front());
+    worker.jobs.pop_front();
+    worker.isBusy = true;
+    is_stealable  = !worker.jobs.empty();
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  _queued--;
+  if (is_stealable)
+  {
+    // note: jobs of a busy worker can be stolen
+    notifyThief(worker);
+  }
+  if (_queued == 0 && _isStopRequested)
+  {
+    notifyAll();
+  }
+  return true;
+}
+
+
+bool JobScheduler::steal(Worker& worker, Job* job)
+{
+  std::string setup;
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    setup = worker.setup;
+  }
+
+  // note: jobs of idle workers are left to them;
+  // they are awake, or about to be
+  bool is_stolen = false;
+
+  // a job for this setup, or for any setup
+  for (auto& victim : _workers)
+  {
+    if (victim.get() == &worker)
+    {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(victim->mutex);
+    if (!victim->isBusy)
+    {
+      continue;
+    }
+    for (auto i = victim->jobs.rbegin(); i != victim->jobs.rend(); i++)
+    {
+      if (i->setup.empty() || (!setup.empty() && i->setup == setup))
+      {
+        *job = std::move(*i);
+        victim->jobs.erase(std::next(i).base());
+        is_stolen = true;
+        break;
+      }
+    }
+    if (is_stolen)
+    {
+      break;
+    }
+  }
+
+  // newest job of the longest queue
+  while (!is_stolen)
+  {
+    Worker* longest = nullptr;
+    std::size_t longest_size = 0;
+    for (auto& victim : _workers)
+    {
+      if (victim.get() == &worker)
+      {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(victim->mutex);
+      if (victim->isBusy && victim->jobs.size() > longest_size)
+      {
+        longest      = victim.get();
+        longest_size = victim->jobs.size();
+      }
+    }
+    if (longest == nullptr)
+    {
+      // nothing to steal
+      return false;
+    }
+
+    // note: may have changed since
+    std::lock_guard<std::mutex> lock(longest->mutex);
+    if (longest->isBusy && !longest->jobs.empty())
+    {
+      *job = std::move(longest->jobs.back());
+      longest->jobs.pop_back();
+      is_stolen = true;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.isBusy = true;
+  }
+  worker.steals++;
+  std::lock_guard<std::mutex> lock(_mutex);
+  _queued--;
+  if (_queued == 0 && _isStopRequested)
+  {
+    notifyAll();
+  }
+  return true;
+}
+
+
+void JobScheduler::execute(Worker& worker, Job& job)
+{
+  const auto start = clock_type::now();
+
+  // note: exceptions are forwarded to the future;
+  // the worker and the bookkeeping carry on
+  try
+  {
+    // configure?
+    bool is_configured = true;
+    if (!job.setup.empty())
+    {
+      std::unique_lock<std::mutex> lock(worker.mutex);
+      if (worker.setup != job.setup)
+      {
+        // note: setup is unknown until configured
+        worker.setup.clear();
+        lock.unlock();
+        worker.reconfigurations++;
+        is_configured = job.configure && job.configure(*worker.vna);
+        if (is_configured)
+        {
+          lock.lock();
+          worker.setup = job.setup;
+        }
+      }
+    }
+
+    // run
+    job.result->set_value(is_configured && job.function && job.function(*worker.vna));
+  }
+  catch (...)
+  {
+    job.result->set_exception(std::current_exception());
+  }
+  const auto elapsed = clock_type::now() - start;
+  worker.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  worker.executed++;
+
+  // complete
+  std::lock_guard<std::mutex> lock(_mutex);
+  _unfinished--;
+  if (_unfinished == 0)
+  {
+    _done.notify_all();
+  }
+}
+
+
+void JobScheduler::notify(Worker& worker)
+{
+  worker.isWakeRequested = true;
+  worker.condition.notify_one();
+}
+
+
+void JobScheduler::notifyThief(const Worker& owner)
+{
+  // note: workers about to sleep see the change
+  _stealable++;
+  for (auto& worker : _workers)
+  {
+    if (worker.get() != &owner && worker->isSleeping && !worker->isWakeRequested)
+    {
+      notify(*worker);
+      return;
+    }
+  }
+}
+
+
+void JobScheduler::notifyAll()
+{
+  for (auto& worker : _workers)
+  {
+    notify(*worker);
+  }
+}
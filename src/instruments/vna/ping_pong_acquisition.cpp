@@ -0,0 +1,140 @@
+/**
+ * \file ping_pong_acquisition.cpp
+ * \brief rohdeschwarz::instruments::vna::PingPongAcquisition implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/ping_pong_acquisition.hpp"
+#include "rohdeschwarz/instruments/vna/vna.hpp"
+#include "rohdeschwarz/scpi/bool.hpp"
+#include "rohdeschwarz/scpi/schema.hpp"
+using namespace rohdeschwarz::instruments::vna;
+using namespace rohdeschwarz::scpi;
+
+
+// std lib
+#include <tuple>
+
+
+// types
+using SweepModeSchema = Schema<bool, std::string>;
+
+
+PingPongAcquisition::PingPongAcquisition(Vna* vna, unsigned int channelA, unsigned int channelB) :
+  _vna(vna),
+  _channels{channelA, channelB},
+  _sweeping(0),
+  _isStarted(false),
+  _sweeps(0),
+  _isSweepModeSaved(false),
+  _isContinuous(false)
+{
+  // no operations
+}
+
+
+PingPongAcquisition::~PingPongAcquisition()
+{
+  stop();
+}
+
+
+bool PingPongAcquisition::start()
+{
+  // save sweep mode, unless already saved
+  // by a start without stop
+  if (!_isSweepModeSaved)
+  {
+    SweepModeSchema::value_type sweep_mode;
+    if (!SweepModeSchema::parse(_vna->query(":INIT:CONT:ALL?;:INIT:SCOP?"), &sweep_mode))
+    {
+      // error
+      return false;
+    }
+    std::tie(_isContinuous, _triggerScope) = sweep_mode;
+    _isSweepModeSaved = true;
+  }
+
+  // single sweep, per channel
+  if (!_vna->write(":INIT:CONT:ALL OFF;:INIT:SCOP SING"))
+  {
+    // error
+    return false;
+  }
+
+  // trigger first channel
+  _sweeping  = 0;
+  _sweeps    = 0;
+  _isStarted = _vna->startSweep(_channels[_sweeping]);
+  return _isStarted;
+}
+
+
+bool PingPongAcquisition::isStarted() const
+{
+  return _isStarted;
+}
+
+
+bool PingPongAcquisition::next(TraceData* data, unsigned int* channel)
+{
+  if (!_isStarted)
+  {
+    // error
+    return false;
+  }
+
+  // wait for sweeping channel
+  const unsigned int completed = _channels[_sweeping];
+  if (!_vna->waitForSweep(completed))
+  {
+    // error
+    _isStarted = false;
+    return false;
+  }
+  _sweeps++;
+
+  // swap; trigger other channel
+  _sweeping = 1 - _sweeping;
+  if (!_vna->startSweep(_channels[_sweeping]))
+  {
+    // error
+    _isStarted = false;
+    return false;
+  }
+
+  // read completed channel, while other channel sweeps
+  *data = _vna->allTraceData({completed});
+  if (channel != nullptr)
+  {
+    *channel = completed;
+  }
+  return !data->isEmpty();
+}
+
+
+bool PingPongAcquisition::stop()
+{
+  // wait for pending sweep
+  bool is_ok = true;
+  if (_isStarted)
+  {
+    _isStarted = false;
+    is_ok      = _vna->waitForSweep(_channels[_sweeping]);
+  }
+
+  // restore sweep mode
+  if (_isSweepModeSaved)
+  {
+    _isSweepModeSaved = false;
+    is_ok = _vna->write(":INIT:SCOP %1%;:INIT:CONT:ALL %2%", _triggerScope, toScpi(_isContinuous)) && is_ok;
+  }
+  return is_ok;
+}
+
+
+std::size_t PingPongAcquisition::sweeps() const
+{
+  return _sweeps;
+}
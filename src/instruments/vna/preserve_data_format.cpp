@@ -5,13 +5,40 @@
 
 
 // rohdeschwarz
+#include "rohdeschwarz/instruments/profiler.hpp"
+#include "rohdeschwarz/instruments/vna/mnemonics.hpp"
 #include "rohdeschwarz/instruments/vna/preserve_data_format.hpp"
+#include "rohdeschwarz/scpi/schema.hpp"
+using namespace rohdeschwarz::instruments;
 using namespace rohdeschwarz::instruments::vna;
+using namespace rohdeschwarz::scpi;
+
+
+// types
+using FormatSchema = Schema<Mnemonic<TransferFormats>, Mnemonic<ByteOrders>>;
 
 
 PreserveDataFormat::PreserveDataFormat(Vna *znx) :
-  _dataFormat(znx->dataFormat())
+  _dataFormat(znx),
+  _vna(znx)
 {
+  // note: all queries, including the fallback,
+  // are attributed to this scope
+  ProfileScope profile(_vna, "PreserveDataFormat::PreserveDataFormat");
+
+  // query format, byte order in one round trip
+  FormatSchema::value_type format;
+  if (FormatSchema::parse(znx->query(":FORM?;:FORM:BORD?"), &format))
+  {
+    const auto [transfer_format, byte_order] = format;
+    _isBinary    = transfer_format != TransferFormat::Ascii;
+    _is64Bit     = transfer_format == TransferFormat::Binary64Bit;
+    _isBigEndian = byte_order      == ByteOrder::BigEndian;
+    return;
+  }
+
+  // unexpected response;
+  // fall back to individual queries
   _isBinary    = !_dataFormat.isAscii();
   _is64Bit     = _dataFormat.isBinary64Bit();
   _isBigEndian = _dataFormat.isBigEndian();
@@ -20,6 +47,8 @@ PreserveDataFormat::PreserveDataFormat(Vna *znx) :
 
 PreserveDataFormat::~PreserveDataFormat()
 {
+  ProfileScope profile(_vna, "PreserveDataFormat::~PreserveDataFormat");
+
   if (!_isBinary)
   {
     // ascii
@@ -0,0 +1,77 @@
+/**
+ * \file s_parameter_matrix.cpp
+ * \brief rohdeschwarz::instruments::vna::SParameterMatrix implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/s_parameter_matrix.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+// std lib
+#include <utility>
+
+
+SParameterMatrix::SParameterMatrix() :
+  _points(0)
+{
+  // no operations
+}
+
+
+SParameterMatrix::SParameterMatrix(std::vector<unsigned int> ports, std::size_t points) :
+  ComplexData(points * ports.size() * ports.size()),
+  _ports(std::move(ports)),
+  _points(points)
+{
+  // no operations
+}
+
+
+const std::vector<unsigned int>& SParameterMatrix::ports() const
+{
+  return _ports;
+}
+
+
+std::size_t SParameterMatrix::points() const
+{
+  return _points;
+}
+
+
+std::size_t SParameterMatrix::pointStride() const
+{
+  return _ports.size() * _ports.size();
+}
+
+
+std::size_t SParameterMatrix::rowStride() const
+{
+  return _ports.size();
+}
+
+
+std::complex<double>* SParameterMatrix::matrix(std::size_t point)
+{
+  return data() + point * pointStride();
+}
+
+
+const std::complex<double>* SParameterMatrix::matrix(std::size_t point) const
+{
+  return data() + point * pointStride();
+}
+
+
+std::complex<double>& SParameterMatrix::operator()(std::size_t point, std::size_t i, std::size_t j)
+{
+  return data()[point * pointStride() + i * rowStride() + j];
+}
+
+
+const std::complex<double>& SParameterMatrix::operator()(std::size_t point, std::size_t i, std::size_t j) const
+{
+  return data()[point * pointStride() + i * rowStride() + j];
+}
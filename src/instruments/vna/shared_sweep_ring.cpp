@@ -0,0 +1,527 @@
+/**
+ * \file shared_sweep_ring.cpp
+ * \brief rohdeschwarz::instruments::vna::SharedSweepRingWriter and
+ * SharedSweepRingReader implementations
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/shared_sweep_ring.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// linux
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+
+// std lib
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+
+// constants
+const std::uint32_t MAGIC       = 0x52535352;  // "RSSR"
+const std::uint32_t VERSION     = 1;
+const std::size_t   NAME_SIZE_B = 64;
+const std::size_t   ALIGNMENT_B = 64;
+const auto          POLL_INTERVAL = std::chrono::microseconds(100);
+
+
+// types
+using clock_type = std::chrono::steady_clock;
+
+
+namespace
+{
+
+
+/**
+ * \brief Ring header, at the start of shared memory
+ *
+ * Followed by `traces` names of `NAME_SIZE_B` bytes each,
+ * then `slots` slots of `slotSize_B` bytes each.
+ */
+struct RingHeader
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint64_t slots;
+  std::uint64_t traces;
+  std::uint64_t points;
+  std::uint64_t slotSize_B;
+  std::uint64_t slotsOffset_B;
+
+  // note: separate cache lines for the publish counter and futex word
+  alignas(64) std::atomic<std::uint64_t> published;
+  alignas(64) std::atomic<std::uint32_t> futex;
+};
+
+
+/**
+ * \brief Slot header, followed by trace data
+ *
+ * `sequence` is a seqlock: odd while sweep `n` is written
+ * (`2n + 1`), then even (`2n + 2`) when complete.
+ */
+struct alignas(64) SlotHeader
+{
+  std::atomic<std::uint64_t> sequence;
+  std::int64_t               time_ns;
+  std::uint64_t              channel;
+  std::uint64_t              frequencyGridId;
+};
+
+
+std::size_t align(std::size_t size_B)
+{
+  return (size_B + ALIGNMENT_B - 1) / ALIGNMENT_B * ALIGNMENT_B;
+}
+
+
+RingHeader* ring_header(void* memory)
+{
+  return static_cast<RingHeader*>(memory);
+}
+
+
+SlotHeader* slot_header(void* memory, std::size_t sweep)
+{
+  RingHeader* header = ring_header(memory);
+  unsigned char* slots = static_cast<unsigned char*>(memory) + header->slotsOffset_B;
+  return reinterpret_cast<SlotHeader*>(slots + (sweep % header->slots) * header->slotSize_B);
+}
+
+
+/**
+ * \brief Checks that the layout in `header` fits in `size_B` bytes
+ *
+ * The header is written by another process; its values are
+ * checked without overflow before they are used as offsets.
+ */
+bool is_valid_layout(const RingHeader* header, std::size_t size_B)
+{
+  if (header->slots == 0 || header->traces == 0 || header->slotSize_B == 0)
+  {
+    return false;
+  }
+  if (header->slotsOffset_B % ALIGNMENT_B != 0 || header->slotSize_B % ALIGNMENT_B != 0)
+  {
+    // error: misaligned slot headers
+    return false;
+  }
+
+  // names
+  if (header->slotsOffset_B < sizeof(RingHeader) || header->slotsOffset_B > size_B
+      || header->traces > (header->slotsOffset_B - sizeof(RingHeader)) / NAME_SIZE_B)
+  {
+    return false;
+  }
+
+  // slots
+  if (header->slots > (size_B - header->slotsOffset_B) / header->slotSize_B)
+  {
+    return false;
+  }
+
+  // trace data, per slot
+  if (header->slotSize_B < sizeof(SlotHeader))
+  {
+    return false;
+  }
+  const std::size_t data_size_B = header->slotSize_B - sizeof(SlotHeader);
+  return header->points <= data_size_B / sizeof(std::complex<double>) / header->traces;
+}
+
+
+std::complex<double>* slot_data(SlotHeader* slot)
+{
+  return reinterpret_cast<std::complex<double>*>(reinterpret_cast<unsigned char*>(slot) + sizeof(SlotHeader));
+}
+
+
+void wake_readers(std::atomic<std::uint32_t>* futex)
+{
+  futex->fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(futex), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+
+void wait_for_writer(const std::atomic<std::uint32_t>* futex, std::uint32_t value, clock_type::duration timeout)
+{
+#ifdef __linux__
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+  timespec time_spec;
+  time_spec.tv_sec  = ns / 1000000000;
+  time_spec.tv_nsec = ns % 1000000000;
+  auto address = const_cast<std::uint32_t*>(reinterpret_cast<const std::uint32_t*>(futex));
+  syscall(SYS_futex, address, FUTEX_WAIT, value, &time_spec, nullptr, 0);
+#else
+  std::this_thread::sleep_for(std::min<clock_type::duration>(timeout, POLL_INTERVAL));
+#endif
+}
+
+
+}  // namespace
+
+
+SharedSweepRingWriter::SharedSweepRingWriter() :
+  _memory(nullptr),
+  _size_B(0),
+  _published(0)
+{
+  // no operations
+}
+
+
+SharedSweepRingWriter::~SharedSweepRingWriter()
+{
+  close();
+}
+
+
+bool SharedSweepRingWriter::create(const std::string& name, std::size_t slots,
+                                   const std::vector<std::string>& traces, std::size_t points)
+{
+  close();
+  if (slots == 0 || traces.empty())
+  {
+    // error
+    return false;
+  }
+
+  // layout
+  const std::size_t slots_offset = align(sizeof(RingHeader) + traces.size() * NAME_SIZE_B);
+  const std::size_t slot_size    = align(sizeof(SlotHeader) + traces.size() * points * sizeof(std::complex<double>));
+  const std::size_t size         = slots_offset + slots * slot_size;
+
+  // create, size
+  // note: fails if the ring exists; see remove
+  const int file = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (file < 0)
+  {
+    // error
+    return false;
+  }
+  if (ftruncate(file, off_t(size)) != 0)
+  {
+    // error
+    ::close(file);
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  // map
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  ::close(file);
+  if (memory == MAP_FAILED)
+  {
+    // error
+    shm_unlink(name.c_str());
+    return false;
+  }
+  _name       = name;
+  _memory     = memory;
+  _size_B     = size;
+  _published  = 0;
+
+  // names
+  unsigned char* names = static_cast<unsigned char*>(memory) + sizeof(RingHeader);
+  for (std::size_t i = 0; i < traces.size(); i++)
+  {
+    std::strncpy(reinterpret_cast<char*>(names + i * NAME_SIZE_B), traces[i].c_str(), NAME_SIZE_B - 1);
+  }
+
+  // slots
+  // note: memory from ftruncate is zero-initialized
+  RingHeader* header    = new (memory) RingHeader();
+  header->slots         = slots;
+  header->traces        = traces.size();
+  header->points        = points;
+  header->slotSize_B    = slot_size;
+  header->slotsOffset_B = slots_offset;
+  header->published.store(0, std::memory_order_relaxed);
+  header->futex.store(0, std::memory_order_relaxed);
+  for (std::size_t slot = 0; slot < slots; slot++)
+  {
+    new (slot_header(memory, slot)) SlotHeader();
+  }
+
+  // ready
+  header->version = VERSION;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic   = MAGIC;
+  return true;
+}
+
+
+bool SharedSweepRingWriter::remove(const std::string& name)
+{
+  return shm_unlink(name.c_str()) == 0;
+}
+
+
+bool SharedSweepRingWriter::isOpen() const
+{
+  return _memory != nullptr;
+}
+
+
+void SharedSweepRingWriter::close()
+{
+  if (!isOpen())
+  {
+    return;
+  }
+  munmap(_memory, _size_B);
+  shm_unlink(_name.c_str());
+  _memory = nullptr;
+  _size_B = 0;
+  _name.clear();
+}
+
+
+bool SharedSweepRingWriter::publish(const TraceData& data, unsigned int channel, std::size_t frequencyGridId)
+{
+  if (!isOpen())
+  {
+    // error
+    return false;
+  }
+  RingHeader* header = ring_header(_memory);
+  if (data.traces() != header->traces || data.size_B() != header->traces * header->points * sizeof(std::complex<double>))
+  {
+    // error: shape
+    return false;
+  }
+
+  // begin write
+  const std::uint64_t sweep = _published;
+  SlotHeader* slot = slot_header(_memory, sweep);
+  slot->sequence.store(2 * sweep + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // write
+  const auto now = clock_type::now().time_since_epoch();
+  slot->time_ns         = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+  slot->channel         = channel;
+  slot->frequencyGridId = frequencyGridId;
+  std::memcpy(slot_data(slot), data.data(), data.size_B());
+
+  // end write; publish
+  slot->sequence.store(2 * sweep + 2, std::memory_order_release);
+  header->published.store(sweep + 1, std::memory_order_release);
+  _published++;
+  wake_readers(&header->futex);
+  return true;
+}
+
+
+std::size_t SharedSweepRingWriter::published() const
+{
+  return _published;
+}
+
+
+SharedSweepRingReader::SharedSweepRingReader() :
+  _memory(nullptr),
+  _size_B(0)
+{
+  // no operations
+}
+
+
+SharedSweepRingReader::~SharedSweepRingReader()
+{
+  close();
+}
+
+
+bool SharedSweepRingReader::open(const std::string& name)
+{
+  close();
+
+  // open, get size
+  const int file = shm_open(name.c_str(), O_RDONLY, 0);
+  if (file < 0)
+  {
+    // error
+    return false;
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0 || std::size_t(status.st_size) < sizeof(RingHeader))
+  {
+    // error
+    ::close(file);
+    return false;
+  }
+
+  // map
+  const std::size_t size = std::size_t(status.st_size);
+  void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+  ::close(file);
+  if (memory == MAP_FAILED)
+  {
+    // error
+    return false;
+  }
+
+  // validate
+  const RingHeader* header = ring_header(memory);
+  if (header->magic != MAGIC || header->version != VERSION)
+  {
+    // error: not a ring, or not ready
+    munmap(memory, size);
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!is_valid_layout(header, size))
+  {
+    // error: truncated or corrupt
+    munmap(memory, size);
+    return false;
+  }
+  _memory = memory;
+  _size_B = size;
+
+  // names
+  const char* names = static_cast<const char*>(memory) + sizeof(RingHeader);
+  for (std::size_t i = 0; i < header->traces; i++)
+  {
+    const char* name = names + i * NAME_SIZE_B;
+    _names.emplace_back(name, strnlen(name, NAME_SIZE_B));
+  }
+  return true;
+}
+
+
+bool SharedSweepRingReader::isOpen() const
+{
+  return _memory != nullptr;
+}
+
+
+void SharedSweepRingReader::close()
+{
+  if (!isOpen())
+  {
+    return;
+  }
+  munmap(_memory, _size_B);
+  _memory = nullptr;
+  _size_B = 0;
+  _names.clear();
+}
+
+
+std::size_t SharedSweepRingReader::slots() const
+{
+  return ring_header(_memory)->slots;
+}
+
+
+std::size_t SharedSweepRingReader::points() const
+{
+  return ring_header(_memory)->points;
+}
+
+
+const std::vector<std::string>& SharedSweepRingReader::names() const
+{
+  return _names;
+}
+
+
+std::size_t SharedSweepRingReader::published() const
+{
+  return ring_header(_memory)->published.load(std::memory_order_acquire);
+}
+
+
+bool SharedSweepRingReader::wait(std::size_t sweep, unsigned int timeout_ms) const
+{
+  const RingHeader* header = ring_header(_memory);
+  const auto deadline = clock_type::now() + std::chrono::milliseconds(timeout_ms);
+  while (true)
+  {
+    // note: read futex word before checking, to not miss a wake-up
+    const std::uint32_t value = header->futex.load(std::memory_order_acquire);
+    if (published() > sweep)
+    {
+      return true;
+    }
+    const auto now = clock_type::now();
+    if (now >= deadline)
+    {
+      // timeout
+      return false;
+    }
+    wait_for_writer(&header->futex, value, deadline - now);
+  }
+}
+
+
+bool SharedSweepRingReader::view(std::size_t sweep, SharedSweepView* view) const
+{
+  const RingHeader* header = ring_header(_memory);
+  const std::size_t published = this->published();
+  if (sweep >= published || published - sweep > header->slots)
+  {
+    // not published, or overwritten
+    return false;
+  }
+
+  // read slot
+  SlotHeader* slot = slot_header(_memory, sweep);
+  const std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+  if (sequence != 2 * sweep + 2)
+  {
+    // being overwritten
+    return false;
+  }
+  view->sweep           = sweep;
+  view->time_ns         = slot->time_ns;
+  view->channel         = unsigned(slot->channel);
+  view->frequencyGridId = slot->frequencyGridId;
+  view->names           = &_names;
+  view->data            = slot_data(slot);
+  view->points          = header->points;
+  view->sequence        = sequence;
+  return isValid(*view);
+}
+
+
+bool SharedSweepRingReader::isValid(const SharedSweepView& view) const
+{
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot_header(_memory, view.sweep)->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+
+bool SharedSweepRingReader::copy(std::size_t sweep, TraceData* data) const
+{
+  SharedSweepView view;
+  if (!this->view(sweep, &view) || data->size_B() != _names.size() * view.points * sizeof(std::complex<double>))
+  {
+    // error
+    return false;
+  }
+  std::memcpy(data->data(), view.data, data->size_B());
+  return isValid(view);
+}
@@ -0,0 +1,195 @@
+/**
+ * \file sweep_buffer.cpp
+ * \brief rohdeschwarz::instruments::vna::SweepBuffer, SweepRef and
+ * SweepBufferPool implementations
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/sweep_buffer.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+// std lib
+#include <functional>
+#include <utility>
+
+
+std::size_t rohdeschwarz::instruments::vna::frequencyGridId(const ChannelConfiguration& configuration)
+{
+  // combine hashes
+  std::size_t id = std::hash<unsigned int>()(configuration.points);
+  for (double frequency_Hz : {configuration.startFrequency_Hz, configuration.stopFrequency_Hz})
+  {
+    id ^= std::hash<double>()(frequency_Hz) + 0x9e3779b97f4a7c15ull + (id << 6) + (id >> 2);
+  }
+  return id;
+}
+
+
+SweepBuffer::SweepBuffer(SweepBufferPool* pool, const TraceData& prototype) :
+  metadata{0, std::chrono::steady_clock::time_point(), 0, 0},
+  data(prototype),
+  _references(0),
+  _pool(pool)
+{
+  // no operations
+}
+
+
+SweepRef::SweepRef() :
+  _buffer(nullptr)
+{
+  // no operations
+}
+
+
+SweepRef::SweepRef(SweepBuffer* buffer) :
+  _buffer(buffer)
+{
+  // no operations
+}
+
+
+SweepRef::SweepRef(const SweepRef& other) :
+  _buffer(other._buffer)
+{
+  if (_buffer != nullptr)
+  {
+    _buffer->_references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+
+SweepRef::SweepRef(SweepRef&& other) noexcept :
+  _buffer(other._buffer)
+{
+  other._buffer = nullptr;
+}
+
+
+SweepRef& SweepRef::operator=(const SweepRef& other)
+{
+  SweepRef copy(other);
+  std::swap(_buffer, copy._buffer);
+  return *this;
+}
+
+
+SweepRef& SweepRef::operator=(SweepRef&& other) noexcept
+{
+  if (this != &other)
+  {
+    reset();
+    std::swap(_buffer, other._buffer);
+  }
+  return *this;
+}
+
+
+SweepRef::~SweepRef()
+{
+  reset();
+}
+
+
+SweepRef::operator bool() const
+{
+  return _buffer != nullptr;
+}
+
+
+const SweepBuffer* SweepRef::get() const
+{
+  return _buffer;
+}
+
+
+const SweepBuffer* SweepRef::operator->() const
+{
+  return _buffer;
+}
+
+
+const SweepBuffer& SweepRef::operator*() const
+{
+  return *_buffer;
+}
+
+
+std::size_t SweepRef::useCount() const
+{
+  if (_buffer == nullptr)
+  {
+    return 0;
+  }
+  return _buffer->_references.load(std::memory_order_relaxed);
+}
+
+
+void SweepRef::reset()
+{
+  if (_buffer == nullptr)
+  {
+    return;
+  }
+
+  // last reference? recycle
+  if (_buffer->_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    _buffer->_pool->recycle(_buffer);
+  }
+  _buffer = nullptr;
+}
+
+
+SweepBufferPool::SweepBufferPool(std::size_t buffers, const TraceData& prototype)
+{
+  _buffers.reserve(buffers);
+  _free.reserve(buffers);
+  for (std::size_t i = 0; i < buffers; i++)
+  {
+    _buffers.emplace_back(new SweepBuffer(this, prototype));
+    _free.push_back(_buffers.back().get());
+  }
+}
+
+
+SweepBuffer* SweepBufferPool::acquire()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_free.empty())
+  {
+    return nullptr;
+  }
+  SweepBuffer* buffer = _free.back();
+  _free.pop_back();
+  return buffer;
+}
+
+
+SweepRef SweepBufferPool::publish(SweepBuffer* buffer)
+{
+  buffer->_references.store(1, std::memory_order_release);
+  return SweepRef(buffer);
+}
+
+
+void SweepBufferPool::discard(SweepBuffer* buffer)
+{
+  recycle(buffer);
+}
+
+
+std::size_t SweepBufferPool::available() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _free.size();
+}
+
+
+void SweepBufferPool::recycle(SweepBuffer* buffer)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _free.push_back(buffer);
+}
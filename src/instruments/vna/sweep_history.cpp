@@ -0,0 +1,50 @@
+/**
+ * \file sweep_history.cpp
+ * \brief rohdeschwarz::instruments::vna::SweepHistory implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/sweep_history.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+SweepHistory::SweepHistory() :
+  _sweeps(0),
+  _points(0)
+{
+  // no operations
+}
+
+
+SweepHistory::SweepHistory(std::size_t sweeps, std::size_t points) :
+  ComplexData(sweeps * points),
+  _sweeps(sweeps),
+  _points(points)
+{
+  // no operations
+}
+
+
+std::size_t SweepHistory::sweeps() const
+{
+  return _sweeps;
+}
+
+
+std::size_t SweepHistory::points() const
+{
+  return _points;
+}
+
+
+std::complex<double>* SweepHistory::sweep(std::size_t index)
+{
+  return data() + index * _points;
+}
+
+
+const std::complex<double>* SweepHistory::sweep(std::size_t index) const
+{
+  return data() + index * _points;
+}
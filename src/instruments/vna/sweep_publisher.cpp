@@ -0,0 +1,94 @@
+/**
+ * \file sweep_publisher.cpp
+ * \brief rohdeschwarz::instruments::vna::SweepSubscription and
+ * SweepPublisher implementations
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/sweep_publisher.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+// std lib
+#include <algorithm>
+#include <utility>
+
+
+SweepSubscription::SweepSubscription(std::size_t capacity) :
+  _queue(capacity),
+  _dropped(0)
+{
+  // no operations
+}
+
+
+bool SweepSubscription::tryTake(SweepRef* sweep)
+{
+  SweepRef* slot = _queue.beginRead();
+  if (slot == nullptr)
+  {
+    // empty
+    return false;
+  }
+  *sweep = std::move(*slot);
+  _queue.endRead();
+  return true;
+}
+
+
+std::size_t SweepSubscription::dropped() const
+{
+  return _dropped;
+}
+
+
+void SweepSubscription::push(const SweepRef& sweep)
+{
+  SweepRef* slot = _queue.beginWrite();
+  if (slot == nullptr)
+  {
+    // full
+    _dropped++;
+    return;
+  }
+  *slot = sweep;
+  _queue.commitWrite();
+}
+
+
+std::shared_ptr<SweepSubscription> SweepPublisher::subscribe(std::size_t capacity)
+{
+  auto subscription = std::make_shared<SweepSubscription>(capacity);
+  std::lock_guard<std::mutex> lock(_mutex);
+  _subscriptions.push_back(subscription);
+  return subscription;
+}
+
+
+void SweepPublisher::unsubscribe(const std::shared_ptr<SweepSubscription>& subscription)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto i = std::find(_subscriptions.begin(), _subscriptions.end(), subscription);
+  if (i != _subscriptions.end())
+  {
+    _subscriptions.erase(i);
+  }
+}
+
+
+std::size_t SweepPublisher::subscribers() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _subscriptions.size();
+}
+
+
+void SweepPublisher::publish(const SweepRef& sweep)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (const auto& subscription : _subscriptions)
+  {
+    subscription->push(sweep);
+  }
+}
@@ -5,18 +5,29 @@
 
 
 // rohdeschwarz
+#include "rohdeschwarz/instruments/profiler.hpp"
 #include "rohdeschwarz/instruments/vna/preserve_data_format.hpp"
+#include "rohdeschwarz/instruments/vna/sweep_history.hpp"
 #include "rohdeschwarz/instruments/vna/trace.hpp"
 #include "rohdeschwarz/instruments/vna/vna.hpp"
 #include "rohdeschwarz/helpers.hpp"
+#include "rohdeschwarz/to_value.hpp"
 #include "rohdeschwarz/to_vector.hpp"
 using namespace rohdeschwarz;
+using namespace rohdeschwarz::instruments;
 using namespace rohdeschwarz::instruments::vna;
 
 
+// std lib
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+
 Trace::Trace(Vna* znx, const char* name) :
   _vna(znx),
-  _name(name)
+  _name(name),
+  _channel(0)
 {
   // no operations
 }
@@ -24,7 +35,17 @@ Trace::Trace(Vna* znx, const char* name) :
 
 Trace::Trace(Vna* znx, const std::string& name) :
   _vna(znx),
-  _name(name)
+  _name(name),
+  _channel(0)
+{
+  // no operations
+}
+
+
+Trace::Trace(Vna* znx, const std::string& name, unsigned int channel) :
+  _vna(znx),
+  _name(name),
+  _channel(channel)
 {
   // no operations
 }
@@ -86,9 +107,15 @@ void Trace::setFormat(const std::string& format)
 
 unsigned int Trace::channel()
 {
-  return std::stoi(_vna->query(":CONF:TRAC:CHAN:NAME:ID? \'%1%\'", _name));
+  ProfileScope profile(_vna, "Trace::channel");
+  if (!_channel)
+  {
+    _channel = std::stoi(_vna->query(":CONF:TRAC:CHAN:NAME:ID? \'%1%\'", _name));
+  }
+  return _channel;
 }
 
+
 unsigned int Trace::diagram()
 {
   auto response = _vna->query(":CONF:TRAC:WIND? \'%1%\'", _name);
@@ -104,6 +131,8 @@ void Trace::setDiagram(unsigned int diagram)
 
 std::vector<double> Trace::y()
 {
+  ProfileScope profile(_vna, "Trace::y");
+
   // set data format to binary 64-bit, little-endian
   PreserveDataFormat preserve_data_format(_vna);
   DataFormat format = _vna->dataFormat();
@@ -124,6 +153,8 @@ std::vector<double> Trace::y()
 
 std::vector<std::complex<double>> Trace::y_complex()
 {
+  ProfileScope profile(_vna, "Trace::y_complex");
+
   // set data format to binary 64-bit, little-endian
   PreserveDataFormat preserve_data_format(_vna);
   DataFormat format = _vna->dataFormat();
@@ -140,3 +171,71 @@ std::vector<std::complex<double>> Trace::y_complex()
   // read
   return _vna->read64BitComplexVector();
 }
+
+
+std::vector<std::complex<double>> Trace::acquire()
+{
+  auto data = _vna->channel(channel()).acquire({_name});
+  if (data.empty())
+  {
+    // error
+    return std::vector<std::complex<double>>();
+  }
+  return std::move(data.front());
+}
+
+
+SweepHistory Trace::sweepHistory(std::size_t count)
+{
+  PreserveDataFormat preserve_data_format(_vna);
+
+  // format, select trace, points, data per sweep
+  const unsigned int channel = this->channel();
+  std::ostringstream message;
+  message << ":FORM REAL,64;:FORM:BORD SWAP;:CALC" << channel << ":PAR:SEL \'" << _name << "\'";
+  message << ";:SENS" << channel << ":SWE:POIN?";
+  for (std::size_t sweep = 1; sweep <= count; sweep++)
+  {
+    message << ";:CALC" << channel << ":DATA:NSW:FIRS? SDAT," << sweep;
+  }
+  if (!_vna->write("%1%", message.str()))
+  {
+    // error
+    return SweepHistory();
+  }
+
+  // read points
+  std::size_t points;
+  try
+  {
+    points = to_value<unsigned int>(trimView(_vna->readNextResponse()));
+  }
+  catch (const std::invalid_argument&)
+  {
+    // error; discard remaining blocks
+    _vna->clear();
+    return SweepHistory();
+  }
+
+  // read sweeps directly into history
+  SweepHistory history(count, points);
+  const std::size_t sweep_size_B = points * sizeof(std::complex<double>);
+  for (std::size_t sweep = 0; sweep < count; sweep++)
+  {
+    std::size_t size_B;
+    if (!_vna->readBlockDataHeader(&size_B) || size_B != sweep_size_B)
+    {
+      // error; discard remaining blocks
+      _vna->clear();
+      return SweepHistory();
+    }
+    using uchar_p = unsigned char*;
+    if (!_vna->readBlockDataPayload(uchar_p(history.sweep(sweep)), size_B))
+    {
+      // error; discard remaining blocks
+      _vna->clear();
+      return SweepHistory();
+    }
+  }
+  return history;
+}
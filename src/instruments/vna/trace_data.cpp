@@ -0,0 +1,97 @@
+/**
+ * \file trace_data.cpp
+ * \brief rohdeschwarz::instruments::vna::TraceData implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/instruments/vna/trace_data.hpp"
+using namespace rohdeschwarz::instruments::vna;
+
+
+// std lib
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+
+namespace
+{
+
+
+std::size_t total(const std::vector<std::size_t>& points)
+{
+  return std::accumulate(points.begin(), points.end(), std::size_t(0));
+}
+
+
+}  // namespace
+
+
+TraceData::TraceData() :
+  _offsets(1, 0)
+{
+  // no operations
+}
+
+
+TraceData::TraceData(std::vector<std::string> names, const std::vector<std::size_t>& points) :
+  ComplexData(total(points)),
+  _names(std::move(names)),
+  _offsets(1, 0)
+{
+  // row offsets
+  _offsets.reserve(points.size() + 1);
+  for (std::size_t trace_points : points)
+  {
+    _offsets.push_back(_offsets.back() + trace_points);
+  }
+}
+
+
+std::size_t TraceData::traces() const
+{
+  return _offsets.size() - 1;
+}
+
+
+std::size_t TraceData::points(std::size_t index) const
+{
+  return _offsets[index + 1] - _offsets[index];
+}
+
+
+const std::vector<std::string>& TraceData::names() const
+{
+  return _names;
+}
+
+
+std::complex<double>* TraceData::row(std::size_t index)
+{
+  return data() + _offsets[index];
+}
+
+
+const std::complex<double>* TraceData::row(std::size_t index) const
+{
+  return data() + _offsets[index];
+}
+
+
+TraceView TraceData::operator[](std::size_t index) const
+{
+  return {&_names[index], row(index), points(index)};
+}
+
+
+bool TraceData::find(const std::string& name, TraceView* view) const
+{
+  auto i = std::find(_names.begin(), _names.end(), name);
+  if (i == _names.end())
+  {
+    return false;
+  }
+  *view = (*this)[std::size_t(i - _names.begin())];
+  return true;
+}
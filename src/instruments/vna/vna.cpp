@@ -5,9 +5,14 @@
 
 
 // rohdeschwarz
+#include "rohdeschwarz/instruments/profiler.hpp"
+#include "rohdeschwarz/instruments/vna/preserve_data_format.hpp"
 #include "rohdeschwarz/instruments/vna/vna.hpp"
 #include "rohdeschwarz/scpi/index_name.hpp"
+#include "rohdeschwarz/scpi/tokenizer.hpp"
 #include "rohdeschwarz/helpers.hpp"
+#include "rohdeschwarz/to_value.hpp"
+using namespace rohdeschwarz::instruments;
 using namespace rohdeschwarz::instruments::vna;
 using namespace rohdeschwarz::scpi;
 using namespace rohdeschwarz;
@@ -15,6 +20,22 @@ using namespace rohdeschwarz;
 
 // std lib
 #include <algorithm>
+#include <complex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+
+// constants
+const double SWEEP_WAKE_FRACTION  = 0.95;
+const double SWEEP_TIMEOUT_FACTOR = 1.5;
+const auto   SWEEP_TIMEOUT_MARGIN = std::chrono::milliseconds(500);
+
+
+// types
+using clock_type = std::chrono::steady_clock;
+using seconds    = std::chrono::duration<double>;
 
 
 Display Vna::display()
@@ -54,9 +75,7 @@ std::vector<unsigned int> Vna::channels()
 {
   // CONF:CHAN:CAT?
   const std::string response = query(":CONF:CHAN:CAT?");
-  const std::string csvList  = unquote(rightTrim(response));
-  const std::vector<IndexName> index_names = IndexName::parse(csvList);
-  return IndexName::indexesFrom(index_names);
+  return IndexName::parseIndexes(unquoteView(trimView(response)));
 }
 
 
@@ -69,6 +88,7 @@ bool Vna::isTrace(const char* name)
 
 bool Vna::isTrace(const std::string& name)
 {
+  ProfileScope profile(this, "Vna::isTrace");
   const std::vector<std::string> traces = this->traces();
   auto i = std::find(traces.begin(), traces.end(), name);
   return i != traces.end();
@@ -85,7 +105,7 @@ Trace Vna::createTrace(const char* name, unsigned int channel)
 Trace Vna::createTrace(const std::string& name, unsigned int channel)
 {
   write(":CALC%1%:PAR:SDEF \'%2%\',\'S21\'", channel, name);
-  return trace(name);
+  return Trace(this, name, channel);
 }
 
 
@@ -106,7 +126,175 @@ std::vector<std::string> Vna::traces()
 {
   // CONF:TRAC:CAT?
   const std::string response = query(":CONF:TRAC:CAT?");
-  const std::string csvList  = unquote(rightTrim(response));
-  const std::vector<IndexName> index_names = IndexName::parse(csvList);
-  return IndexName::namesFrom(index_names);
+  return IndexName::parseNames(unquoteView(trimView(response)));
+}
+
+
+TraceData Vna::allTraceData()
+{
+  return allTraceData(channels());
+}
+
+
+TraceData Vna::allTraceData(const std::vector<unsigned int>& channels)
+{
+  PreserveDataFormat preserve_data_format(this);
+
+  // format; points, trace catalog per channel; data per channel
+  std::ostringstream message;
+  message << ":FORM REAL,64;:FORM:BORD SWAP";
+  for (unsigned int channel : channels)
+  {
+    message << ";:SENS" << channel << ":SWE:POIN?;:CALC" << channel << ":PAR:CAT?";
+  }
+  for (unsigned int channel : channels)
+  {
+    message << ";:CALC" << channel << ":DATA:CHAN:ALL? SDAT";
+  }
+  if (!write("%1%", message.str()))
+  {
+    // error
+    return TraceData();
+  }
+
+  // read shape
+  std::vector<std::string> names;
+  std::vector<std::size_t> points;
+  std::vector<std::size_t> channel_traces;
+  for (std::size_t i = 0; i < channels.size(); i++)
+  {
+    unsigned int channel_points;
+    try
+    {
+      channel_points = to_value<unsigned int>(trimView(readNextResponse()));
+    }
+    catch (const std::invalid_argument&)
+    {
+      // error; discard remaining responses
+      clear();
+      return TraceData();
+    }
+
+    // catalog: '<name>,<parameter>,...'
+    const std::string catalog = readNextResponse();
+    Tokenizer tokenizer(unquoteView(trimView(catalog)));
+    std::size_t traces = 0;
+    std::string_view name;
+    while (tokenizer.next(&name) && tokenizer.skip())
+    {
+      names.emplace_back(name);
+      points.push_back(channel_points);
+      traces++;
+    }
+    channel_traces.push_back(traces);
+  }
+
+  // read data directly into rows
+  TraceData data(std::move(names), points);
+  std::size_t trace = 0;
+  for (std::size_t traces : channel_traces)
+  {
+    std::size_t size_B;
+    if (!readBlockDataHeader(&size_B))
+    {
+      // error; discard remaining responses
+      clear();
+      return TraceData();
+    }
+
+    // check size
+    std::size_t expected_size_B = 0;
+    for (std::size_t i = trace; i < trace + traces; i++)
+    {
+      expected_size_B += data.points(i) * sizeof(std::complex<double>);
+    }
+    if (size_B != expected_size_B)
+    {
+      // error; discard remaining responses
+      clear();
+      return TraceData();
+    }
+
+    // read
+    using uchar_p = unsigned char*;
+    if (!readBlockDataPayload(uchar_p(data.row(trace)), size_B))
+    {
+      // error; discard remaining responses
+      clear();
+      return TraceData();
+    }
+    trace += traces;
+  }
+  return data;
+}
+
+
+bool Vna::startSweep(unsigned int index)
+{
+  // prime timing cache
+  channel(index).sweepTiming();
+
+  // start
+  _sweepStarts[index] = clock_type::now();
+  if (!write(":INIT%1%:IMM", index))
+  {
+    // error
+    _sweepStarts.erase(index);
+    return false;
+  }
+  return armOperationComplete();
+}
+
+
+bool Vna::waitForSweep(unsigned int index)
+{
+  auto i = _sweepStarts.find(index);
+  if (i == _sweepStarts.end())
+  {
+    // not started
+    return false;
+  }
+  const clock_type::time_point start = i->second;
+  _sweepStarts.erase(i);
+
+  // sleep until shortly before predicted end
+  const seconds predicted(channel(index).sweepTiming().duration_s());
+  std::this_thread::sleep_until(start
+    + std::chrono::duration_cast<clock_type::duration>(SWEEP_WAKE_FRACTION * predicted));
+
+  // wait
+  const auto deadline = start + SWEEP_TIMEOUT_MARGIN
+    + std::chrono::duration_cast<clock_type::duration>(SWEEP_TIMEOUT_FACTOR * predicted);
+  const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock_type::now());
+  return waitForOperationComplete(std::max<long long>(remaining.count(), 0));
+}
+
+
+bool Vna::cachedSweepTiming(unsigned int index, SweepTiming* timing) const
+{
+  auto i = _sweepTimings.find(index);
+  if (i == _sweepTimings.end())
+  {
+    return false;
+  }
+  *timing = i->second;
+  return true;
+}
+
+
+void Vna::cacheSweepTiming(unsigned int index, const SweepTiming& timing)
+{
+  _sweepTimings[index] = timing;
+}
+
+
+void Vna::clearSweepTimingCache(unsigned int index)
+{
+  _sweepTimings.erase(index);
+}
+
+
+void Vna::clearSweepTimingCache()
+{
+  _sweepTimings.clear();
 }
@@ -0,0 +1,245 @@
+/**
+ * \file bus_trace.cpp
+ * \brief rohdeschwarz::metrics::BusTrace implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/metrics/bus_trace.hpp"
+#include "rohdeschwarz/metrics/json.hpp"
+using namespace rohdeschwarz::metrics;
+
+
+// std lib
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+
+namespace
+{
+
+
+std::atomic<std::uint32_t> next_thread_id(1);
+
+
+std::mutex                           thread_names_mutex;
+std::map<std::uint32_t, std::string> thread_names;
+
+
+const char* to_name(BusEvent::Type type)
+{
+  switch (type)
+  {
+  case BusEvent::Type::Write:         return "write";
+  case BusEvent::Type::Read:          return "read";
+  case BusEvent::Type::BlockHeader:   return "block header";
+  case BusEvent::Type::BlockComplete: return "block";
+  case BusEvent::Type::Timeout:       return "timeout";
+  }
+  return "unknown";
+}
+
+
+/**
+ * \brief Nanoseconds as Chrome trace microseconds
+ */
+std::string to_us(std::uint64_t time_ns)
+{
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.3f", double(time_ns) / 1e3);
+  return text;
+}
+
+
+}  // namespace
+
+
+BusTrace::BusTrace(std::size_t capacity) :
+  _start(clock_type::now()),
+  _events(std::max<std::size_t>(capacity, 1)),
+  _next(0)
+{
+  // no operations
+}
+
+
+std::uint32_t BusTrace::threadId()
+{
+  thread_local const std::uint32_t id = next_thread_id++;
+  return id;
+}
+
+
+void BusTrace::setThreadName(const std::string& name)
+{
+  const std::uint32_t id = threadId();
+  std::lock_guard<std::mutex> lock(thread_names_mutex);
+  thread_names[id] = name;
+}
+
+
+std::uint32_t BusTrace::source(const std::string& connection)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto i = std::find(_sources.begin(), _sources.end(), connection);
+  if (i != _sources.end())
+  {
+    return std::uint32_t(i - _sources.begin());
+  }
+  _sources.push_back(connection);
+  return std::uint32_t(_sources.size() - 1);
+}
+
+
+void BusTrace::record(BusEvent::Type type, std::uint32_t source,
+                      clock_type::time_point start, clock_type::time_point end,
+                      std::uint64_t size_B)
+{
+  BusEvent event;
+  event.type        = type;
+  event.thread      = threadId();
+  event.source      = source;
+  event.start_ns    = since(start);
+  event.duration_ns = since(end) - event.start_ns;
+  event.size_B      = size_B;
+  event.message[0]  = '\0';
+  push(event);
+}
+
+
+void BusTrace::recordWrite(std::uint32_t source,
+                           clock_type::time_point start, clock_type::time_point end,
+                           const unsigned char* data, std::size_t size)
+{
+  BusEvent event;
+  event.type        = BusEvent::Type::Write;
+  event.thread      = threadId();
+  event.source      = source;
+  event.start_ns    = since(start);
+  event.duration_ns = since(end) - event.start_ns;
+  event.size_B      = size;
+
+  // message, up to the terminator
+  std::size_t length = 0;
+  while (length < size && length + 1 < BusEvent::MESSAGE_SIZE && data[length] != '\n')
+  {
+    length++;
+  }
+  std::memcpy(event.message, data, length);
+  event.message[length] = '\0';
+  push(event);
+}
+
+
+std::size_t BusTrace::capacity() const
+{
+  return _events.size();
+}
+
+
+std::uint64_t BusTrace::dropped() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _next > _events.size()? _next - _events.size() : 0;
+}
+
+
+std::vector<BusEvent> BusTrace::events() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const std::uint64_t count = std::min<std::uint64_t>(_next, _events.size());
+  std::vector<BusEvent> events;
+  events.reserve(std::size_t(count));
+  for (std::uint64_t i = _next - count; i < _next; i++)
+  {
+    events.push_back(_events[std::size_t(i % _events.size())]);
+  }
+  return events;
+}
+
+
+void BusTrace::writeChromeTrace(std::ostream& stream) const
+{
+  const std::vector<BusEvent> events = this->events();
+  std::vector<std::string> sources;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    sources = _sources;
+  }
+
+  // thread names
+  stream << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n"
+         << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"rohdeschwarz\"}}";
+  {
+    std::lock_guard<std::mutex> lock(thread_names_mutex);
+    for (const auto& [id, name] : thread_names)
+    {
+      stream << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << id
+             << ", \"args\": {\"name\": " << json_string(name) << "}}";
+    }
+  }
+
+  // events
+  for (const BusEvent& event : events)
+  {
+    const std::string connection = event.source < sources.size()? sources[event.source] : std::string();
+    const bool is_instant = event.type == BusEvent::Type::BlockHeader;
+    stream << ",\n  {\"name\": \"" << to_name(event.type) << "\", \"cat\": \"bus\""
+           << ", \"ph\": \"" << (is_instant? "i" : "X") << "\""
+           << ", \"ts\": " << to_us(event.start_ns);
+    if (is_instant)
+    {
+      stream << ", \"s\": \"t\"";
+    }
+    else
+    {
+      stream << ", \"dur\": " << to_us(event.duration_ns);
+    }
+    stream << ", \"pid\": 1, \"tid\": " << event.thread
+           << ", \"args\": {\"connection\": " << json_string(connection)
+           << ", \"bytes\": " << event.size_B;
+    if (event.message[0] != '\0')
+    {
+      stream << ", \"message\": " << json_string(event.message);
+    }
+    stream << "}}";
+  }
+  stream << "\n]}\n";
+}
+
+
+std::string BusTrace::chromeTrace() const
+{
+  std::ostringstream stream;
+  writeChromeTrace(stream);
+  return stream.str();
+}
+
+
+void BusTrace::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _next = 0;
+}
+
+
+std::uint64_t BusTrace::since(clock_type::time_point time) const
+{
+  if (time < _start)
+  {
+    return 0;
+  }
+  return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(time - _start).count());
+}
+
+
+void BusTrace::push(const BusEvent& event)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _events[std::size_t(_next % _events.size())] = event;
+  _next++;
+}
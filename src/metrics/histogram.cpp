@@ -0,0 +1,174 @@
+/**
+ * \file histogram.cpp
+ * \brief rohdeschwarz::metrics::Histogram implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/metrics/histogram.hpp"
+using namespace rohdeschwarz::metrics;
+
+
+// std lib
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+
+
+/**
+ * \brief Index of the most significant bit of `value`; requires `value > 0`
+ */
+unsigned most_significant_bit(std::uint64_t value)
+{
+  unsigned bit = 0;
+  while (value >>= 1)
+  {
+    bit++;
+  }
+  return bit;
+}
+
+
+}  // namespace
+
+
+std::size_t Histogram::bucketIndex(std::uint64_t value)
+{
+  // linear below the first power of two
+  // that has sub-buckets
+  if (value < SUB_BUCKETS)
+  {
+    return std::size_t(value);
+  }
+
+  // note: value >> shift is in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+  const unsigned    shift = most_significant_bit(value) - SUB_BUCKET_BITS;
+  const std::size_t index = SUB_BUCKETS * (shift + 1) + std::size_t(value >> shift) - SUB_BUCKETS;
+  return std::min(index, BUCKETS - 1);
+}
+
+
+std::uint64_t Histogram::bucketLowerBound(std::size_t index)
+{
+  if (index < SUB_BUCKETS)
+  {
+    return index;
+  }
+  const unsigned    shift = unsigned(index / SUB_BUCKETS) - 1;
+  const std::size_t sub   = index % SUB_BUCKETS;
+  return std::uint64_t(SUB_BUCKETS + sub) << shift;
+}
+
+
+std::uint64_t Histogram::bucketUpperBound(std::size_t index)
+{
+  return bucketLowerBound(index + 1);
+}
+
+
+Histogram::Histogram() :
+  _count(0),
+  _sum(0)
+{
+  _buckets.fill(0);
+}
+
+
+void Histogram::record(std::uint64_t value)
+{
+  _buckets[bucketIndex(value)]++;
+  _count++;
+  _sum += value;
+}
+
+
+void Histogram::add(std::size_t index, std::uint64_t count, std::uint64_t sum)
+{
+  _buckets[index] += count;
+  _count          += count;
+  _sum            += sum;
+}
+
+
+void Histogram::merge(const Histogram& other)
+{
+  for (std::size_t i = 0; i < BUCKETS; i++)
+  {
+    _buckets[i] += other._buckets[i];
+  }
+  _count += other._count;
+  _sum   += other._sum;
+}
+
+
+std::uint64_t Histogram::count() const
+{
+  return _count;
+}
+
+
+std::uint64_t Histogram::sum() const
+{
+  return _sum;
+}
+
+
+double Histogram::mean() const
+{
+  return _count == 0? 0 : double(_sum) / double(_count);
+}
+
+
+std::uint64_t Histogram::max() const
+{
+  for (std::size_t i = BUCKETS; i > 0; i--)
+  {
+    if (_buckets[i - 1] != 0)
+    {
+      return bucketUpperBound(i - 1);
+    }
+  }
+  return 0;
+}
+
+
+std::uint64_t Histogram::percentile(double p) const
+{
+  if (_count == 0)
+  {
+    return 0;
+  }
+
+  // rank of percentile, from 1
+  const auto rank = std::max<std::uint64_t>(1, std::uint64_t(std::ceil(p * double(_count))));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < BUCKETS; i++)
+  {
+    seen += _buckets[i];
+    if (seen >= rank)
+    {
+      return bucketUpperBound(i);
+    }
+  }
+  return max();
+}
+
+
+std::uint64_t Histogram::countBelow(std::uint64_t value) const
+{
+  std::uint64_t count = 0;
+  for (std::size_t i = 0; i < BUCKETS && bucketUpperBound(i) <= value; i++)
+  {
+    count += _buckets[i];
+  }
+  return count;
+}
+
+
+std::uint64_t Histogram::bucket(std::size_t index) const
+{
+  return _buckets.at(index);
+}
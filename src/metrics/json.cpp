@@ -0,0 +1,37 @@
+/**
+ * \file json.cpp
+ * \brief rohdeschwarz::metrics JSON helper implementations
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/metrics/json.hpp"
+
+
+// std lib
+#include <cstdio>
+
+
+std::string rohdeschwarz::metrics::json_string(const std::string& value)
+{
+  std::string escaped = "\"";
+  for (const char c : value)
+  {
+    if (c == '\\' || c == '\"')
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", unsigned(c));
+      escaped += code;
+    }
+    else
+    {
+      escaped += c;
+    }
+  }
+  return escaped + "\"";
+}
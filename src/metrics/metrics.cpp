@@ -0,0 +1,326 @@
+/**
+ * \file metrics.cpp
+ * \brief rohdeschwarz::metrics::Metrics implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/metrics/metrics.hpp"
+#include "rohdeschwarz/metrics/json.hpp"
+using namespace rohdeschwarz::metrics;
+
+
+// std lib
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+
+// constants
+
+/**
+ * \brief Prometheus histogram buckets, in seconds
+ */
+const double PROMETHEUS_BUCKETS_s[] =
+{
+  50e-6, 100e-6, 250e-6, 500e-6,
+  1e-3,  2.5e-3, 5e-3,   10e-3, 25e-3, 50e-3, 100e-3, 250e-3, 500e-3,
+  1,     2.5,    5,      10
+};
+
+
+// types
+using key_type = std::pair<std::string, std::string>;
+
+
+// shard
+
+struct Metrics::Shard
+{
+  // note: inserted by the owning thread only, with a lock;
+  // the owning thread finds without a lock
+  std::mutex                                    mutex;
+  std::map<key_type, std::unique_ptr<Counters>> counters;
+};
+
+
+namespace
+{
+
+
+std::atomic<std::uint64_t> next_id(0);
+
+
+/**
+ * \brief Copies atomic counters into a histogram
+ */
+void copy_to(const Metrics::Counters::Latency& latency, Histogram* histogram)
+{
+  for (std::size_t i = 0; i < Histogram::BUCKETS; i++)
+  {
+    const auto bucket = latency.buckets[i].load(std::memory_order_relaxed);
+    if (bucket != 0)
+    {
+      histogram->add(i, bucket, 0);
+    }
+  }
+
+  // note: buckets and sum may be a record apart
+  histogram->add(0, 0, latency.sum.load(std::memory_order_relaxed));
+}
+
+
+void merge(HeaderMetrics* total, const HeaderMetrics& other)
+{
+  total->commands += other.commands;
+  total->queries  += other.queries;
+  total->bytesOut += other.bytesOut;
+  total->bytesIn  += other.bytesIn;
+  total->timeouts += other.timeouts;
+  total->write_us.merge(other.write_us);
+  total->firstByte_us.merge(other.firstByte_us);
+  total->reply_us.merge(other.reply_us);
+}
+
+
+/**
+ * \brief Escapes a Prometheus label value
+ */
+std::string prometheus_label(const std::string& value)
+{
+  std::string escaped;
+  for (const char c : value)
+  {
+    switch (c)
+    {
+    case '\\': escaped += "\\\\"; break;
+    case '\"': escaped += "\\\""; break;
+    case '\n': escaped += "\\n";  break;
+    default:   escaped += c;
+    }
+  }
+  return escaped;
+}
+
+
+void write_prometheus_counter(std::ostream& stream, const std::vector<HeaderMetrics>& headers,
+                              const char* name, const char* help,
+                              std::uint64_t HeaderMetrics::*counter)
+{
+  stream << "# HELP rohdeschwarz_" << name << "_total " << help << "\n"
+         << "# TYPE rohdeschwarz_" << name << "_total counter\n";
+  for (const auto& header : headers)
+  {
+    stream << "rohdeschwarz_" << name << "_total"
+           << "{connection=\"" << prometheus_label(header.connection)
+           << "\",header=\""   << prometheus_label(header.header) << "\"} "
+           << header.*counter << "\n";
+  }
+}
+
+
+void write_prometheus_histogram(std::ostream& stream, const std::vector<HeaderMetrics>& headers,
+                                const char* name, const char* help,
+                                Histogram HeaderMetrics::*histogram)
+{
+  stream << "# HELP rohdeschwarz_" << name << "_seconds " << help << "\n"
+         << "# TYPE rohdeschwarz_" << name << "_seconds histogram\n";
+  for (const auto& header : headers)
+  {
+    const Histogram& values_us = header.*histogram;
+    const std::string labels = "connection=\"" + prometheus_label(header.connection)
+                             + "\",header=\""  + prometheus_label(header.header) + "\"";
+
+    // note: cumulative; one pass over the buckets
+    std::uint64_t count = 0;
+    std::size_t   i     = 0;
+    for (const double le_s : PROMETHEUS_BUCKETS_s)
+    {
+      const auto le_us = std::uint64_t(le_s * 1e6);
+      for (; i < Histogram::BUCKETS && Histogram::bucketUpperBound(i) <= le_us; i++)
+      {
+        count += values_us.bucket(i);
+      }
+      stream << "rohdeschwarz_" << name << "_seconds_bucket{" << labels << ",le=\"" << le_s << "\"} "
+             << count << "\n";
+    }
+    stream << "rohdeschwarz_" << name << "_seconds_bucket{" << labels << ",le=\"+Inf\"} " << values_us.count() << "\n"
+           << "rohdeschwarz_" << name << "_seconds_sum{"    << labels << "} " << values_us.sum() / 1e6 << "\n"
+           << "rohdeschwarz_" << name << "_seconds_count{"  << labels << "} " << values_us.count() << "\n";
+  }
+}
+
+
+void write_json_latency(std::ostream& stream, const char* name, const Histogram& values_us)
+{
+  stream << json_string(name) << ": {"
+         << "\"count\": " << values_us.count()
+         << ", \"mean\": " << values_us.mean()
+         << ", \"p50\": "  << values_us.percentile(0.50)
+         << ", \"p99\": "  << values_us.percentile(0.99)
+         << ", \"p999\": " << values_us.percentile(0.999)
+         << ", \"max\": "  << values_us.max() << "}";
+}
+
+
+}  // namespace
+
+
+// counters
+
+void Metrics::Counters::add(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+{
+  // note: single writer; no read-modify-write needed
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+
+void Metrics::Counters::Latency::record(std::uint64_t value_us)
+{
+  add(buckets[Histogram::bucketIndex(value_us)], 1);
+  add(count, 1);
+  add(sum, value_us);
+}
+
+
+// snapshot
+
+std::vector<HeaderMetrics> Snapshot::connections() const
+{
+  std::vector<HeaderMetrics> totals;
+  for (const auto& header : headers)
+  {
+    if (totals.empty() || totals.back().connection != header.connection)
+    {
+      totals.emplace_back();
+      totals.back().connection = header.connection;
+    }
+    merge(&totals.back(), header);
+  }
+  return totals;
+}
+
+
+std::string Snapshot::prometheus() const
+{
+  std::ostringstream stream;
+  write_prometheus_counter(stream, headers, "commands",  "Program messages without queries", &HeaderMetrics::commands);
+  write_prometheus_counter(stream, headers, "queries",   "Program messages with queries",    &HeaderMetrics::queries);
+  write_prometheus_counter(stream, headers, "bytes_out", "Bytes written",                    &HeaderMetrics::bytesOut);
+  write_prometheus_counter(stream, headers, "bytes_in",  "Bytes read",                       &HeaderMetrics::bytesIn);
+  write_prometheus_counter(stream, headers, "timeouts",  "Failed writes and reads",          &HeaderMetrics::timeouts);
+  write_prometheus_histogram(stream, headers, "write",      "Duration of writes",                 &HeaderMetrics::write_us);
+  write_prometheus_histogram(stream, headers, "first_byte", "Time to first byte of the response", &HeaderMetrics::firstByte_us);
+  write_prometheus_histogram(stream, headers, "reply",      "Time to complete response",          &HeaderMetrics::reply_us);
+  return stream.str();
+}
+
+
+std::string Snapshot::json() const
+{
+  std::ostringstream stream;
+  stream << "{\"metrics\": [";
+  for (std::size_t i = 0; i < headers.size(); i++)
+  {
+    const HeaderMetrics& header = headers[i];
+    stream << (i == 0? "\n" : ",\n")
+           << "  {\"connection\": " << json_string(header.connection)
+           << ", \"header\": "      << json_string(header.header)
+           << ", \"commands\": "    << header.commands
+           << ", \"queries\": "     << header.queries
+           << ", \"bytes_out\": "   << header.bytesOut
+           << ", \"bytes_in\": "    << header.bytesIn
+           << ", \"timeouts\": "    << header.timeouts << ", ";
+    write_json_latency(stream, "write_us", header.write_us);
+    stream << ", ";
+    write_json_latency(stream, "first_byte_us", header.firstByte_us);
+    stream << ", ";
+    write_json_latency(stream, "reply_us", header.reply_us);
+    stream << "}";
+  }
+  stream << "\n]}\n";
+  return stream.str();
+}
+
+
+// metrics
+
+Metrics::Metrics() :
+  _id(next_id++)
+{
+  // no operations
+}
+
+
+Metrics::~Metrics()
+{
+  // note: shards are shared with the threads
+  // that recorded into them
+}
+
+
+Metrics::Counters* Metrics::counters(const std::string& connection, const std::string& header)
+{
+  Shard* shard = this->shard();
+  key_type key(connection, header);
+  auto i = shard->counters.find(key);
+  if (i != shard->counters.end())
+  {
+    return i->second.get();
+  }
+
+  // new header
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  auto& counters = shard->counters[std::move(key)];
+  counters = std::make_unique<Counters>();
+  return counters.get();
+}
+
+
+Snapshot Metrics::snapshot() const
+{
+  std::map<key_type, HeaderMetrics> headers;
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (const auto& shard : _shards)
+  {
+    std::lock_guard<std::mutex> shard_lock(shard->mutex);
+    for (const auto& [key, counters] : shard->counters)
+    {
+      HeaderMetrics& header = headers[key];
+      header.connection = key.first;
+      header.header     = key.second;
+      header.commands  += counters->commands.load(std::memory_order_relaxed);
+      header.queries   += counters->queries.load(std::memory_order_relaxed);
+      header.bytesOut  += counters->bytesOut.load(std::memory_order_relaxed);
+      header.bytesIn   += counters->bytesIn.load(std::memory_order_relaxed);
+      header.timeouts  += counters->timeouts.load(std::memory_order_relaxed);
+      copy_to(counters->write_us,     &header.write_us);
+      copy_to(counters->firstByte_us, &header.firstByte_us);
+      copy_to(counters->reply_us,     &header.reply_us);
+    }
+  }
+
+  Snapshot snapshot;
+  for (auto& [key, header] : headers)
+  {
+    snapshot.headers.push_back(std::move(header));
+  }
+  return snapshot;
+}
+
+
+Metrics::Shard* Metrics::shard()
+{
+  // note: by id, not address; a destroyed Metrics
+  // may be followed by another at the same address
+  thread_local std::unordered_map<std::uint64_t, std::shared_ptr<Shard>> shards;
+  auto& shard = shards[_id];
+  if (!shard)
+  {
+    shard = std::make_shared<Shard>();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _shards.push_back(shard);
+  }
+  return shard.get();
+}
@@ -0,0 +1,216 @@
+/**
+ * \file recorder.cpp
+ * \brief rohdeschwarz::metrics::Recorder implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/metrics/recorder.hpp"
+using namespace rohdeschwarz::metrics;
+
+
+// std lib
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+
+// constants
+
+/**
+ * \brief Bytes of a program message searched for its header and a query
+ */
+const std::size_t QUERY_SEARCH_SIZE_B = 256;
+
+
+namespace
+{
+
+
+std::uint64_t to_us(Recorder::clock_type::duration duration)
+{
+  return std::uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+
+bool is_query(const unsigned char* data, std::size_t size)
+{
+  const std::size_t search_size = std::min(size, QUERY_SEARCH_SIZE_B);
+  for (std::size_t i = 0; i < search_size; i++)
+  {
+    if (data[i] == '#')
+    {
+      // block data
+      return false;
+    }
+    if (data[i] == '?')
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+}  // namespace
+
+
+Recorder::Recorder(Metrics* metrics) :
+  _metrics(metrics),
+  _counters(nullptr),
+  _isReplyPending(false),
+  _isFirstByteRead(false)
+{
+  // no operations
+}
+
+
+Recorder::~Recorder()
+{
+  finish();
+}
+
+
+const std::string& Recorder::connection() const
+{
+  return _connection;
+}
+
+
+void Recorder::setConnection(std::string connection)
+{
+  finish();
+  _connection = std::move(connection);
+  _counters   = nullptr;
+}
+
+
+void Recorder::recordWrite(const unsigned char* data, std::size_t size, clock_type::time_point start, bool isOk)
+{
+  const auto end = clock_type::now();
+  finish();
+
+  Metrics::Counters* counters = this->counters(header(data, size));
+  const bool is_query = ::is_query(data, size);
+  Metrics::Counters::add(is_query? counters->queries : counters->commands, 1);
+  Metrics::Counters::add(counters->bytesOut, size);
+  counters->write_us.record(to_us(end - start));
+  if (!isOk)
+  {
+    // error
+    Metrics::Counters::add(counters->timeouts, 1);
+    return;
+  }
+
+  if (is_query)
+  {
+    _isReplyPending  = true;
+    _isFirstByteRead = false;
+    _written         = end;
+  }
+}
+
+
+void Recorder::recordRead(std::size_t size, bool isOk)
+{
+  const auto now = clock_type::now();
+  Metrics::Counters* counters = this->counters(_header);
+  Metrics::Counters::add(counters->bytesIn, size);
+  if (!isOk)
+  {
+    // error
+    Metrics::Counters::add(counters->timeouts, 1);
+    _isReplyPending = false;
+    return;
+  }
+
+  if (!_isReplyPending)
+  {
+    return;
+  }
+  if (!_isFirstByteRead && size > 0)
+  {
+    counters->firstByte_us.record(to_us(now - _written));
+    _isFirstByteRead = true;
+  }
+  _lastRead = now;
+}
+
+
+void Recorder::finish()
+{
+  if (!_isReplyPending)
+  {
+    return;
+  }
+  _isReplyPending = false;
+  if (!_isFirstByteRead)
+  {
+    // no reply
+    return;
+  }
+  counters(_header)->reply_us.record(to_us(_lastRead - _written));
+}
+
+
+std::string Recorder::header(const unsigned char* data, std::size_t size)
+{
+  std::string header;
+  std::size_t i = 0;
+  if (i < size && data[i] == ':')
+  {
+    i++;
+  }
+  for (; i < size && i < QUERY_SEARCH_SIZE_B; i++)
+  {
+    const char c = char(data[i]);
+    if (std::isspace(static_cast<unsigned char>(c)) || c == ';')
+    {
+      break;
+    }
+    header += char(std::toupper(static_cast<unsigned char>(c)));
+  }
+
+  // strip numeric suffixes
+  std::string normalized;
+  normalized.reserve(header.size());
+  for (std::size_t j = 0; j < header.size(); j++)
+  {
+    if (std::isdigit(static_cast<unsigned char>(header[j])))
+    {
+      // digits at the end of a node,
+      // following a mnemonic
+      std::size_t end = j;
+      while (end < header.size() && std::isdigit(static_cast<unsigned char>(header[end])))
+      {
+        end++;
+      }
+      const bool is_end_of_node = end == header.size() || header[end] == ':' || header[end] == '?';
+      const bool is_mnemonic    = !normalized.empty() && std::isalpha(static_cast<unsigned char>(normalized.back()));
+      if (is_end_of_node && is_mnemonic)
+      {
+        j = end - 1;
+        continue;
+      }
+    }
+    normalized += header[j];
+  }
+  return normalized;
+}
+
+
+Metrics::Counters* Recorder::counters(const std::string& header)
+{
+  const auto thread = std::this_thread::get_id();
+  if (_counters != nullptr && _thread == thread && _header == header)
+  {
+    return _counters;
+  }
+  _counters = _metrics->counters(_connection, header);
+  _thread   = thread;
+  if (&header != &_header)
+  {
+    _header = header;
+  }
+  return _counters;
+}
@@ -0,0 +1,640 @@
+/**
+ * \file proxy_server.cpp
+ * \brief rohdeschwarz::proxy::ProxyServer implementation
+ */
+
+
+// rohdeschwarz
+#include "rohdeschwarz/proxy/proxy_server.hpp"
+#include "rohdeschwarz/scpi/message_scanner.hpp"
+#include "rohdeschwarz/scpi/tokenizer.hpp"
+#include "rohdeschwarz/helpers.hpp"
+using namespace rohdeschwarz::instruments::vna;
+using namespace rohdeschwarz::proxy;
+using namespace rohdeschwarz::scpi;
+using namespace rohdeschwarz;
+
+
+// posix
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// std lib
+#include <cctype>
+#include <string_view>
+#include <utility>
+
+
+// constants
+const std::size_t CHUNK_SIZE_B     = 4096;
+const std::size_t RING_SLOTS       = 4;
+const char        TRACE_DATA_QUERY[] = "PROX:TRAC:DATA?";
+
+
+// types
+using const_char_p = const char*;
+using uchar_p      = unsigned char*;
+using protocol     = boost::asio::local::stream_protocol;
+using error_code   = boost::system::error_code;
+
+
+namespace
+{
+
+
+/**
+ * \brief Returns `message` without terminator or surrounding whitespace,
+ * in upper case outside of quotes
+ */
+std::string normalize(const std::string& message)
+{
+  std::string key(trimView(message));
+  char quote = '\0';
+  for (char& c : key)
+  {
+    if (quote)
+    {
+      if (c == quote)
+      {
+        quote = '\0';
+      }
+      continue;
+    }
+    if (c == '\'' || c == '\"')
+    {
+      quote = c;
+      continue;
+    }
+    c = char(std::toupper(static_cast<unsigned char>(c)));
+  }
+  return key;
+}
+
+
+/**
+ * \brief Checks if query `header` has side effects, or must
+ * be answered per client
+ *
+ * -   destructive reads: event status (`*ESR?`, `STAT:...:EVEN?` and
+ *     `STAT:<register>?`, whose default node is the event register)
+ *     and the error queue
+ * -   `*OPC?`, a synchronization point of the client that sent it
+ */
+bool is_destructive(std::string_view header)
+{
+  if (!header.empty() && header.front() == ':')
+  {
+    header.remove_prefix(1);
+  }
+  if (header == "*ESR?" || header == "*OPC?" || header.find("ERR") != std::string_view::npos)
+  {
+    return true;
+  }
+  if (header.substr(0, 4) != "STAT")
+  {
+    return false;
+  }
+
+  // status register: last node, without suffix
+  std::string_view node = header.substr(header.rfind(':') + 1);
+  node.remove_suffix(1);
+  node = node.substr(0, node.find_last_not_of("0123456789") + 1);
+  const bool is_non_destructive = node == "COND" || node == "CONDITION"
+                               || node == "ENAB" || node == "ENABLE"
+                               || node == "PTR"  || node == "PTRANSITION"
+                               || node == "NTR"  || node == "NTRANSITION";
+  return !is_non_destructive;
+}
+
+
+/**
+ * \brief Checks that every message unit of `key` is a query
+ * without side effects
+ */
+bool is_read_only(const std::string& key)
+{
+  Tokenizer units(key, ';');
+  std::string_view unit;
+  while (units.next(&unit))
+  {
+    const std::string_view header = unit.substr(0, unit.find_first_of(" \t"));
+    if (header.empty() || header.back() != '?')
+    {
+      // command
+      return false;
+    }
+    if (is_destructive(header))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+ * \brief Checks for a query with an immutable response
+ */
+bool is_cacheable(const std::string& key)
+{
+  return key == "*IDN?" || key == "*OPT?";
+}
+
+
+/**
+ * \brief Parses proxy query `PROX:TRAC:DATA? <channel>`
+ */
+bool is_trace_data_query(const std::string& key, unsigned int* channel)
+{
+  std::string_view query(key);
+  if (!query.empty() && query.front() == ':')
+  {
+    query.remove_prefix(1);
+  }
+  if (query.substr(0, sizeof(TRACE_DATA_QUERY) - 1) != TRACE_DATA_QUERY)
+  {
+    return false;
+  }
+  const std::string argument(trimView(query.substr(sizeof(TRACE_DATA_QUERY) - 1)));
+  if (argument.empty() || argument.find_first_not_of("0123456789") != std::string::npos)
+  {
+    // error
+    return false;
+  }
+  *channel = unsigned(std::stoul(argument));
+  return true;
+}
+
+
+}  // namespace
+
+
+// client connection
+
+struct ProxyServer::Client
+{
+  Client(boost::asio::io_context& io_context) :
+    socket(io_context),
+    chunk(CHUNK_SIZE_B),
+    isWriting(false)
+  {
+    // no operations
+  }
+
+  protocol::socket           socket;
+  std::vector<unsigned char> chunk;
+  std::string                message;
+  MessageScanner             scanner;
+  std::deque<std::string>    responses;
+  bool                       isWriting;
+};
+
+
+ProxyServer::ProxyServer(Vna* vna, std::string path, std::string shmPrefix) :
+  _vna(vna),
+  _path(std::move(path)),
+  _shmPrefix(std::move(shmPrefix)),
+  _acceptor(_io_context),
+  _isRunning(false),
+  _clients(0),
+  _received(0),
+  _forwarded(0),
+  _coalesced(0),
+  _cached(0)
+{
+  if (_shmPrefix.empty())
+  {
+    _shmPrefix = "/rohdeschwarz-proxy-" + std::to_string(getpid());
+  }
+}
+
+
+ProxyServer::~ProxyServer()
+{
+  stop();
+}
+
+
+bool ProxyServer::start()
+{
+  if (_isRunning)
+  {
+    // already running
+    return false;
+  }
+
+  // remove stale socket, but nothing else
+  struct stat status;
+  if (::lstat(_path.c_str(), &status) == 0)
+  {
+    if (!S_ISSOCK(status.st_mode))
+    {
+      // error: not a socket
+      return false;
+    }
+    ::unlink(_path.c_str());
+  }
+
+  // listen
+  error_code error;
+  _acceptor.open(protocol(), error);
+  if (!error)
+  {
+    _acceptor.bind(protocol::endpoint(_path), error);
+  }
+  if (!error)
+  {
+    _acceptor.listen(boost::asio::socket_base::max_listen_connections, error);
+  }
+  if (error)
+  {
+    // error
+    error_code ignore;
+    _acceptor.close(ignore);
+    return false;
+  }
+
+  // start
+  _isRunning = true;
+  _io_context.restart();
+  accept();
+  _ioThread = std::thread([this]()
+  {
+    _io_context.run();
+  });
+  _worker = std::thread(&ProxyServer::run, this);
+  return true;
+}
+
+
+void ProxyServer::stop()
+{
+  if (!_isRunning)
+  {
+    return;
+  }
+
+  // stop worker, after the request in progress
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isRunning = false;
+  }
+  _condition.notify_all();
+  _worker.join();
+
+  // disconnect clients;
+  // io thread returns when all operations are cancelled
+  boost::asio::post(_io_context, [this]()
+  {
+    error_code ignore;
+    _acceptor.close(ignore);
+    for (auto& client : _connected)
+    {
+      client->socket.close(ignore);
+    }
+    _connected.clear();
+  });
+  _ioThread.join();
+
+  // clean up
+  ::unlink(_path.c_str());
+  _requests.clear();
+  _clients = 0;
+}
+
+
+bool ProxyServer::isRunning() const
+{
+  return _isRunning;
+}
+
+
+std::string ProxyServer::path() const
+{
+  return _path;
+}
+
+
+std::size_t ProxyServer::clients() const
+{
+  return _clients;
+}
+
+
+std::size_t ProxyServer::requests() const
+{
+  return _received;
+}
+
+
+std::size_t ProxyServer::forwarded() const
+{
+  return _forwarded;
+}
+
+
+std::size_t ProxyServer::coalesced() const
+{
+  return _coalesced;
+}
+
+
+std::size_t ProxyServer::cached() const
+{
+  return _cached;
+}
+
+
+// io thread
+
+void ProxyServer::accept()
+{
+  auto client = std::make_shared<Client>(_io_context);
+  _acceptor.async_accept(client->socket, [this, client](const error_code& error)
+  {
+    if (error)
+    {
+      // stopped
+      return;
+    }
+    _connected.insert(client);
+    _clients = _connected.size();
+    read(client);
+    accept();
+  });
+}
+
+
+void ProxyServer::read(std::shared_ptr<Client> client)
+{
+  auto buffer = boost::asio::buffer(client->chunk);
+  client->socket.async_read_some(buffer, [this, client](const error_code& error, std::size_t size)
+  {
+    if (error)
+    {
+      // disconnected
+      _connected.erase(client);
+      _clients = _connected.size();
+      return;
+    }
+
+    // split into program messages
+    const unsigned char* data = client->chunk.data();
+    while (size > 0)
+    {
+      std::size_t consumed;
+      const bool is_complete = client->scanner.scan(data, size, &consumed);
+      client->message.append(const_char_p(data), consumed);
+      data += consumed;
+      size -= consumed;
+      if (!is_complete)
+      {
+        break;
+      }
+      if (client->scanner.isError())
+      {
+        // malformed block data; disconnect
+        _connected.erase(client);
+        _clients = _connected.size();
+        return;
+      }
+
+      // queue request
+      Request request;
+      request.client     = client;
+      request.key        = normalize(client->message);
+      request.isQuery    = client->scanner.isQuery();
+      request.isReadOnly = request.isQuery && !client->scanner.isBlockData() && is_read_only(request.key);
+      request.message.swap(client->message);
+      client->scanner.reset();
+      if (request.key.empty())
+      {
+        // empty message
+        continue;
+      }
+      _received++;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _requests.push_back(std::move(request));
+      }
+      _condition.notify_one();
+    }
+
+    read(client);
+  });
+}
+
+
+void ProxyServer::send(std::shared_ptr<Client> client, std::string response)
+{
+  boost::asio::post(_io_context, [this, client, response = std::move(response)]() mutable
+  {
+    client->responses.push_back(std::move(response));
+    if (!client->isWriting)
+    {
+      write(client);
+    }
+  });
+}
+
+
+void ProxyServer::write(std::shared_ptr<Client> client)
+{
+  client->isWriting = true;
+  auto buffer = boost::asio::buffer(client->responses.front());
+  boost::asio::async_write(client->socket, buffer, [this, client](const error_code& error, std::size_t)
+  {
+    client->responses.pop_front();
+    if (error)
+    {
+      // disconnected
+      client->responses.clear();
+    }
+    if (client->responses.empty())
+    {
+      client->isWriting = false;
+      return;
+    }
+    write(client);
+  });
+}
+
+
+// instrument thread
+
+void ProxyServer::run()
+{
+  while (true)
+  {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this]()
+      {
+        return !_isRunning || !_requests.empty();
+      });
+      if (!_isRunning)
+      {
+        return;
+      }
+      request = std::move(_requests.front());
+      _requests.pop_front();
+    }
+
+    // cached?
+    std::string response;
+    const auto cached = request.isReadOnly? _cache.find(request.key) : _cache.end();
+    if (cached != _cache.end())
+    {
+      _cached++;
+      response = cached->second;
+    }
+    else if (!execute(request, &response))
+    {
+      // no response
+      continue;
+    }
+
+    // answer identical queries
+    // that arrived in the meantime
+    std::vector<Request> requests;
+    if (request.isReadOnly)
+    {
+      coalesce(request, &requests);
+      _coalesced += requests.size();
+    }
+    send(request.client, response);
+    for (auto& other : requests)
+    {
+      send(other.client, response);
+    }
+  }
+}
+
+
+void ProxyServer::coalesce(const Request& request, std::vector<Request>* requests)
+{
+  // note: stop at the first request that may change
+  // instrument state; skip clients with earlier requests
+  // to preserve per-client order
+  std::set<const Client*> waiting;
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto i = _requests.begin();
+  while (i != _requests.end() && i->isReadOnly)
+  {
+    if (i->key == request.key && !waiting.count(i->client.get()))
+    {
+      requests->push_back(std::move(*i));
+      i = _requests.erase(i);
+      continue;
+    }
+    waiting.insert(i->client.get());
+    i++;
+  }
+}
+
+
+bool ProxyServer::execute(const Request& request, std::string* response)
+{
+  // proxy query?
+  unsigned int channel;
+  if (is_trace_data_query(request.key, &channel))
+  {
+    return publishTraceData(channel, response);
+  }
+
+  // forward
+  _forwarded++;
+  const auto data = uchar_p(request.message.data());
+  const bool is_written = _vna->writeData(data, request.message.size());
+  if (!request.isQuery)
+  {
+    // no response
+    return false;
+  }
+  if (!is_written || !readResponse(response))
+  {
+    // error; discard a late response,
+    // answer with an empty response
+    _vna->clear();
+    *response = "\n";
+    return true;
+  }
+
+  // immutable?
+  if (is_cacheable(request.key))
+  {
+    _cache[request.key] = *response;
+  }
+  return true;
+}
+
+
+bool ProxyServer::readResponse(std::string* response)
+{
+  response->clear();
+  MessageScanner scanner;
+  while (true)
+  {
+    std::size_t read_size;
+    if (!_vna->readData(&read_size))
+    {
+      // error
+      return false;
+    }
+
+    const unsigned char* data = _vna->buffer()->data();
+    std::size_t consumed;
+    const bool is_complete = scanner.scan(data, read_size, &consumed);
+    response->append(const_char_p(data), consumed);
+    if (scanner.isError())
+    {
+      // error: malformed block data
+      return false;
+    }
+    if (is_complete)
+    {
+      return true;
+    }
+  }
+}
+
+
+bool ProxyServer::publishTraceData(unsigned int channel, std::string* response)
+{
+  // read
+  const TraceData data = _vna->allTraceData({channel});
+  _forwarded++;
+  if (data.isEmpty())
+  {
+    // error
+    *response = "\n";
+    return true;
+  }
+
+  // (re)create ring for channel shape
+  const std::string name   = _shmPrefix + "-ch" + std::to_string(channel);
+  const std::size_t points = data.points(0);
+  auto& ring = _rings[channel];
+  if (!ring || ring->names != data.names() || ring->points != points)
+  {
+    ring.reset();
+    ring.reset(new Ring);
+    ring->names  = data.names();
+    ring->points = points;
+    if (!ring->writer.create(name, RING_SLOTS, ring->names, points))
+    {
+      // error
+      ring.reset();
+      *response = "\n";
+      return true;
+    }
+  }
+
+  // publish
+  ring->writer.publish(data, channel);
+  const std::size_t sweep = ring->writer.published() - 1;
+  *response = "'" + name + "'," + std::to_string(sweep) + "\n";
+  return true;
+}
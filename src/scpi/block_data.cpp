@@ -5,6 +5,7 @@
 
 
 #include "rohdeschwarz/scpi/block_data.hpp"
+#include "rohdeschwarz/probes.hpp"
 using namespace rohdeschwarz::scpi;
 
 
@@ -12,6 +13,7 @@ using namespace rohdeschwarz::scpi;
 #include <algorithm>
 #include <cctype>
 #include <string>
+#include <utility>
 
 
 BlockData::BlockData() :
@@ -29,7 +31,7 @@ BlockData::BlockData(std::vector<unsigned char> data) :
   _headerSize_B (0),
   _payloadSize_B(0),
   _blockSize_B  (0),
-  _data(data)
+  _data(std::move(data))
 {
   processHeader();
 }
@@ -106,12 +108,59 @@ bool BlockData::isComplete() const
 }
 
 
-void BlockData::push_back(std::vector<unsigned char>::const_iterator begin, std::size_t size)
+bool BlockData::parseHeader(const unsigned char* data, std::size_t size,
+                            std::size_t* headerSize_B, std::size_t* payloadSize_B,
+                            bool* isError)
 {
+  *isError = false;
+  if (size < 2)
+  {
+    // check magic character, if available
+    *isError = size == 1 && char(data[0]) != '#';
+    return false;
+  }
+
+  // magic character, number of size digits
+  if (char(data[0]) != '#' || !std::isdigit(data[1]) || char(data[1]) == '0')
+  {
+    *isError = true;
+    return false;
+  }
+  const std::size_t digits = data[1] - '0';
+  if (size < 2 + digits)
+  {
+    // not enough data
+    return false;
+  }
+
+  // payload size
+  std::size_t payload_size = 0;
+  for (std::size_t digit = 0; digit < digits; digit++)
+  {
+    const unsigned char c = data[2 + digit];
+    if (!std::isdigit(c))
+    {
+      // error: not a number
+      *isError = true;
+      return false;
+    }
+    payload_size = 10 * payload_size + (c - '0');
+  }
+
+  // success
+  *headerSize_B  = 2 + digits;
+  *payloadSize_B = payload_size;
+  return true;
+}
+
+
+std::size_t BlockData::push_back(std::vector<unsigned char>::const_iterator begin, std::size_t size)
+{
+  ROHDESCHWARZ_PROBE3(block__push, this, size, _data.size());
   if (isComplete())
   {
     // block needs no more data
-    return;
+    return 0;
   }
 
   if (!isHeader())
@@ -120,7 +169,15 @@ void BlockData::push_back(std::vector<unsigned char>::const_iterator begin, std:
     auto end = begin + size;
     _data.insert(_data.end(), begin, end);
     processHeader();
-    return;
+    if (!isHeader() || _data.size() <= _blockSize_B)
+    {
+      return size;
+    }
+
+    // return bytes past end of block
+    const std::size_t excess = _data.size() - _blockSize_B;
+    _data.resize(_blockSize_B);
+    return size - excess;
   }
 
   // get number of bytes to read from data
@@ -130,6 +187,7 @@ void BlockData::push_back(std::vector<unsigned char>::const_iterator begin, std:
   auto end = begin + read_bytes;
   _data.insert(_data.end(), begin, end);
   processHeader();
+  return read_bytes;
 }
 
 
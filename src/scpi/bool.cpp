@@ -15,7 +15,7 @@ std::string rohdeschwarz::scpi::toScpi(bool value)
 }
 
 
-bool rohdeschwarz::scpi::toBool(std::string scpi)
+bool rohdeschwarz::scpi::toBool(std::string_view scpi)
 {
-  return rohdeschwarz::trim(scpi) == "1";
+  return rohdeschwarz::trimView(scpi) == "1";
 }
@@ -5,7 +5,9 @@
 
 
 #include "rohdeschwarz/scpi/index_name.hpp"
+#include "rohdeschwarz/scpi/tokenizer.hpp"
 #include "rohdeschwarz/helpers.hpp"
+#include "rohdeschwarz/to_value.hpp"
 using namespace rohdeschwarz::scpi;
 using namespace rohdeschwarz;
 
@@ -16,33 +18,67 @@ using namespace rohdeschwarz;
 
 std::vector<IndexName> IndexName::parse(const char* csvList)
 {
-  const std::string csv_list_str(csvList);
-  return IndexName::parse(csv_list_str);
+  return IndexName::parse(std::string_view(csvList));
 }
 
 
 std::vector<IndexName> IndexName::parse(const std::string& csvList)
 {
-  // split csv list
-  std::vector<std::string> parts = split(csvList);
+  return IndexName::parse(std::string_view(csvList));
+}
+
 
+std::vector<IndexName> IndexName::parse(std::string_view csvList)
+{
   // create vector of IndexNames
+  Tokenizer tokenizer(csvList);
   std::vector<IndexName> indexNames;
-  indexNames.reserve(parts.size() / 2);
-  for (int i = 0; i + 1 < parts.size(); i += 2)
-  {
-    // create IndexName
-    IndexName index_name;
-    index_name.index = std::stoi(parts[i]);
-    index_name.name  = parts[i + 1];
+  indexNames.reserve(tokenizer.count() / 2);
 
-    // insert
-    indexNames.push_back(index_name);
+  // parse pairs
+  std::string_view index, name;
+  while (tokenizer.next(&index) && tokenizer.next(&name))
+  {
+    indexNames.push_back({to_value<unsigned int>(index), std::string(unquoteView(name))});
   }
   return indexNames;
 }
 
 
+std::vector<unsigned int> IndexName::parseIndexes(std::string_view csvList)
+{
+  // create vector
+  Tokenizer tokenizer(csvList);
+  std::vector<unsigned int> indexes;
+  indexes.reserve(tokenizer.count() / 2);
+
+  // parse pairs
+  std::string_view index;
+  while (tokenizer.next(&index) && tokenizer.skip())
+  {
+    indexes.push_back(to_value<unsigned int>(index));
+  }
+  return indexes;
+}
+
+
+std::vector<std::string> IndexName::parseNames(std::string_view csvList)
+{
+  // create vector
+  Tokenizer tokenizer(csvList);
+  std::vector<std::string> names;
+  names.reserve(tokenizer.count() / 2);
+
+  // parse pairs
+  std::string_view name;
+  while (tokenizer.skip() && tokenizer.next(&name))
+  {
+    names.emplace_back(unquoteView(name));
+  }
+  return names;
+}
+
+
 std::vector<unsigned int> IndexName::indexesFrom(const std::vector<IndexName>& list)
 {
   // create vector; set capacity
@@ -0,0 +1,160 @@
+/**
+ * \file message_scanner.cpp
+ * \brief rohdeschwarz::scpi::MessageScanner implementation
+ */
+
+
+#include "rohdeschwarz/scpi/message_scanner.hpp"
+#include "rohdeschwarz/scpi/tokenizer.hpp"
+using namespace rohdeschwarz::scpi;
+
+
+// std lib
+#include <algorithm>
+#include <string_view>
+
+
+MessageScanner::MessageScanner()
+{
+  reset();
+}
+
+
+void MessageScanner::reset()
+{
+  _state       = State::Text;
+  _quote       = '\0';
+  _digits      = 0;
+  _remaining   = 0;
+  _isQuery     = false;
+  _isBlockData = false;
+}
+
+
+bool MessageScanner::scan(const unsigned char* data, std::size_t size, std::size_t* consumed)
+{
+  std::size_t i = 0;
+  while (i < size)
+  {
+    const char c = char(data[i]);
+    switch (_state)
+    {
+    case State::Text:
+    {
+      // next query, block or terminator, outside of quotes
+      const std::string_view text(reinterpret_cast<const char*>(data), size);
+      i = findUnquoted(text, "?#\n", i, &_quote);
+      if (i == size)
+      {
+        break;
+      }
+
+      const char found = text[i++];
+      if (found == '?')
+      {
+        _isQuery = true;
+      }
+      else if (found == '#')
+      {
+        _state = State::BlockDigits;
+      }
+      else
+      {
+        // complete
+        *consumed = i;
+        return true;
+      }
+      break;
+    }
+
+    case State::BlockDigits:
+      if (c == '0')
+      {
+        i++;
+        _isBlockData = true;
+        _state       = State::IndefiniteBlock;
+      }
+      else if (c >= '1' && c <= '9')
+      {
+        i++;
+        _isBlockData = true;
+        _digits      = std::size_t(c - '0');
+        _remaining   = 0;
+        _state       = State::BlockLength;
+      }
+      else
+      {
+        // not block data, e.g. #H1F;
+        // rescan as text
+        _state = State::Text;
+      }
+      break;
+
+    case State::BlockLength:
+      if (c < '0' || c > '9')
+      {
+        // framing error; see isError
+        _state    = State::Error;
+        *consumed = i;
+        return true;
+      }
+      i++;
+      _remaining = 10 * _remaining + std::size_t(c - '0');
+      if (--_digits == 0)
+      {
+        _state = _remaining? State::BlockPayload : State::Text;
+      }
+      break;
+
+    case State::BlockPayload:
+    {
+      // skip payload
+      const std::size_t skip = std::min(_remaining, size - i);
+      i          += skip;
+      _remaining -= skip;
+      if (_remaining == 0)
+      {
+        _state = State::Text;
+      }
+      break;
+    }
+
+    case State::IndefiniteBlock:
+      i++;
+      if (c == '\n')
+      {
+        // complete
+        *consumed = i;
+        return true;
+      }
+      break;
+
+    case State::Error:
+      // until reset
+      *consumed = i;
+      return true;
+    }
+  }
+
+  // incomplete
+  *consumed = size;
+  return false;
+}
+
+
+bool MessageScanner::isQuery() const
+{
+  return _isQuery;
+}
+
+
+bool MessageScanner::isBlockData() const
+{
+  return _isBlockData;
+}
+
+
+bool MessageScanner::isError() const
+{
+  return _state == State::Error;
+}
@@ -0,0 +1,152 @@
+/**
+ * \file tokenizer.cpp
+ * \brief rohdeschwarz::scpi::Tokenizer implementation
+ */
+
+
+#include "rohdeschwarz/scpi/tokenizer.hpp"
+#include "rohdeschwarz/helpers.hpp"
+using namespace rohdeschwarz::scpi;
+using namespace rohdeschwarz;
+
+
+// std lib
+#include <algorithm>
+
+
+Tokenizer::Tokenizer(std::string_view text, char separator) :
+  _text(trimView(text)),
+  _position(0),
+  _separator(separator),
+  _isEnd(_text.empty()),
+  _hasQuotes(_text.find_first_of("\'\"") != std::string_view::npos)
+{
+  // no operations
+}
+
+
+bool Tokenizer::isEnd() const
+{
+  return _isEnd;
+}
+
+
+bool Tokenizer::next(std::string_view* token)
+{
+  if (isEnd())
+  {
+    // no more tokens
+    return false;
+  }
+
+  // find end of token
+  const std::size_t end = findSeparator(_position);
+  if (token != nullptr)
+  {
+    *token = trimView(_text.substr(_position, end - _position));
+  }
+
+  // advance past separator
+  if (end == _text.size())
+  {
+    _isEnd    = true;
+    _position = end;
+  }
+  else
+  {
+    _position = end + 1;
+  }
+  return true;
+}
+
+
+bool Tokenizer::skip()
+{
+  return next(nullptr);
+}
+
+
+std::string_view Tokenizer::remainder() const
+{
+  return _text.substr(_position);
+}
+
+
+std::size_t Tokenizer::count() const
+{
+  if (isEnd())
+  {
+    return 0;
+  }
+
+  if (!_hasQuotes)
+  {
+    // fast path
+    const auto begin = _text.begin() + _position;
+    return 1 + std::size_t(std::count(begin, _text.end(), _separator));
+  }
+
+  std::size_t count    = 1;
+  std::size_t position = findSeparator(_position);
+  while (position != _text.size())
+  {
+    count++;
+    position = findSeparator(position + 1);
+  }
+  return count;
+}
+
+
+// helpers
+
+std::size_t Tokenizer::findSeparator(std::size_t position) const
+{
+  if (!_hasQuotes)
+  {
+    // fast path
+    const std::size_t separator = _text.find(_separator, position);
+    return separator == std::string_view::npos? _text.size() : separator;
+  }
+
+  return findUnquoted(_text, std::string_view(&_separator, 1), position);
+}
+
+
+// scan
+
+std::size_t rohdeschwarz::scpi::findUnquoted(std::string_view text, std::string_view characters,
+                                             std::size_t position, char* quote)
+{
+  char open = quote != nullptr? *quote : '\0';
+  for (; position < text.size(); position++)
+  {
+    const char character = text[position];
+    if (open)
+    {
+      // inside quotes
+      if (character == open)
+      {
+        open = '\0';
+      }
+      continue;
+    }
+
+    if (character == '\'' || character == '\"')
+    {
+      // start of quotes
+      open = character;
+      continue;
+    }
+
+    if (characters.find(character) != std::string_view::npos)
+    {
+      break;
+    }
+  }
+
+  if (quote != nullptr)
+  {
+    *quote = open;
+  }
+  return position;
+}
@@ -1,34 +1,103 @@
+/**
+ * \file to_value.cpp
+ * \brief rohdeschwarz::to_value() implementations
+ */
+
+
 // rohdeschwarz
 #include "rohdeschwarz/helpers.hpp"
 #include "rohdeschwarz/to_value.hpp"
 
 
+// std lib
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
+#include <system_error>
+
+
+// constants
+
+// longest double representation: sign, 17 significant digits,
+// decimal point, exponent; with plenty of room
+const std::size_t MAX_DOUBLE_CHARS = 64;
+
+
+// helpers
+
+/**
+ * \brief Parses an integer with `std::from_chars`
+ *
+ * An optional leading `+` is accepted, as in SCPI `<NR1>` values.
+ */
+template <class integer_type>
+integer_type parse_integer(std::string_view input)
+{
+  std::string_view text = rohdeschwarz::trimView(input);
+  if (!text.empty() && text.front() == '+')
+  {
+    text.remove_prefix(1);
+  }
+
+  integer_type value = 0;
+  const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (text.empty() || result.ec != std::errc())
+  {
+    throw std::invalid_argument("to_value: invalid integer");
+  }
+  return value;
+}
+
+
+// implementation
+
+
+// int
 template<>
-int rohdeschwarz::to_value(std::string input)
+int rohdeschwarz::to_value(std::string_view input)
 {
-  return std::stoi( rohdeschwarz::trim(input));
+  return parse_integer<int>(input);
 }
 
 
 // unsigned int
 template<>
-unsigned int rohdeschwarz::to_value(std::string input)
+unsigned int rohdeschwarz::to_value(std::string_view input)
 {
-  return std::stoul( rohdeschwarz::trim(input));
+  return parse_integer<unsigned int>(input);
 }
 
 
 // double
 template<>
-double rohdeschwarz::to_value(std::string input)
+double rohdeschwarz::to_value(std::string_view input)
 {
-  return std::stod( rohdeschwarz::trim(input));
+  const std::string_view text = rohdeschwarz::trimView(input);
+  if (text.empty() || text.size() >= MAX_DOUBLE_CHARS)
+  {
+    throw std::invalid_argument("to_value: invalid double");
+  }
+
+  // strtod requires a null-terminated string;
+  // copy to the stack to avoid allocating
+  char buffer[MAX_DOUBLE_CHARS];
+  text.copy(buffer, text.size());
+  buffer[text.size()] = '\0';
+
+  // parse
+  char* end = nullptr;
+  const double value = std::strtod(buffer, &end);
+  if (end == buffer)
+  {
+    throw std::invalid_argument("to_value: invalid double");
+  }
+  return value;
 }
 
 
 // string
 template<>
-std::string rohdeschwarz::to_value(std::string input)
+std::string rohdeschwarz::to_value(std::string_view input)
 {
-  return rohdeschwarz::unquote( rohdeschwarz::trim(input));
+  return std::string(rohdeschwarz::unquoteView( rohdeschwarz::trimView(input)));
 }